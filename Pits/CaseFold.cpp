@@ -0,0 +1,236 @@
+﻿/**
+ * @brief 大文字小文字の単純変換と畳み込み
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/CaseFold.hpp"
+#include "Pits/Encoding.hpp"
+#include "Pits/UnicodeTable.hpp"
+#include <cstdint>      // int32_t
+#include <tuple>        // get
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ *
+ */
+
+namespace {
+
+/// CaseMappings の組の要素
+enum Mapping {
+    MappingLower,
+    MappingUpper,
+    MappingTitle,
+    MappingFold,
+    MappingFullFold,
+    MappingSize,
+};
+
+/// 文字の変換の組を返す
+inline auto GetMapping(char32_t c) noexcept -> const std::int32_t*
+{
+    return UnicodeTable::CaseMappings + std::size_t(UnicodeTable::GetCase(c)) * MappingSize;
+}
+
+/// 差分を適用する
+constexpr auto Apply(char32_t c, std::int32_t delta) noexcept -> char32_t
+{
+    return char32_t(std::int32_t(c) + delta);
+}
+
+/// 畳み込みで変わる文字か返す
+inline auto IsChanged(char32_t c, CaseFolding folding) noexcept -> bool
+{
+    auto m = GetMapping(c);
+    return m[MappingFold] || (folding == CaseFolding::Full && m[MappingFullFold]);
+}
+
+/// 1文字を畳み込み、出力した文字数を返す
+inline auto Fold(char32_t c, CaseFolding folding, char32_t* out) noexcept -> std::size_t
+{
+    auto m = GetMapping(c);
+    if (folding == CaseFolding::Full && m[MappingFullFold]) {
+        auto d = UnicodeTable::CaseFoldData + (m[MappingFullFold] >> 2);
+        auto n = std::size_t(m[MappingFullFold] & 0x3);
+        for (auto i = std::size_t {}; i < n; ++i) out[i] = d[i];
+        return n;
+    }
+    out[0] = Apply(c, m[MappingFold]);
+    return 1;
+}
+
+/// ASCII の大文字を小文字にする
+constexpr auto LowerASCII(char c) noexcept -> char
+{
+    return ('A' <= c && c <= 'Z') ? char(c + 0x20) : c;
+}
+
+#ifdef PITS_ENCODING_SSE2
+
+/// 16 バイト中の ASCII の大文字の位置を返す
+inline auto UpperMask(__m128i v) noexcept -> __m128i
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+}
+
+#endif
+
+/// 畳み込みで変わる最初の位置を返す 変わらなければ text.size()
+auto FindChanged(std::string_view text, CaseFolding folding) noexcept -> std::size_t
+{
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto it = begin;
+    while (it != end) {
+
+#ifdef PITS_ENCODING_SSE2
+        // ASCII の小文字等は 16 バイト毎に読み飛ばす
+        while (end - it >= 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            if (_mm_movemask_epi8(_mm_or_si128(v, UpperMask(v)))) break;
+            it += 16;
+        }
+        if (it == end) break;
+#endif
+
+        if (!(*it & 0x80)) {
+            if (LowerASCII(*it) != *it) break;
+            ++it;
+            continue;
+        }
+        auto to32 = EncodingUTF8ToUTF32(it, end);
+        auto c = std::get<1>(to32);
+        if (c > CharacterMax || IsChanged(c, folding)) break;
+        it = std::get<0>(to32);
+    }
+    return std::size_t(it - begin);
+}
+
+/// 畳み込んで追加する
+void AppendFolded(std::string_view text, CaseFolding folding, std::string& out)
+{
+    // 1文字から最大 CaseFoldMax 文字になるので足りなくなる度に広げる
+    constexpr auto Margin = std::size_t(16 + CaseFoldMax * 4);
+    auto size = out.size();
+    out.resize(size + text.size() + Margin);
+
+    auto it = text.data();
+    auto end = it + text.size();
+    while (it != end) {
+        if (out.size() - size < Margin) {
+            out.resize(out.size() * 2);
+        }
+        auto to = &out[size];
+
+#ifdef PITS_ENCODING_SSE2
+        // ASCII は 16 バイト毎に小文字にする
+        if (end - it >= 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            if (!_mm_movemask_epi8(v)) {
+                v = _mm_add_epi8(v, _mm_and_si128(UpperMask(v), _mm_set1_epi8(0x20)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(to), v);
+                it += 16;
+                size += 16;
+                continue;
+            }
+        }
+#endif
+
+        if (!(*it & 0x80)) {
+            *to = LowerASCII(*it++);
+            ++size;
+            continue;
+        }
+        char32_t folded[CaseFoldMax];
+        auto n = Fold(NextPoint(it, end), folding, folded);
+        for (auto i = std::size_t {}; i < n; ++i) {
+            to = std::get<1>(ConvertUTF32ToUTF8(&folded[i], to));
+        }
+        size = std::size_t(to - out.data());
+    }
+    out.resize(size);
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto ToLower(char32_t c) noexcept -> char32_t
+{
+    return Apply(c, GetMapping(c)[MappingLower]);
+}
+
+auto ToUpper(char32_t c) noexcept -> char32_t
+{
+    return Apply(c, GetMapping(c)[MappingUpper]);
+}
+
+auto ToTitle(char32_t c) noexcept -> char32_t
+{
+    return Apply(c, GetMapping(c)[MappingTitle]);
+}
+
+auto SimpleCaseFold(char32_t c) noexcept -> char32_t
+{
+    return Apply(c, GetMapping(c)[MappingFold]);
+}
+
+auto FullCaseFold(char32_t c, char32_t* out) noexcept -> std::size_t
+{
+    return Fold(c, CaseFolding::Full, out);
+}
+
+auto FoldCase(std::string_view text, CaseFolding folding, std::string& buffer) -> std::string_view
+{
+    auto changed = FindChanged(text, folding);
+    if (changed == text.size()) {
+        return text;
+    }
+
+    // 変わらない範囲はそのまま複写する
+    buffer.assign(text.data(), changed);
+    AppendFolded(text.substr(changed), folding, buffer);
+    return buffer;
+}
+
+auto FoldCase(std::string_view text, CaseFolding folding) -> std::string
+{
+    auto buffer = std::string {};
+    auto result = FoldCase(text, folding, buffer);
+    if (result.data() != buffer.data()) {
+        return std::string(result);
+    }
+    return buffer;
+}
+
+auto FoldCase(std::u32string_view text, CaseFolding folding) -> std::u32string
+{
+    auto out = std::u32string {};
+    out.reserve(text.size());
+    for (auto c : text) {
+        char32_t folded[CaseFoldMax];
+        auto n = Fold(IsSafeCharacter(c) ? c : ReplacementCharacter, folding, folded);
+        out.append(folded, n);
+    }
+    return out;
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,121 @@
+﻿/**
+ * @brief 大文字小文字の単純変換と畳み込み
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_CASEFOLD_HPP_
+#define PITS_CASEFOLD_HPP_
+
+#include <cstddef>      // size_t
+#include <string>
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ * 大文字小文字
+ *
+ * テーブルはビルド時に ucd/UnicodeData.txt, ucd/CaseFolding.txt から生成する
+ * 単純変換は1文字から1文字へ、完全畳み込みは1文字から最大3文字へ変換する
+ * トルコ語用の畳み込み (CaseFolding.txt の T) は扱わない
+ *
+ * 参考
+ * - Case Folding   ... https://www.unicode.org/versions/latest/ch05.pdf#G21180
+ */
+
+/// 完全畳み込みの最大文字数
+constexpr auto CaseFoldMax = std::size_t(3);
+
+/// 畳み込みの種類
+enum class CaseFolding {
+    Simple, // 単純畳み込み (C + S) 文字数は変わらない
+    Full,   // 完全畳み込み (C + F) ß → ss 等で文字数が変わる
+};
+
+/**
+ * @brief 小文字にする (Simple_Lowercase_Mapping)
+ * @param c 文字
+ * @return 小文字 無ければ c
+ */
+auto ToLower(char32_t c) noexcept -> char32_t;
+
+/**
+ * @brief 大文字にする (Simple_Uppercase_Mapping)
+ * @param c 文字
+ * @return 大文字 無ければ c
+ */
+auto ToUpper(char32_t c) noexcept -> char32_t;
+
+/**
+ * @brief タイトル文字にする (Simple_Titlecase_Mapping)
+ * @param c 文字
+ * @return タイトル文字 無ければ c
+ */
+auto ToTitle(char32_t c) noexcept -> char32_t;
+
+/**
+ * @brief 単純畳み込みする (Simple_Case_Folding)
+ * @param c 文字
+ * @return 畳み込んだ文字
+ */
+auto SimpleCaseFold(char32_t c) noexcept -> char32_t;
+
+/**
+ * @brief 完全畳み込みする (Case_Folding)
+ * @param c 文字
+ * @param out 畳み込んだ文字の出力先 (CaseFoldMax 文字分)
+ * @return 出力した文字数
+ */
+auto FullCaseFold(char32_t c, char32_t* out) noexcept -> std::size_t;
+
+/**
+ * @brief 畳み込む 変わらない場合は入力をそのまま返す
+ *
+ * ASCII は 16 バイト毎にまとめて判定と変換を行い、ASCII 以外だけテーブルを引く
+ * 不正なシーケンスは置き換える
+ *
+ * @param text UTF8 文字列
+ * @param folding 畳み込みの種類
+ * @param buffer 変わる場合に結果を格納する
+ * @return text または buffer を参照する結果
+ */
+auto FoldCase(std::string_view text, CaseFolding folding, std::string& buffer) -> std::string_view;
+
+/**
+ * @brief 畳み込んだ文字列を返す
+ * @param text UTF8 文字列
+ * @param folding 畳み込みの種類
+ * @return 畳み込んだ UTF8 文字列
+ */
+auto FoldCase(std::string_view text, CaseFolding folding = CaseFolding::Full) -> std::string;
+
+/**
+ * @brief 畳み込んだ文字列を返す
+ * @param text UTF32 文字列
+ * @param folding 畳み込みの種類
+ * @return 畳み込んだ UTF32 文字列
+ */
+auto FoldCase(std::u32string_view text, CaseFolding folding = CaseFolding::Full) -> std::u32string;
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
@@ -0,0 +1,273 @@
+﻿/**
+ * @brief エンコーディングに依らない文字列の比較とハッシュ
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/Compare.hpp"
+#include "Pits/Encoding.hpp"
+#include <algorithm>    // min
+#include <cstdint>      // uint64_t
+#include <cstring>      // memcpy
+#include <type_traits>  // make_unsigned_t
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+namespace {
+
+/// ユニットを符号無しの値にする
+template <class Char>
+constexpr auto UnitValue(Char c) noexcept -> char32_t
+{
+    return char32_t(std::make_unsigned_t<Char>(c));
+}
+
+#ifdef PITS_ENCODING_SSE2
+
+/// 16 ユニットを読み込み、全て ASCII ならバイト列にして真を返す
+inline auto LoadASCII(const char* p, __m128i& out) noexcept -> bool
+{
+    out = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return !_mm_movemask_epi8(out);
+}
+
+/// 16 ユニットを読み込み、全て ASCII ならバイト列にして真を返す
+inline auto LoadASCII(const char16_t* p, __m128i& out) noexcept -> bool
+{
+    auto v = reinterpret_cast<const __m128i*>(p);
+    auto lo = _mm_loadu_si128(v);
+    auto hi = _mm_loadu_si128(v + 1);
+    auto high = _mm_and_si128(_mm_or_si128(lo, hi), _mm_set1_epi16(short(0xff80)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xffff) return false;
+    out = _mm_packus_epi16(lo, hi);
+    return true;
+}
+
+/// 16 ユニットを読み込み、全て ASCII ならバイト列にして真を返す
+inline auto LoadASCII(const char32_t* p, __m128i& out) noexcept -> bool
+{
+    auto v = reinterpret_cast<const __m128i*>(p);
+    auto a = _mm_loadu_si128(v);
+    auto b = _mm_loadu_si128(v + 1);
+    auto c = _mm_loadu_si128(v + 2);
+    auto d = _mm_loadu_si128(v + 3);
+    auto all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+    auto high = _mm_and_si128(all, _mm_set1_epi32(int(0xffffff80)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xffff) return false;
+    out = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+    return true;
+}
+
+#endif
+
+/// 16 ユニットが全て ASCII で一致するか返す
+template <class A, class B>
+auto EqualASCII16(const A* a, const B* b) noexcept -> bool
+{
+#ifdef PITS_ENCODING_SSE2
+    auto va = __m128i {};
+    auto vb = __m128i {};
+    return LoadASCII(a, va) && LoadASCII(b, vb) && _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xffff;
+#else
+    for (auto i = 0; i < 16; ++i) {
+        if (UnitValue(a[i]) > 0x7f || UnitValue(a[i]) != UnitValue(b[i])) return false;
+    }
+    return true;
+#endif
+}
+
+/// コードポイント順で比較する
+template <class A, class B>
+auto CompareUnits(std::basic_string_view<A> as, std::basic_string_view<B> bs) noexcept -> int
+{
+    auto a = as.data();
+    auto aend = a + as.size();
+    auto b = bs.data();
+    auto bend = b + bs.size();
+
+    for (;;) {
+
+        // ASCII は16ユニット毎に比較する
+        while (aend - a >= 16 && bend - b >= 16 && EqualASCII16(a, b)) {
+            a += 16;
+            b += 16;
+        }
+
+        // ASCII 以外を含む範囲は1文字ずつ比較する
+        for (auto i = 0; i < 16; ++i) {
+            if (a == aend || b == bend) {
+                return (a != aend) ? 1 : (b != bend) ? -1 : 0;
+            }
+            auto ca = NextPoint(a, aend);
+            auto cb = NextPoint(b, bend);
+            if (ca != cb) return ca < cb ? -1 : 1;
+        }
+    }
+}
+
+/**
+ * @brief 置き換え済み UTF8 表現を8バイト毎に混ぜるハッシュ
+ */
+class Hasher
+{
+public:
+
+    /// バイト列を加える
+    void Append(const char* p, std::size_t n) noexcept
+    {
+        length_ += n;
+        for (; n && count_; --n) {
+            Push(*p++);
+        }
+        for (; n >= 8; p += 8, n -= 8) {
+            auto w = std::uint64_t {};
+            std::memcpy(&w, p, sizeof(w));
+            Mix(w);
+        }
+        for (; n; --n) {
+            Push(*p++);
+        }
+    }
+
+    /// 文字を UTF8 表現で加える
+    void Append(char32_t c) noexcept
+    {
+        char units[4] {};
+        auto end = std::get<1>(Unicode::ConvertUTF32ToUTF8(&c, units));
+        Append(units, std::size_t(end - units));
+    }
+
+    /// ハッシュ値を返す
+    auto Finish() noexcept -> std::size_t
+    {
+        auto w = std::uint64_t {};
+        std::memcpy(&w, buffer_, std::size_t(count_));
+        Mix(w ^ length_);
+        auto h = hash_;
+        h ^= h >> 33;
+        h *= 0xff51'afd7'ed55'8ccd;
+        h ^= h >> 33;
+        h *= 0xc4ce'b9fe'1a85'ec53;
+        h ^= h >> 33;
+        return std::size_t(h);
+    }
+
+private:
+
+    static constexpr auto Rotate(std::uint64_t v, int n) noexcept -> std::uint64_t
+    {
+        return (v << n) | (v >> (64 - n));
+    }
+
+    void Push(char c) noexcept
+    {
+        buffer_[count_++] = c;
+        if (count_ == sizeof(buffer_)) {
+            auto w = std::uint64_t {};
+            std::memcpy(&w, buffer_, sizeof(w));
+            Mix(w);
+            count_ = 0;
+        }
+    }
+
+    void Mix(std::uint64_t w) noexcept
+    {
+        w *= 0x87c3'7b91'1142'53d5;
+        w = Rotate(w, 31);
+        w *= 0x4cf5'ad43'2745'937f;
+        hash_ ^= w;
+        hash_ = Rotate(hash_, 27) * 5 + 0x52dc'e729;
+    }
+
+    std::uint64_t hash_ {0x9e37'79b9'7f4a'7c15};
+    std::uint64_t length_ {};
+    char buffer_[8] {};
+    int count_ {};
+};
+
+/// UTF8 のハッシュ値を返す 正しい範囲はそのまま加える
+auto HashUnits(std::string_view text) noexcept -> std::size_t
+{
+    auto hasher = Hasher {};
+    auto it = text.data();
+    auto end = it + text.size();
+    while (it != end) {
+        if (!(*it & 0x80)) {
+            auto run = EncodingImplement::SkipASCII(it, end);
+            hasher.Append(it, std::size_t(run - it));
+            it = run;
+            continue;
+        }
+        auto begin = it;
+        auto c = NextPoint(it, end);
+        if (c == Unicode::ReplacementCharacter) {
+            hasher.Append(c);
+        }
+        else {
+            hasher.Append(begin, std::size_t(it - begin));
+        }
+    }
+    return hasher.Finish();
+}
+
+/// UTF16 (UTF32) のハッシュ値を返す ASCII はまとめてバイト列にして加える
+template <class Char>
+auto HashUnits(std::basic_string_view<Char> text) noexcept -> std::size_t
+{
+    auto hasher = Hasher {};
+    auto it = text.data();
+    auto end = it + text.size();
+    while (it != end) {
+        if (UnitValue(*it) <= 0x7f) {
+            auto run = EncodingImplement::SkipASCII(it, end);
+            while (it != run) {
+                char units[64];
+                auto n = std::min(std::size_t(run - it), sizeof(units));
+                EncodingImplement::NarrowASCII(it, n, units);
+                hasher.Append(units, n);
+                it += n;
+            }
+            continue;
+        }
+        hasher.Append(NextPoint(it, end));
+    }
+    return hasher.Finish();
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto Compare(std::string_view a, std::string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::string_view a, std::u16string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::string_view a, std::u32string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::u16string_view a, std::string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::u16string_view a, std::u16string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::u16string_view a, std::u32string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::u32string_view a, std::string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::u32string_view a, std::u16string_view b) noexcept -> int { return CompareUnits(a, b); }
+auto Compare(std::u32string_view a, std::u32string_view b) noexcept -> int { return CompareUnits(a, b); }
+
+auto Hash(std::string_view text) noexcept -> std::size_t { return HashUnits(text); }
+auto Hash(std::u16string_view text) noexcept -> std::size_t { return HashUnits(text); }
+auto Hash(std::u32string_view text) noexcept -> std::size_t { return HashUnits(text); }
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
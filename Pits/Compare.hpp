@@ -0,0 +1,120 @@
+﻿/**
+ * @brief エンコーディングに依らない文字列の比較とハッシュ
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_COMPARE_HPP_
+#define PITS_COMPARE_HPP_
+
+#include <cstddef>      // size_t
+#include <string>
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+/**
+ * @addtogroup エンコーディングを跨いだ比較
+ *
+ * 変換せずに1文字ずつ復号してコードポイント順で比較する
+ * 不正なシーケンスは ToUTF16 等と同じく置き換え文字として比較する
+ *
+ * @return a < b なら負、a == b なら 0、a > b なら正
+ * @{
+ */
+
+auto Compare(std::string_view a, std::string_view b) noexcept -> int;
+auto Compare(std::string_view a, std::u16string_view b) noexcept -> int;
+auto Compare(std::string_view a, std::u32string_view b) noexcept -> int;
+auto Compare(std::u16string_view a, std::string_view b) noexcept -> int;
+auto Compare(std::u16string_view a, std::u16string_view b) noexcept -> int;
+auto Compare(std::u16string_view a, std::u32string_view b) noexcept -> int;
+auto Compare(std::u32string_view a, std::string_view b) noexcept -> int;
+auto Compare(std::u32string_view a, std::u16string_view b) noexcept -> int;
+auto Compare(std::u32string_view a, std::u32string_view b) noexcept -> int;
+
+/**
+ * @}
+ */
+
+/**
+ * @addtogroup エンコーディングに依らないハッシュ
+ *
+ * 置き換え済み UTF8 表現のハッシュなので、同じ文字列はどのエンコーディングでも同じ値になる
+ * @{
+ */
+
+auto Hash(std::string_view text) noexcept -> std::size_t;
+auto Hash(std::u16string_view text) noexcept -> std::size_t;
+auto Hash(std::u32string_view text) noexcept -> std::size_t;
+
+/**
+ * @}
+ */
+
+/**
+ * @brief エンコーディングに依らないハッシュ関数オブジェクト
+ *
+ * std::unordered_map<std::string, T, UnicodeHash, UnicodeEqual> の様に使う
+ * is_transparent により C++20 以降は u16string_view 等で一時文字列を作らずに検索出来る
+ */
+struct UnicodeHash
+{
+    using is_transparent = void;
+
+    auto operator()(std::string_view text) const noexcept -> std::size_t { return Hash(text); }
+    auto operator()(std::u16string_view text) const noexcept -> std::size_t { return Hash(text); }
+    auto operator()(std::u32string_view text) const noexcept -> std::size_t { return Hash(text); }
+};
+
+/**
+ * @brief エンコーディングに依らない等値比較関数オブジェクト
+ */
+struct UnicodeEqual
+{
+    using is_transparent = void;
+
+    template <class A, class B>
+    auto operator()(const A& a, const B& b) const noexcept -> bool
+    {
+        return Compare(a, b) == 0;
+    }
+};
+
+/**
+ * @brief エンコーディングに依らない順序比較関数オブジェクト (std::map 用)
+ */
+struct UnicodeLess
+{
+    using is_transparent = void;
+
+    template <class A, class B>
+    auto operator()(const A& a, const B& b) const noexcept -> bool
+    {
+        return Compare(a, b) < 0;
+    }
+};
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
@@ -0,0 +1,284 @@
+﻿/**
+ * @brief UTF8 のバイト列を直接辿るダブル配列トライ
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/DoubleArray.hpp"
+#include <algorithm>    // max stable_sort unique
+#include <numeric>      // iota
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+namespace {
+
+/// ヘッダの識別子 "PDA1"
+constexpr auto Magic = std::uint32_t(0x3141'4450);
+
+/// ヘッダの要素数
+constexpr auto HeaderUnits = std::size_t(2);
+
+/// ラベルの種類 (終端 + 256 バイト)
+constexpr auto Labels = std::size_t(257);
+
+/// 未使用の要素の check
+constexpr auto NoParent = std::uint32_t(0xffff'ffff);
+
+/// 確保の単位
+constexpr auto GrowUnits = std::size_t(1) << 16;
+
+} // namespace
+
+/*
+ *
+ */
+
+/**
+ * @brief キーの範囲を深さ優先で配置する
+ */
+class DoubleArray::Builder
+{
+public:
+
+    Builder(const std::string_view* keys, const std::uint32_t* values, std::size_t count)
+        : keys_(keys), values_(values)
+    {
+        // 添字を整列し、重複は最初の物を残す
+        order_.resize(count);
+        std::iota(order_.begin(), order_.end(), std::uint32_t {});
+        std::stable_sort(order_.begin(), order_.end(), [&](auto a, auto b) { return keys_[a] < keys_[b]; });
+        auto last = std::unique(order_.begin(), order_.end(), [&](auto a, auto b) { return keys_[a] == keys_[b]; });
+        order_.erase(last, order_.end());
+    }
+
+    /// 配置した要素 (ヘッダ付き) を返す
+    auto Build() -> std::vector<Unit>
+    {
+        Reserve(1);
+        used_[0] = true;
+        units_[0].check = NoParent;
+        if (!order_.empty()) Insert(0, 0, order_.size(), 0);
+
+        // 末尾の未使用の要素を除く
+        auto size = used_.size();
+        while (size > 1 && !used_[size - 1]) --size;
+        units_.resize(size);
+        units_.shrink_to_fit();
+        units_.insert(units_.begin(), HeaderUnits, Unit {});
+        units_[0] = {Magic, 1};
+        units_[1] = {std::uint32_t(size), std::uint32_t(order_.size())};
+        return std::move(units_);
+    }
+
+private:
+
+    /// 子の範囲
+    struct Child {
+        std::size_t label;
+        std::size_t first;
+        std::size_t last;
+    };
+
+    /// i 番目のキーの depth の位置のラベル
+    auto Label(std::size_t i, std::size_t depth) const noexcept -> std::size_t
+    {
+        auto key = keys_[order_[i]];
+        return depth < key.size() ? std::size_t(static_cast<unsigned char>(key[depth])) + 1 : 0;
+    }
+
+    /// 要素数を確保する
+    void Reserve(std::size_t size)
+    {
+        if (size <= used_.size()) return;
+        auto grown = (size + GrowUnits - 1) / GrowUnits * GrowUnits;
+        units_.resize(grown, Unit {0, NoParent});
+        used_.resize(grown);
+        bases_.resize(grown);
+    }
+
+    /// 全ての子を置ける基底を探す
+    auto FindBase(std::size_t first, std::size_t last) -> std::size_t
+    {
+        auto head = children_[first].label;
+        auto pos = std::max(next_, head + 1) - 1;
+        auto occupied = std::size_t {};
+        auto found = false;
+        for (;;) {
+            ++pos;
+            Reserve(pos + 1);
+            if (used_[pos]) {
+                ++occupied;
+                continue;
+            }
+            if (!found) {
+                next_ = pos;
+                found = true;
+            }
+            auto base = pos - head;
+            Reserve(base + Labels);
+            if (bases_[base]) continue;
+            auto fits = true;
+            for (auto i = first + 1; i < last && fits; ++i) {
+                fits = !used_[base + children_[i].label];
+            }
+            if (!fits) continue;
+
+            // 探索開始位置の前がほぼ埋まっていれば先へ進める
+            if (occupied * 20 >= (pos - next_ + 1) * 19) next_ = pos;
+            return base;
+        }
+    }
+
+    /// first ～ last のキーを depth の位置から node の下に配置する
+    void Insert(std::size_t node, std::size_t first, std::size_t last, std::size_t depth)
+    {
+        // 子をラベル毎にまとめる (整列済みなのでラベルは昇順)
+        auto begin = children_.size();
+        for (auto i = first; i < last;) {
+            auto label = Label(i, depth);
+            auto j = i + 1;
+            if (label) {
+                while (j < last && Label(j, depth) == label) ++j;
+            }
+            children_.push_back({label, i, j});
+            i = j;
+        }
+        auto end = children_.size();
+
+        auto base = FindBase(begin, end);
+        units_[node].base = std::uint32_t(base);
+        bases_[base] = true;
+        for (auto i = begin; i < end; ++i) {
+            auto t = base + children_[i].label;
+            used_[t] = true;
+            units_[t].check = std::uint32_t(node);
+        }
+
+        for (auto i = begin; i < end; ++i) {
+            auto child = children_[i];
+            auto t = base + child.label;
+            if (child.label) {
+                Insert(t, child.first, child.last, depth + 1);
+            } else {
+                auto index = order_[child.first];
+                units_[t].base = values_ ? values_[index] : index;
+            }
+        }
+        children_.resize(begin);
+    }
+
+    const std::string_view* keys_;
+    const std::uint32_t* values_;
+
+    /// 整列したキーの添字
+    std::vector<std::uint32_t> order_;
+
+    /// 要素と使用状況
+    std::vector<Unit> units_;
+    std::vector<bool> used_;
+    std::vector<bool> bases_;
+
+    /// 配置中の子 (深さ毎に積む)
+    std::vector<Child> children_;
+
+    /// 空き要素の探索開始位置
+    std::size_t next_ {1};
+};
+
+/*
+ *
+ */
+
+DoubleArray::DoubleArray(const std::string_view* keys, const std::uint32_t* values, std::size_t count)
+    : storage_(Builder(keys, values, count).Build())
+{
+    units_ = storage_.data() + HeaderUnits;
+    count_ = storage_[1].base;
+    keys_ = storage_[1].check;
+}
+
+auto DoubleArray::Attach(const void* data, std::size_t size) noexcept -> DoubleArray
+{
+    auto result = DoubleArray {};
+    auto units = static_cast<const Unit*>(data);
+    if (!data || reinterpret_cast<std::uintptr_t>(data) % alignof(Unit) || size % sizeof(Unit) ||
+        size < sizeof(Unit) * (HeaderUnits + 1) || units[0].base != Magic || units[0].check != 1 ||
+        units[1].base != size / sizeof(Unit) - HeaderUnits) {
+        return result;
+    }
+    result.units_ = units + HeaderUnits;
+    result.count_ = units[1].base;
+    result.keys_ = units[1].check;
+    return result;
+}
+
+auto DoubleArray::bytes() const noexcept -> std::string_view
+{
+    if (!count_) return {};
+    return std::string_view(reinterpret_cast<const char*>(units_ - HeaderUnits), (count_ + HeaderUnits) * sizeof(Unit));
+}
+
+auto DoubleArray::Find(std::string_view key) const noexcept -> const std::uint32_t*
+{
+    if (!count_) return nullptr;
+    auto s = std::size_t {};
+    for (auto c : key) {
+        s = Next(s, std::size_t(static_cast<unsigned char>(c)) + 1);
+        if (!s) return nullptr;
+    }
+    auto t = Next(s, 0);
+    return t ? &units_[t].base : nullptr;
+}
+
+auto DoubleArray::CommonPrefixSearch(std::string_view text, DoubleArrayMatch* out, std::size_t max) const noexcept
+    -> std::size_t
+{
+    if (!count_) return 0;
+    auto found = std::size_t {};
+    auto s = std::size_t {};
+    for (auto i = std::size_t {};; ++i) {
+        if (auto t = Next(s, 0)) {
+            if (found < max) out[found] = {i, units_[t].base};
+            ++found;
+        }
+        if (i == text.size()) break;
+        s = Next(s, std::size_t(static_cast<unsigned char>(text[i])) + 1);
+        if (!s) break;
+    }
+    return found;
+}
+
+auto DoubleArray::LongestPrefix(std::string_view text, DoubleArrayMatch& match) const noexcept -> bool
+{
+    if (!count_) return false;
+    auto found = false;
+    auto s = std::size_t {};
+    for (auto i = std::size_t {};; ++i) {
+        if (auto t = Next(s, 0)) {
+            match = {i, units_[t].base};
+            found = true;
+        }
+        if (i == text.size()) break;
+        s = Next(s, std::size_t(static_cast<unsigned char>(text[i])) + 1);
+        if (!s) break;
+    }
+    return found;
+}
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,191 @@
+﻿/**
+ * @brief UTF8 のバイト列を直接辿るダブル配列トライ
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_DOUBLEARRAY_HPP_
+#define PITS_DOUBLEARRAY_HPP_
+
+#include <cstddef>      // size_t
+#include <cstdint>      // uint32_t
+#include <iterator>     // data size
+#include <string_view>
+#include <utility>      // declval exchange move
+#include <vector>
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ * ダブル配列
+ *
+ * キーは UTF8 のまま1バイトずつ遷移するので、検索時に UTF32 等へ変換しない
+ * 遷移先は base[s] + ラベル で求め、check[t] == s なら遷移できる
+ * ラベルは終端が 0、バイト b が b + 1 なので、キーにヌル文字を含んでも良い
+ * 終端の要素の base には値を格納する
+ *
+ * 直列化した表現は要素の配列そのもので、bytes() をファイルに書き、
+ * メモリマップした領域を Attach すれば読み込まずにすぐ検索できる
+ * (エンディアンは書き込んだ環境と同じである事)
+ */
+
+/// 前方一致の結果
+struct DoubleArrayMatch {
+    std::size_t length;     // 一致したキーの長さ (バイト数)
+    std::uint32_t value;    // キーの値
+};
+
+/**
+ * @brief ダブル配列トライ
+ */
+class DoubleArray
+{
+public:
+
+    DoubleArray(const DoubleArray&) = delete;
+    DoubleArray& operator=(const DoubleArray&) = delete;
+
+    /// 移動元は構築していない辞書になる
+    DoubleArray(DoubleArray&& other) noexcept
+        : storage_(std::move(other.storage_))
+        , units_(std::exchange(other.units_, nullptr))
+        , count_(std::exchange(other.count_, 0))
+        , keys_(std::exchange(other.keys_, 0))
+    {
+    }
+
+    /// 移動元は構築していない辞書になる
+    auto operator=(DoubleArray&& other) noexcept -> DoubleArray&
+    {
+        if (this != &other) {
+            storage_ = std::move(other.storage_);
+            other.storage_.clear();
+            units_ = std::exchange(other.units_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+            keys_ = std::exchange(other.keys_, 0);
+        }
+        return *this;
+    }
+
+    /// 空の辞書 (検索は常に失敗する)
+    DoubleArray() = default;
+
+    /**
+     * @brief キーから構築する
+     *
+     * キーは整列していなくても良い 重複したキーは最初の物を使う
+     * 整列後に空き要素の探索位置を詰まり具合で進めるので、数百万キーでもほぼ線形時間で構築できる
+     *
+     * @param keys キーの配列
+     * @param values 値の配列 nullptr ならキーの添字を値にする
+     * @param count キーの数
+     */
+    DoubleArray(const std::string_view* keys, const std::uint32_t* values, std::size_t count);
+
+    /**
+     * @brief キーのコンテナから構築する
+     * @param keys std::vector<std::string_view> 等
+     */
+    template <class Keys, class = decltype(std::string_view(*std::data(std::declval<const Keys&>())))>
+    explicit DoubleArray(const Keys& keys)
+    {
+        auto views = std::vector<std::string_view>(std::begin(keys), std::end(keys));
+        *this = DoubleArray(views.data(), nullptr, views.size());
+    }
+
+    /**
+     * @brief 直列化した表現を複写せずに参照する
+     *
+     * 領域は DoubleArray より長く有効である事
+     *
+     * @param data bytes() の内容 (4 バイト境界に置く事)
+     * @param size バイト数
+     * @return 参照する辞書 表現が正しくなければ構築していない辞書
+     */
+    static auto Attach(const void* data, std::size_t size) noexcept -> DoubleArray;
+
+    /// キーが無いか返す
+    auto empty() const noexcept -> bool { return !keys_; }
+
+    /// 辞書を構築したか返す (キーが無くても構築できる 既定の構築と Attach の失敗は偽)
+    auto IsBuilt() const noexcept -> bool { return count_ != 0; }
+
+    /// キーの数を返す
+    auto size() const noexcept -> std::size_t { return keys_; }
+
+    /// 直列化した表現を返す
+    auto bytes() const noexcept -> std::string_view;
+
+    /**
+     * @brief 完全一致で検索する
+     * @param key キー
+     * @return 値を指すポインタ 無ければ nullptr
+     */
+    auto Find(std::string_view key) const noexcept -> const std::uint32_t*;
+
+    /**
+     * @brief 先頭から一致するキーを短い順に全て返す
+     * @param text 文字列
+     * @param out 結果の出力先
+     * @param max out の要素数
+     * @return 一致したキーの数 (max を超えた分は出力しない)
+     */
+    auto CommonPrefixSearch(std::string_view text, DoubleArrayMatch* out, std::size_t max) const noexcept -> std::size_t;
+
+    /**
+     * @brief 先頭から一致する最長のキーを返す
+     * @param text 文字列
+     * @param match 結果
+     * @return 一致したか
+     */
+    auto LongestPrefix(std::string_view text, DoubleArrayMatch& match) const noexcept -> bool;
+
+private:
+
+    /// 要素
+    struct Unit {
+        std::uint32_t base;     // 遷移先の基底 (終端は値)
+        std::uint32_t check;    // 遷移元
+    };
+
+    class Builder;
+
+    /// 構築した場合の領域 (先頭2要素はヘッダ)
+    std::vector<Unit> storage_;
+
+    /// 要素の配列 (storage_ または Attach した領域)
+    const Unit* units_ {};
+
+    /// 要素数
+    std::size_t count_ {};
+
+    /// キーの数
+    std::size_t keys_ {};
+
+    /// s から label で遷移する 無ければ 0
+    auto Next(std::size_t s, std::size_t label) const noexcept -> std::size_t
+    {
+        auto t = std::size_t(units_[s].base) + label;
+        return (t < count_ && units_[t].check == s) ? t : 0;
+    }
+};
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
@@ -18,11 +18,572 @@ inline namespace Encoding {
  *
  */
 
+namespace {
+
+/**
+ * @brief UTF8 を走査して正しい範囲と置き換える箇所を通知する
+ * @param from UTF8 文字列
+ * @param valid 正しい範囲 (begin, end) を受け取る関数
+ * @param invalid 置き換える箇所毎に呼ばれる関数
+ */
+template <class Valid, class Invalid>
+auto ScanUTF8(std::string_view from, Valid valid, Invalid invalid) -> void
+{
+    auto it = from.data();
+    auto end = it + from.size();
+    auto run = it;
+
+    while (it != end) {
+
+        // ASCII はまとめて読み飛ばす
+        if (!(*it & 0x80)) {
+            it = EncodingImplement::SkipASCII(it, end);
+            continue;
+        }
+
+        auto to32 = EncodingUTF8ToUTF32(it, end);
+        auto c = std::get<1>(to32);
+        if (c <= Unicode::CharacterMax) {
+            it = std::get<0>(to32);
+            continue;
+        }
+
+        valid(run, it);
+        it = (c == EncodingErrorNotEnough) ? it + EncodingImplement::IncompleteUnits(it, end) : std::get<0>(to32);
+        invalid();
+        run = it;
+    }
+    valid(run, end);
+}
+
+/// 置き換え文字の UTF8 表現
+constexpr char ReplacementUTF8[] = {char(0xef), char(0xbf), char(0xbd)};
+
+/// UTF8 系のエンコーディング
+enum class Variant {
+    UTF8,           // 不正なサロゲートと非キャラクタは置き換える
+    WTF8,           // 対のサロゲートは4ユニット 対になっていないサロゲートは3ユニット
+    CESU8,          // サロゲート毎に3ユニット
+    ModifiedUTF8,   // CESU8 + ヌル文字は c0 80
+};
+
+/// UTF8 系エンコーディングで受け入れるコードポイントであるか返す
+template <Variant V>
+constexpr auto IsAccept(char32_t c) noexcept -> bool
+{
+    switch (V) {
+    case Variant::UTF8: return Unicode::IsSafeCharacter(c);
+    case Variant::WTF8: return c <= Unicode::CharacterMax;
+    default:            return c <= 0xffff;
+    }
+}
+
+/**
+ * @brief UTF16 (UTF32) を Variant で表現した際の各部分を通知する
+ * @param it 開始位置
+ * @param end 終了位置
+ * @param ascii ASCII の範囲 (begin, units) を受け取る関数
+ * @param point 1 ～ 4 ユニットで表現するコードポイントを受け取る関数
+ */
+template <Variant V, class Char, class ASCII, class Point>
+auto ScanUnits(const Char* it, const Char* end, ASCII ascii, Point point) -> void
+{
+    while (it != end) {
+
+        auto c = char32_t(*it);
+
+        // ASCII はまとめて処理する
+        if (c <= 0x7f && (c || V != Variant::ModifiedUTF8)) {
+            auto run = EncodingImplement::SkipASCII(it, end, V != Variant::ModifiedUTF8);
+            ascii(it, std::size_t(run - it));
+            it = run;
+            continue;
+        }
+        ++it;
+        if (sizeof(Char) == sizeof(char32_t)) {
+            // UTF32
+            point(Unicode::IsSafeCharacter(c) ? c : Unicode::ReplacementCharacter);
+            continue;
+        }
+
+        c &= 0xffff;
+        if (V == Variant::UTF8 || V == Variant::WTF8) {
+            // 対になるサロゲートだけ合成する
+            if (Unicode::IsHighSurrogate(c) && it != end && Unicode::IsLowSurrogate(char32_t(*it & 0xffff))) {
+                c = 0x10000 + ((c - 0xd800) * 0x400) + (char32_t(*it++ & 0xffff) - 0xdc00);
+            }
+        }
+        if (V == Variant::UTF8 && Unicode::IsUnsafeCharacter(c)) {
+            c = Unicode::ReplacementCharacter;
+        }
+        point(c);
+    }
+}
+
+/// コードポイントの Variant 表現のユニット数を返す
+template <Variant V>
+constexpr auto VariantUnits(char32_t c) noexcept -> std::size_t
+{
+    if (V == Variant::ModifiedUTF8 && !c) return 2;
+    return c <= 0x7f ? 1 : c <= 0x7ff ? 2 : c <= 0xffff ? 3 : 4;
+}
+
+/// UTF16 (UTF32) を Variant で表現した際のユニット数を返す
+template <Variant V, class Char>
+auto EncodedUnits(const Char* from, const Char* end) noexcept -> std::size_t
+{
+    auto units = std::size_t {};
+    ScanUnits<V>(from, end,
+        [&](const Char*, std::size_t n) { units += n; },
+        [&](char32_t c) { units += VariantUnits<V>(c); });
+    return units;
+}
+
+/// UTF16 (UTF32) を Variant で表現して書き込み、書き込み終了位置を返す
+template <Variant V, class Char>
+auto EncodeTo(const Char* from, const Char* end, char* to) noexcept -> char*
+{
+    ScanUnits<V>(from, end,
+        [&](const Char* b, std::size_t n) { to = EncodingImplement::NarrowASCII(b, n, to); },
+        [&](char32_t c) {
+            if (V == Variant::ModifiedUTF8 && !c) {
+                *to++ = char(0xc0);
+                *to++ = char(0x80);
+                return;
+            }
+            to = std::get<1>(Unicode::ConvertUTF32ToUTF8(&c, to));
+        });
+    return to;
+}
+
+/// UTF16 (UTF32) を Variant で表現した文字列を返す
+template <Variant V, class Char>
+auto Encode(const Char* from, std::size_t units) -> std::string
+{
+    auto end = from + units;
+
+    // 出力サイズを確定させる
+    auto out = std::string(EncodedUnits<V>(from, end), '\0');
+    EncodeTo<V>(from, end, &out[0]);
+    return out;
+}
+
+/**
+ * @brief Variant で表現した文字列の各部分を通知する
+ * @param from Variant で表現した文字列
+ * @param ascii ASCII の範囲 (begin, units) を受け取る関数
+ * @param point ASCII 以外のコードポイントを受け取る関数 不正箇所は置き換え文字になる
+ */
+template <Variant V, class ASCII, class Point>
+auto ScanVariant(std::string_view from, ASCII ascii, Point point) -> void
+{
+    auto it = from.data();
+    auto end = it + from.size();
+    auto high = false;  // 直前が3ユニットのハイサロゲートか (WTF8)
+    while (it != end) {
+
+        // ASCII はまとめて処理する
+        if (!(*it & 0x80)) {
+            auto run = EncodingImplement::SkipASCII(it, end);
+            ascii(it, std::size_t(run - it));
+            it = run;
+            high = false;
+            continue;
+        }
+
+        if (V == Variant::ModifiedUTF8 && std::uint8_t(it[0]) == 0xc0 && end - it >= 2 && std::uint8_t(it[1]) == 0x80) {
+            point(char32_t());
+            it += 2;
+            continue;
+        }
+
+        auto to32 = EncodingUTF8ToUTF32If(it, end, IsAccept<V>);
+        auto c = std::get<1>(to32);
+        if (c == EncodingErrorNotEnough) {
+            it += EncodingImplement::IncompleteUnits(it, end, V != Variant::UTF8);
+            c = Unicode::ReplacementCharacter;
+        }
+        else {
+            it = std::get<0>(to32);
+            c = ReplacementIfEncodingError(c);
+        }
+        if (V == Variant::WTF8) {
+            // 対のサロゲートは4ユニットなので、3ユニットの対 (CESU8 の表現) のローサロゲートは置き換える
+            if (high && Unicode::IsLowSurrogate(c)) c = Unicode::ReplacementCharacter;
+            high = Unicode::IsHighSurrogate(c);
+        }
+        point(c);
+    }
+}
+
+/// Variant で表現した文字列を UTF16 (UTF32) にした際のユニット数を返す
+template <Variant V, class Char>
+auto DecodedUnits(std::string_view from) noexcept -> std::size_t
+{
+    auto units = std::size_t {};
+    ScanVariant<V>(from,
+        [&](const char*, std::size_t n) { units += n; },
+        [&](char32_t c) { units += (sizeof(Char) == sizeof(char16_t) && c > 0xffff) ? 2 : 1; });
+    return units;
+}
+
+/// Variant で表現した文字列を UTF16 (UTF32) にして書き込み、書き込み終了位置を返す
+template <Variant V, class Char>
+auto DecodeTo(std::string_view from, Char* to) noexcept -> Char*
+{
+    ScanVariant<V>(from,
+        [&](const char* b, std::size_t n) { to = EncodingImplement::WidenASCII(b, n, to); },
+        [&](char32_t c) {
+            if (sizeof(Char) == sizeof(char32_t)) {
+                *to++ = Char(c);
+            }
+            else {
+                to = std::get<1>(Unicode::ConvertUTF32ToUTF16(&c, to));
+            }
+        });
+    return to;
+}
+
+/// Variant で表現した文字列を UTF16 (UTF32) にする
+template <Variant V, class Char>
+auto Decode(std::string_view from) -> std::basic_string<Char>
+{
+    // 出力ユニット数は入力ユニット数を超えないので最大で確保して詰める
+    auto out = std::basic_string<Char>(from.size(), Char());
+    auto to = DecodeTo<V>(from, &out[0]);
+    out.resize(std::size_t(to - out.data()));
+    return out;
+}
+
+/// UTF16 (UTF32) の文字列群を UTF8 にして1つの領域に詰める
+template <class Char>
+auto EncodeBatch(const std::basic_string_view<Char>* from, std::size_t count) -> BatchString<char>
+{
+    // 全体の出力サイズを確定させ1度だけ確保する
+    auto units = std::size_t {};
+    for (auto i = std::size_t {}; i < count; ++i) {
+        units += EncodedUnits<Variant::UTF8>(from[i].data(), from[i].data() + from[i].size());
+    }
+
+    auto out = BatchString<char>(count, units);
+    auto offsets = out.offsets();
+    auto data = out.data();
+    auto to = data;
+    for (auto i = std::size_t {}; i < count; ++i) {
+        offsets[i] = std::size_t(to - data);
+        to = EncodeTo<Variant::UTF8>(from[i].data(), from[i].data() + from[i].size(), to);
+    }
+    offsets[count] = std::size_t(to - data);
+    return out;
+}
+
+/// UTF8 の文字列群を UTF16 (UTF32) にして1つの領域に詰める
+template <class Char>
+auto DecodeBatch(const std::string_view* from, std::size_t count) -> BatchString<Char>
+{
+    // 全体の出力サイズを確定させ1度だけ確保する
+    auto units = std::size_t {};
+    for (auto i = std::size_t {}; i < count; ++i) {
+        units += DecodedUnits<Variant::UTF8, Char>(from[i]);
+    }
+
+    auto out = BatchString<Char>(count, units);
+    auto offsets = out.offsets();
+    auto data = out.data();
+    auto to = data;
+    for (auto i = std::size_t {}; i < count; ++i) {
+        offsets[i] = std::size_t(to - data);
+        to = DecodeTo<Variant::UTF8>(from[i], to);
+    }
+    offsets[count] = std::size_t(to - data);
+    return out;
+}
+
+/// 後続データか
+constexpr auto IsFollow(char unit) noexcept -> bool
+{
+    return Unicode::IsFollowUnit(char8_t(unit));
+}
+
+/// 後続データ (ローサロゲート) か
+constexpr auto IsFollow(char16_t unit) noexcept -> bool
+{
+    return Unicode::IsFollowUnit(unit);
+}
+
+/// 立っているビット数を返す
+inline auto PopCount(unsigned int mask) noexcept -> std::size_t
+{
+    mask = mask - ((mask >> 1) & 0x5555'5555);
+    mask = (mask & 0x3333'3333) + ((mask >> 2) & 0x3333'3333);
+    return std::size_t((((mask + (mask >> 4)) & 0x0f0f'0f0f) * 0x0101'0101) >> 24);
+}
+
+/// 16 バイト中の先頭データの数を返す
+inline auto CountLeadUnits(const char* p) noexcept -> std::size_t
+{
+#ifdef PITS_ENCODING_SSE2
+    // 後続データ 0x80 ～ 0xbf は符号付きで -65 以下
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return PopCount(unsigned(_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(char(0xbf))))));
+#else
+    auto count = std::size_t {};
+    for (auto i = 0; i < 16; ++i) count += !IsFollow(p[i]);
+    return count;
+#endif
+}
+
+/// 8 ユニット中の先頭データ (ローサロゲート以外) の数を返す
+inline auto CountLeadUnits(const char16_t* p) noexcept -> std::size_t
+{
+#ifdef PITS_ENCODING_SSE2
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    auto low = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(0xfc00))), _mm_set1_epi16(short(0xdc00)));
+    return 8 - PopCount(unsigned(_mm_movemask_epi8(low))) / 2;
+#else
+    auto count = std::size_t {};
+    for (auto i = 0; i < 8; ++i) count += !IsFollow(p[i]);
+    return count;
+#endif
+}
+
+/// 末尾の count 文字を返す
+template <class Char>
+auto LastUnits(std::basic_string_view<Char> text, std::size_t count) noexcept -> std::basic_string_view<Char>
+{
+    constexpr auto lanes = std::ptrdiff_t(16 / sizeof(Char));
+    auto begin = text.data();
+    auto it = begin + text.size();
+
+    // 先頭データが count 個以上含まれるまで 16 バイト毎に戻る
+    for (; count && it - begin >= lanes; it -= lanes) {
+        auto leads = CountLeadUnits(it - lanes);
+        if (leads >= count) break;
+        count -= leads;
+    }
+
+    // 残りは1ユニットずつ戻る
+    while (count && it != begin) {
+        --it;
+        if (!IsFollow(*it)) --count;
+    }
+    return text.substr(std::size_t(it - begin));
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto SanitizedUTF8Units(std::string_view from) noexcept -> std::size_t
+{
+    auto units = std::size_t {};
+    ScanUTF8(from,
+        [&](const char* b, const char* e) { units += std::size_t(e - b); },
+        [&] { units += sizeof(ReplacementUTF8); });
+    return units;
+}
+
+auto IsSanitizedUTF8(std::string_view from) noexcept -> bool
+{
+    auto it = from.data();
+    auto end = it + from.size();
+    while (it != end) {
+        it = EncodingImplement::SkipASCII(it, end);
+        if (it == end) break;
+        auto to32 = EncodingUTF8ToUTF32(it, end);
+        if (std::get<1>(to32) > Unicode::CharacterMax) return false;
+        it = std::get<0>(to32);
+    }
+    return true;
+}
+
+auto SanitizeUTF8(std::string_view from) -> std::string
+{
+    // 出力サイズを確定させる
+    auto units = std::size_t {};
+    auto errors = std::size_t {};
+    ScanUTF8(from,
+        [&](const char* b, const char* e) { units += std::size_t(e - b); },
+        [&] { units += sizeof(ReplacementUTF8); ++errors; });
+
+    if (!errors) {
+        return std::string(from);
+    }
+
+    // 正しい範囲はまとめて複写し、不正箇所だけ置き換える
+    auto out = std::string(units, '\0');
+    auto to = &out[0];
+    ScanUTF8(from,
+        [&](const char* b, const char* e) {
+            std::memcpy(to, b, std::size_t(e - b));
+            to += e - b;
+        },
+        [&] {
+            std::memcpy(to, ReplacementUTF8, sizeof(ReplacementUTF8));
+            to += sizeof(ReplacementUTF8);
+        });
+    return out;
+}
+
+auto ToUTF8(std::u16string_view from) -> std::string
+{
+    return Encode<Variant::UTF8>(from.data(), from.size());
+}
+
+auto ToUTF8(std::u32string_view from) -> std::string
+{
+    return Encode<Variant::UTF8>(from.data(), from.size());
+}
+
+auto ToUTF16(std::string_view from) -> std::u16string
+{
+    return Decode<Variant::UTF8, char16_t>(from);
+}
+
+auto ToUTF32(std::string_view from) -> std::u32string
+{
+    return Decode<Variant::UTF8, char32_t>(from);
+}
+
+auto ToUTF8Batch(const std::u16string_view* from, std::size_t count) -> BatchString<char>
+{
+    return EncodeBatch(from, count);
+}
+
+auto ToUTF8Batch(const std::u32string_view* from, std::size_t count) -> BatchString<char>
+{
+    return EncodeBatch(from, count);
+}
+
+auto ToUTF16Batch(const std::string_view* from, std::size_t count) -> BatchString<char16_t>
+{
+    return DecodeBatch<char16_t>(from, count);
+}
+
+auto ToUTF32Batch(const std::string_view* from, std::size_t count) -> BatchString<char32_t>
+{
+    return DecodeBatch<char32_t>(from, count);
+}
+
+auto EncodeWTF8(std::u16string_view from) -> std::string
+{
+    return Encode<Variant::WTF8>(from.data(), from.size());
+}
+
+auto DecodeWTF8(std::string_view from) -> std::u16string
+{
+    return Decode<Variant::WTF8, char16_t>(from);
+}
+
+auto EncodeCESU8(std::u16string_view from) -> std::string
+{
+    return Encode<Variant::CESU8>(from.data(), from.size());
+}
+
+auto DecodeCESU8(std::string_view from) -> std::u16string
+{
+    return Decode<Variant::CESU8, char16_t>(from);
+}
+
+auto EncodeModifiedUTF8(std::u16string_view from) -> std::string
+{
+    return Encode<Variant::ModifiedUTF8>(from.data(), from.size());
+}
+
+auto DecodeModifiedUTF8(std::string_view from) -> std::u16string
+{
+    return Decode<Variant::ModifiedUTF8, char16_t>(from);
+}
+
+auto LastPoints(std::string_view text, std::size_t count) noexcept -> std::string_view
+{
+    return LastUnits(text, count);
+}
+
+auto LastPoints(std::u16string_view text, std::size_t count) noexcept -> std::u16string_view
+{
+    return LastUnits(text, count);
+}
+
 /*
  *
  */
 
 } // inline namespace Encoding
+
+/*
+ *
+ */
+
+namespace EncodingImplement {
+
+template <class Char>
+auto UTF16ToUTF8(const Char* from, std::size_t units) -> std::string
+{
+    return Encode<Variant::UTF8>(from, units);
+}
+
+template <class Char>
+auto UTF32ToUTF8(const Char* from, std::size_t units) -> std::string
+{
+    return Encode<Variant::UTF8>(from, units);
+}
+
+template <class Char>
+auto UTF8ToUTF16(std::string_view from) -> std::basic_string<Char>
+{
+    return Decode<Variant::UTF8, Char>(from);
+}
+
+template <class Char>
+auto UTF8ToUTF32(std::string_view from) -> std::basic_string<Char>
+{
+    return Decode<Variant::UTF8, Char>(from);
+}
+
+template <class Char>
+auto UTF16ToUTF8(const Char* from, std::size_t units, char* to) noexcept -> char*
+{
+    return EncodeTo<Variant::UTF8>(from, from + units, to);
+}
+
+template <class Char>
+auto UTF32ToUTF8(const Char* from, std::size_t units, char* to) noexcept -> char*
+{
+    return EncodeTo<Variant::UTF8>(from, from + units, to);
+}
+
+template <class Char>
+auto UTF8ToUTF16(std::string_view from, Char* to) noexcept -> Char*
+{
+    return DecodeTo<Variant::UTF8>(from, to);
+}
+
+template <class Char>
+auto UTF8ToUTF32(std::string_view from, Char* to) noexcept -> Char*
+{
+    return DecodeTo<Variant::UTF8>(from, to);
+}
+
+// wchar_t はビルド環境で UTF16, UTF32 どちらにもなるので両方用意する
+template auto UTF16ToUTF8(const wchar_t* from, std::size_t units) -> std::string;
+template auto UTF32ToUTF8(const wchar_t* from, std::size_t units) -> std::string;
+template auto UTF8ToUTF16(std::string_view from) -> std::wstring;
+template auto UTF8ToUTF32(std::string_view from) -> std::wstring;
+
+// 書き込み先を受け取る版は StringBuilder 等から各文字型で使う
+template auto UTF16ToUTF8(const char16_t* from, std::size_t units, char* to) noexcept -> char*;
+template auto UTF16ToUTF8(const wchar_t* from, std::size_t units, char* to) noexcept -> char*;
+template auto UTF32ToUTF8(const char32_t* from, std::size_t units, char* to) noexcept -> char*;
+template auto UTF32ToUTF8(const wchar_t* from, std::size_t units, char* to) noexcept -> char*;
+template auto UTF8ToUTF16(std::string_view from, char16_t* to) noexcept -> char16_t*;
+template auto UTF8ToUTF16(std::string_view from, wchar_t* to) noexcept -> wchar_t*;
+template auto UTF8ToUTF32(std::string_view from, char32_t* to) noexcept -> char32_t*;
+template auto UTF8ToUTF32(std::string_view from, wchar_t* to) noexcept -> wchar_t*;
+
+} // namespace EncodingImplement
 } // namespace Pits
 
 /*
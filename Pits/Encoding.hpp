@@ -9,8 +9,23 @@
 
 #include <uchar.h>  // __STDC_UTF_16__ __STDC_UTF_32__
 #include <array>
-#include <utility>  // pair
-#include <iterator> // iterator_traits
+#include <cstdint>  // uint64_t
+#include <cstring>  // memcpy
+#include <string>
+#include <string_view>
+#include <type_traits>  // enable_if_t
+#include <utility>  // pair exchange
+#include <iterator> // iterator_traits data size
+#include <memory>   // unique_ptr
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PITS_ENCODING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h> // _BitScanForward
+#endif
 
 #include "Pits/Unicode.hpp"
 
@@ -29,6 +44,255 @@ enum char8_t : unsigned char;
 
 namespace Pits {
 
+/**
+ * @brief 文字列エンコーディング関係の内部実装用名前空間
+ */
+namespace EncodingImplement {
+
+/// 最下位から連続する 0 ビット数を返す (mask は 0 以外である事)
+inline auto CountTrailingZeros(unsigned int mask) noexcept -> int
+{
+#ifdef _MSC_VER
+    unsigned long index {};
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief ASCII が続く範囲を読み飛ばす
+ * @param begin 開始位置
+ * @param end 終了位置
+ * @return 最初の非 ASCII 位置 無ければ end
+ */
+inline auto SkipASCII(const char* begin, const char* end) noexcept -> const char*
+{
+    auto it = begin;
+#ifdef PITS_ENCODING_SSE2
+    // 16 ユニット毎に最上位ビットを集めて判定
+    for (; end - it >= 16; it += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        if (auto mask = _mm_movemask_epi8(v)) {
+            return it + CountTrailingZeros(unsigned(mask));
+        }
+    }
+#else
+    // 8 ユニット毎に最上位ビットを判定
+    for (; end - it >= 8; it += 8) {
+        auto v = std::uint64_t {};
+        std::memcpy(&v, it, sizeof(v));
+        if (v & 0x8080'8080'8080'8080) break;
+    }
+#endif
+    for (; it != end; ++it) {
+        if (*it & 0x80) break;
+    }
+    return it;
+}
+
+/**
+ * @brief ASCII が続く範囲を読み飛ばす
+ * @param begin 開始位置
+ * @param end 終了位置
+ * @param nul ヌル文字を ASCII として扱うか (Modified UTF8 用)
+ * @return 最初の非 ASCII 位置 無ければ end
+ */
+template <class Char, std::enable_if_t<sizeof(Char) == 2 || sizeof(Char) == 4, int> = 0>
+inline auto SkipASCII(const Char* begin, const Char* end, bool nul = true) noexcept -> const Char*
+{
+    auto it = begin;
+#ifdef PITS_ENCODING_SSE2
+    // 16 バイト毎に 0x7f 以下か判定
+    constexpr auto lanes = 16 / sizeof(Char);
+    auto zero = _mm_setzero_si128();
+    for (; std::size_t(end - it) >= lanes; it += lanes) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        auto ascii = (sizeof(Char) == 2)
+            ? _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(0xff80))), zero)
+            : _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(int(0xffffff80))), zero);
+        if (!nul) {
+            auto nuls = (sizeof(Char) == 2) ? _mm_cmpeq_epi16(v, zero) : _mm_cmpeq_epi32(v, zero);
+            ascii = _mm_andnot_si128(nuls, ascii);
+        }
+        auto mask = unsigned(_mm_movemask_epi8(ascii)) ^ 0xffffu;
+        if (mask) {
+            return it + CountTrailingZeros(mask) / sizeof(Char);
+        }
+    }
+#endif
+    for (; it != end; ++it) {
+        if (char32_t(*it) > 0x7f || (!nul && !*it)) break;
+    }
+    return it;
+}
+
+/**
+ * @brief ASCII 範囲の UTF16 (UTF32) を UTF8 へ詰めて複写する
+ * @param from 複写元 全て 0x7f 以下である事
+ * @param units ユニット数
+ * @param to 複写先
+ * @return 複写後の to
+ */
+template <class Char, std::enable_if_t<sizeof(Char) == 2 || sizeof(Char) == 4, int> = 0>
+inline auto NarrowASCII(const Char* from, std::size_t units, char* to) noexcept -> char*
+{
+    auto end = from + units;
+#ifdef PITS_ENCODING_SSE2
+    for (; end - from >= 16; from += 16, to += 16) {
+        auto p = reinterpret_cast<const __m128i*>(from);
+        auto lo = _mm_loadu_si128(p);
+        auto hi = _mm_loadu_si128(p + 1);
+        if (sizeof(Char) == 4) {
+            lo = _mm_packs_epi32(lo, hi);
+            hi = _mm_packs_epi32(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(to), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    while (from != end) *to++ = char(*from++);
+    return to;
+}
+
+/**
+ * @brief ASCII 範囲の UTF8 を UTF16 (UTF32) へ広げて複写する
+ * @param from 複写元 全て 0x7f 以下である事
+ * @param units ユニット数
+ * @param to 複写先
+ * @return 複写後の to
+ */
+template <class Char, std::enable_if_t<sizeof(Char) == 2 || sizeof(Char) == 4, int> = 0>
+inline auto WidenASCII(const char* from, std::size_t units, Char* to) noexcept -> Char*
+{
+    auto end = from + units;
+#ifdef PITS_ENCODING_SSE2
+    auto zero = _mm_setzero_si128();
+    for (; end - from >= 16; from += 16, to += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from));
+        auto lo = _mm_unpacklo_epi8(v, zero);
+        auto hi = _mm_unpackhi_epi8(v, zero);
+        auto p = reinterpret_cast<__m128i*>(to);
+        if (sizeof(Char) == 2) {
+            _mm_storeu_si128(p + 0, lo);
+            _mm_storeu_si128(p + 1, hi);
+        }
+        else {
+            _mm_storeu_si128(p + 0, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(p + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(p + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(p + 3, _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#endif
+    while (from != end) *to++ = Char(*from++);
+    return to;
+}
+
+/**
+ * @brief 末尾の不完全なシーケンスのうち1文字で置き換える範囲のユニット数を返す
+ *
+ * 2ユニット目に許される範囲は先頭ユニットで変わる (Unicode Table 3-7)
+ * 3ユニット目以降は EncodingUTF8ToUTF32 が後続データである事を確認済み
+ * surrogates が真ならサロゲート (WTF8, CESU8) も受け入れる
+ */
+inline auto IncompleteUnits(const char* it, const char* end, bool surrogates = false) noexcept -> std::size_t
+{
+    auto units = std::size_t(end - it);
+    if (units < 2) return 1;
+
+    auto lead = unsigned(std::uint8_t(it[0]));
+    auto next = unsigned(std::uint8_t(it[1]));
+    auto min = 0x80u;
+    auto max = 0xbfu;
+    switch (lead) {
+    case 0xe0: min = 0xa0; break;   // 非最短
+    case 0xed: max = surrogates ? 0xbf : 0x9f; break;   // サロゲート
+    case 0xf0: min = 0x90; break;   // 非最短
+    case 0xf4: max = 0x8f; break;   // 10'ffff 超え
+    }
+    if (lead < 0xc2 || 0xf4 < lead || next < min || max < next) return 1;
+    return units;
+}
+
+/**
+ * @brief UTF16 を UTF8 文字列にする (不正なシーケンスは置き換える)
+ * @param from UTF16 (char16_t, wchar_t)
+ * @param units ユニット数
+ * @return UTF8 文字列
+ */
+template <class Char>
+auto UTF16ToUTF8(const Char* from, std::size_t units) -> std::string;
+
+/**
+ * @brief UTF32 を UTF8 文字列にする (不正なコードは置き換える)
+ * @param from UTF32 (char32_t, wchar_t)
+ * @param units ユニット数
+ * @return UTF8 文字列
+ */
+template <class Char>
+auto UTF32ToUTF8(const Char* from, std::size_t units) -> std::string;
+
+/**
+ * @brief UTF8 を UTF16 文字列にする (不正なシーケンスは置き換える)
+ * @param from UTF8 文字列
+ * @return UTF16 (char16_t, wchar_t) 文字列
+ */
+template <class Char>
+auto UTF8ToUTF16(std::string_view from) -> std::basic_string<Char>;
+
+/**
+ * @brief UTF8 を UTF32 文字列にする (不正なシーケンスは置き換える)
+ * @param from UTF8 文字列
+ * @return UTF32 (char32_t, wchar_t) 文字列
+ */
+template <class Char>
+auto UTF8ToUTF32(std::string_view from) -> std::basic_string<Char>;
+
+/**
+ * @brief UTF16 を UTF8 にして書き込む (不正なシーケンスは置き換える)
+ * @param from UTF16 (char16_t, wchar_t)
+ * @param units ユニット数
+ * @param to 書き込み先 units * 3 要素必要
+ * @return 書き込み終了位置
+ */
+template <class Char>
+auto UTF16ToUTF8(const Char* from, std::size_t units, char* to) noexcept -> char*;
+
+/**
+ * @brief UTF32 を UTF8 にして書き込む (不正なコードは置き換える)
+ * @param from UTF32 (char32_t, wchar_t)
+ * @param units ユニット数
+ * @param to 書き込み先 units * 4 要素必要
+ * @return 書き込み終了位置
+ */
+template <class Char>
+auto UTF32ToUTF8(const Char* from, std::size_t units, char* to) noexcept -> char*;
+
+/**
+ * @brief UTF8 を UTF16 にして書き込む (不正なシーケンスは置き換える)
+ * @param from UTF8 文字列
+ * @param to 書き込み先 (char16_t, wchar_t) from.size() 要素必要
+ * @return 書き込み終了位置
+ */
+template <class Char>
+auto UTF8ToUTF16(std::string_view from, Char* to) noexcept -> Char*;
+
+/**
+ * @brief UTF8 を UTF32 にして書き込む (不正なシーケンスは置き換える)
+ * @param from UTF8 文字列
+ * @param to 書き込み先 (char32_t, wchar_t) from.size() 要素必要
+ * @return 書き込み終了位置
+ */
+template <class Char>
+auto UTF8ToUTF32(std::string_view from, Char* to) noexcept -> Char*;
+
+/*
+ *
+ */
+
+} // namespace EncodingImplement
+
 /**
  * @brief 文字列エンコーディング関係
  */
@@ -113,19 +377,20 @@ constexpr auto EncodingUTF32ToUTF16(UTF32InIter begin, UTF32InIter end, UTF16Ins
 }
 
 /**
- * @brief イテレータが示す位置を UTF8 から UTF32 へ一文字変換する Unicode11準拠
+ * @brief イテレータが示す位置を UTF8 系エンコーディングから UTF32 へ一文字変換する
  *
- * ステートを持たない為、中途位置はエラー扱いになる
+ * UTF8, WTF8, CESU8 の違いは受け入れるコードポイントだけなので共通化している
  * 
  * @param it 変換開始位置 end 以外の位置である事
  * @param end コンテナ終端位置 イテレータの forward 移動が安全であるなら正しくなくともよい
+ * @param accept 受け入れるコードポイントで有るか返す関数 偽なら不正なシーケンス扱い
  * 
  * @return 文字, 移動後イテレータ をペアで返す
  */
-template <class UTF8Iterator,
+template <class UTF8Iterator, class Accept,
     class = typename std::iterator_traits<UTF8Iterator>::value_type
 >
-constexpr auto EncodingUTF8ToUTF32(UTF8Iterator begin, UTF8Iterator end = UTF8Iterator())
+constexpr auto EncodingUTF8ToUTF32If(UTF8Iterator begin, UTF8Iterator end, Accept accept)
     noexcept(noexcept(*begin++))
     -> std::pair<UTF8Iterator, char32_t>
 {
@@ -140,7 +405,11 @@ constexpr auto EncodingUTF8ToUTF32(UTF8Iterator begin, UTF8Iterator end = UTF8It
     auto min = char32_t {};
     auto req = int {};
 
-    /**/ if (c <= 0b0'1101'1111) {   // c0 ～ df 80 ～ 7ff 5+6 
+    /**/ if (c <= 0b0'1011'1111) {   // 80 ～ bf 後続データから始まっている
+        // 読み込みコードポイント毎に置き換え
+        return {it, EncodingErrorIllegalSequence};
+    }
+    else if (c <= 0b0'1101'1111) {   // c0 ～ df 80 ～ 7ff 5+6 
         c &= 0b0'0001'1111;
         min = 0x80;
         req = 1;
@@ -179,7 +448,7 @@ constexpr auto EncodingUTF8ToUTF32(UTF8Iterator begin, UTF8Iterator end = UTF8It
             for (; req; --req) c <<= 6;
 
             // 不正コードなら読み込みコードポイント毎に置き換え
-            if (c < min || Unicode::IsUnsafeCharacter(c)) {
+            if (c < min || !accept(c)) {
                 return {++begin, EncodingErrorIllegalSequence};
             }
 
@@ -189,7 +458,7 @@ constexpr auto EncodingUTF8ToUTF32(UTF8Iterator begin, UTF8Iterator end = UTF8It
     }
 
     // 不正コードなら読み込みコードポイント毎に置き換え
-    if (c < min || Unicode::IsUnsafeCharacter(c)) {
+    if (c < min || !accept(c)) {
         return {++begin, EncodingErrorIllegalSequence};
     }
 
@@ -197,6 +466,26 @@ constexpr auto EncodingUTF8ToUTF32(UTF8Iterator begin, UTF8Iterator end = UTF8It
     return {it, c};
 }
 
+/**
+ * @brief イテレータが示す位置を UTF8 から UTF32 へ一文字変換する Unicode11準拠
+ *
+ * ステートを持たない為、中途位置はエラー扱いになる
+ * 
+ * @param it 変換開始位置 end 以外の位置である事
+ * @param end コンテナ終端位置 イテレータの forward 移動が安全であるなら正しくなくともよい
+ * 
+ * @return 文字, 移動後イテレータ をペアで返す
+ */
+template <class UTF8Iterator,
+    class = typename std::iterator_traits<UTF8Iterator>::value_type
+>
+constexpr auto EncodingUTF8ToUTF32(UTF8Iterator begin, UTF8Iterator end = UTF8Iterator())
+    noexcept(noexcept(*begin++))
+    -> std::pair<UTF8Iterator, char32_t>
+{
+    return EncodingUTF8ToUTF32If(begin, end, Unicode::IsSafeCharacter);
+}
+
 /**
  * @brief UTF8 を UTF32 に変換する
  *
@@ -385,6 +674,653 @@ constexpr auto EncodingUTF8ToUTF16(UTF8Iterator begin, UTF8Iterator end, UTF16In
     return {it, to};
 }
 
+/**
+ * @brief UTF8 を UTF8 に変換する 不正なシーケンスは置き換える
+ *
+ * 置き換え規則は EncodingUTF8ToUTF32 と同じ (最大部分毎に置き換え)
+ * 正しいシーケンスは読み込んだデータをそのまま書き出す
+ *
+ * @param begin 読み込み開始位置
+ * @param end 読み込み終了位置
+ * @param to 出力位置 最大3倍のサイズが必要
+ *
+ * @return 移動後の begin, to
+ */
+template <class UTF8Iterator, class UTF8Inserter,
+    class = typename std::iterator_traits<UTF8Iterator>::value_type,
+    class = typename std::iterator_traits<UTF8Inserter>::value_type
+>
+constexpr auto EncodingUTF8ToUTF8(UTF8Iterator begin, UTF8Iterator end, UTF8Inserter to)
+    noexcept(noexcept(*to++ = char8_t(*begin++)))
+    -> std::pair<UTF8Iterator, UTF8Inserter>
+{
+    auto it = begin;
+    while (it != end) {
+
+        // UTF32 化して検査
+        auto to32 = EncodingUTF8ToUTF32(it, end);
+
+        // シーケンス中途で end なら終える
+        auto c = std::get<1>(to32);
+        if (c == EncodingErrorNotEnough) break;
+        auto next = std::get<0>(to32);
+
+        if (c <= Unicode::CharacterMax) {
+            // 正しいシーケンスは最短形式なのでそのまま写す
+            while (it != next) *to++ = char8_t(*it++);
+        }
+        else {
+            it = next;
+            auto safe = Unicode::ReplacementCharacter;
+            auto to8 = Unicode::ConvertUTF32ToUTF8(&safe, to);
+            to = std::get<1>(to8);
+        }
+    }
+    return {it, to};
+}
+
+/**
+ * @brief UTF8 の不正なシーケンスを置き換えた後のユニット数を返す
+ *
+ * 置き換え規則は EncodingUTF8ToUTF8 と同じで、末尾の不完全なシーケンスも置き換える
+ *
+ * @param from UTF8 文字列
+ * @return 置き換え後のユニット数
+ */
+auto SanitizedUTF8Units(std::string_view from) noexcept -> std::size_t;
+
+/**
+ * @brief UTF8 が置き換えの必要ない正しいシーケンスであるか返す
+ * @param from UTF8 文字列
+ * @return 真偽
+ */
+auto IsSanitizedUTF8(std::string_view from) noexcept -> bool;
+
+/**
+ * @brief UTF8 の不正なシーケンスを置き換えた文字列を返す
+ *
+ * UTF8 => UTF32 => UTF8 の往復と同じ結果になるが、末尾の不完全なシーケンスは捨てずに置き換える
+ * 出力サイズを先に確定させるので確保は1回、正しい範囲はまとめて複写する
+ *
+ * @param from UTF8 文字列
+ * @return 置き換え後の文字列
+ */
+auto SanitizeUTF8(std::string_view from) -> std::string;
+
+/**
+ * @brief UTF16 を WTF8 に変換する
+ *
+ * 対になっていないサロゲートも3ユニットで表現するので UTF16 へ欠損無く戻せる
+ * 非キャラクタも置き換えない
+ *
+ * @param begin 読み込み開始位置
+ * @param end 読み込み終了位置
+ * @param to 出力位置
+ *
+ * @return 移動後の begin, to 末尾のハイサロゲートは対が続く可能性があるので残す
+ */
+template <class UTF16Iterator, class UTF8Inserter,
+    class = typename std::iterator_traits<UTF16Iterator>::value_type,
+    class = typename std::iterator_traits<UTF8Inserter>::value_type
+>
+constexpr auto EncodingUTF16ToWTF8(UTF16Iterator begin, UTF16Iterator end, UTF8Inserter to)
+    noexcept(noexcept(*to++ = char8_t(*begin++)))
+    -> std::pair<UTF16Iterator, UTF8Inserter>
+{
+    auto it = begin;
+    while (it != end) {
+
+        auto next = it;
+        auto c = char32_t(*next++ & 0xffff);
+
+        // 対になるサロゲートだけ合成する
+        if (Unicode::IsHighSurrogate(c)) {
+            if (next == end) break;
+            auto l = char32_t(*next & 0xffff);
+            if (Unicode::IsLowSurrogate(l)) {
+                c = 0x10000 + ((c - 0xd800) * 0x400) + (l - 0xdc00);
+                ++next;
+            }
+        }
+        it = next;
+
+        auto to8 = Unicode::ConvertUTF32ToUTF8(&c, to);
+        to = std::get<1>(to8);
+    }
+    return {it, to};
+}
+
+/**
+ * @brief WTF8 を UTF16 に変換する
+ *
+ * サロゲートと非キャラクタを受け入れる以外は EncodingUTF8ToUTF16 と同じ
+ * 対のサロゲートは4ユニットで表現するので、3ユニットのハイサロゲートに続く
+ * 3ユニットのローサロゲート (CESU8 の表現) は不正なシーケンスとして置き換える
+ *
+ * @param begin 読み込み開始位置
+ * @param end 読み込み終了位置
+ * @param to 出力位置
+ *
+ * @return 移動後の begin, to
+ */
+template <class UTF8Iterator, class UTF16Inserter,
+    class = typename std::iterator_traits<UTF8Iterator>::value_type,
+    class = typename std::iterator_traits<UTF16Inserter>::value_type
+>
+constexpr auto EncodingWTF8ToUTF16(UTF8Iterator begin, UTF8Iterator end, UTF16Inserter to)
+    noexcept(noexcept(*to++ = char16_t(*begin++)))
+    -> std::pair<UTF8Iterator, UTF16Inserter>
+{
+    auto it = begin;
+    auto high = false;  // 直前が3ユニットのハイサロゲートか
+    while (it != end) {
+
+        auto to32 = EncodingUTF8ToUTF32If(it, end, [](char32_t c) { return c <= Unicode::CharacterMax; });
+
+        // シーケンス中途で end なら終える
+        auto c = std::get<1>(to32);
+        if (c == EncodingErrorNotEnough) break;
+        it = std::get<0>(to32);
+        auto safe = ReplacementIfEncodingError(c);
+        if (high && Unicode::IsLowSurrogate(safe)) safe = Unicode::ReplacementCharacter;
+        high = Unicode::IsHighSurrogate(safe);
+
+        // サロゲートはそのまま1ユニットになる
+        auto to16 = Unicode::ConvertUTF32ToUTF16(&safe, to);
+        to = std::get<1>(to16);
+    }
+    return {it, to};
+}
+
+/**
+ * @brief UTF16 を CESU8 (Modified UTF8) に変換する
+ *
+ * UTF16 の1ユニット毎に 1 ～ 3 ユニットで表現するので対になっていないサロゲートも欠損無く戻せる
+ *
+ * @param begin 読み込み開始位置
+ * @param end 読み込み終了位置
+ * @param to 出力位置
+ * @param modified ヌル文字を c0 80 で表現する Java の Modified UTF8 にするか
+ *
+ * @return 移動後の begin, to
+ */
+template <class UTF16Iterator, class UTF8Inserter,
+    class = typename std::iterator_traits<UTF16Iterator>::value_type,
+    class = typename std::iterator_traits<UTF8Inserter>::value_type
+>
+constexpr auto EncodingUTF16ToCESU8(UTF16Iterator begin, UTF16Iterator end, UTF8Inserter to, bool modified = false)
+    noexcept(noexcept(*to++ = char8_t(*begin++)))
+    -> std::pair<UTF16Iterator, UTF8Inserter>
+{
+    auto it = begin;
+    while (it != end) {
+        auto c = char32_t(*it++ & 0xffff);
+        if (modified && !c) {
+            *to++ = char8_t(0xc0);
+            *to++ = char8_t(0x80);
+            continue;
+        }
+        auto to8 = Unicode::ConvertUTF32ToUTF8(&c, to);
+        to = std::get<1>(to8);
+    }
+    return {it, to};
+}
+
+/**
+ * @brief CESU8 (Modified UTF8) を UTF16 に変換する
+ *
+ * 1 ～ 3 ユニットのシーケンスを UTF16 の1ユニットにする 4ユニットのシーケンスは不正扱い
+ *
+ * @param begin 読み込み開始位置
+ * @param end 読み込み終了位置
+ * @param to 出力位置
+ * @param modified c0 80 をヌル文字として受け入れる Java の Modified UTF8 にするか
+ *
+ * @return 移動後の begin, to
+ */
+template <class UTF8Iterator, class UTF16Inserter,
+    class = typename std::iterator_traits<UTF8Iterator>::value_type,
+    class = typename std::iterator_traits<UTF16Inserter>::value_type
+>
+constexpr auto EncodingCESU8ToUTF16(UTF8Iterator begin, UTF8Iterator end, UTF16Inserter to, bool modified = false)
+    noexcept(noexcept(*to++ = char16_t(*begin++)))
+    -> std::pair<UTF8Iterator, UTF16Inserter>
+{
+    auto it = begin;
+    while (it != end) {
+
+        // ヌル文字の2ユニット表現
+        if (modified && char32_t(*it & 0xff) == 0xc0) {
+            auto next = it;
+            if (++next == end) break;
+            if (char32_t(*next & 0xff) == 0x80) {
+                it = ++next;
+                *to++ = char16_t(0);
+                continue;
+            }
+        }
+
+        auto to32 = EncodingUTF8ToUTF32If(it, end, [](char32_t c) { return c <= 0xffff; });
+
+        // シーケンス中途で end なら終える
+        auto c = std::get<1>(to32);
+        if (c == EncodingErrorNotEnough) break;
+        it = std::get<0>(to32);
+
+        *to++ = char16_t(ReplacementIfEncodingError(c));
+    }
+    return {it, to};
+}
+
+/**
+ * @brief UTF8 から1文字読み込む 不正なシーケンスは置き換える
+ *
+ * ToUTF16 等と同じ規則で、末尾の不完全なシーケンスも置き換える
+ *
+ * @param it 読み込み位置 end 以外である事 (読み込んだ分進む)
+ * @param end 終了位置
+ * @return 文字
+ */
+inline auto NextPoint(const char*& it, const char* end) noexcept -> char32_t
+{
+    auto c = char32_t(std::uint8_t(*it));
+    if (c <= 0x7f) {
+        ++it;
+        return c;
+    }
+    auto to32 = EncodingUTF8ToUTF32(it, end);
+    c = std::get<1>(to32);
+    if (c == EncodingErrorNotEnough) {
+        it += EncodingImplement::IncompleteUnits(it, end);
+        return Unicode::ReplacementCharacter;
+    }
+    it = std::get<0>(to32);
+    return ReplacementIfEncodingError(c);
+}
+
+/**
+ * @brief UTF16 から1文字読み込む 不正なサロゲートと非キャラクタは置き換える
+ * @param it 読み込み位置 end 以外である事 (読み込んだ分進む)
+ * @param end 終了位置
+ * @return 文字
+ */
+inline auto NextPoint(const char16_t*& it, const char16_t* end) noexcept -> char32_t
+{
+    auto c = char32_t(*it++);
+    if (Unicode::IsHighSurrogate(c) && it != end && Unicode::IsLowSurrogate(*it)) {
+        c = 0x10000 + ((c - 0xd800) * 0x400) + (*it++ - 0xdc00);
+    }
+    return Unicode::IsSafeCharacter(c) ? c : Unicode::ReplacementCharacter;
+}
+
+/**
+ * @brief UTF32 から1文字読み込む 不正なコードは置き換える
+ * @param it 読み込み位置 end 以外である事 (読み込んだ分進む)
+ * @param end 終了位置
+ * @return 文字
+ */
+inline auto NextPoint(const char32_t*& it, const char32_t* end) noexcept -> char32_t
+{
+    static_cast<void>(end);
+    auto c = *it++;
+    return Unicode::IsSafeCharacter(c) ? c : Unicode::ReplacementCharacter;
+}
+
+/**
+ * @brief UTF8 から1文字前を読み込む 不正なシーケンスは置き換える
+ *
+ * 後続データを最大3ユニット戻って先頭データを探し、NextPoint で同じ文字を読む位置へ戻る
+ * 文字列の長さに依らず一定時間で終わる
+ *
+ * @param begin 開始位置
+ * @param it 読み込み位置 begin 以外の文字の境界である事 (読み込んだ分戻る)
+ * @param end 終了位置
+ * @return 文字
+ */
+inline auto PreviousPoint(const char* begin, const char*& it, const char* end) noexcept -> char32_t
+{
+    auto lead = it - 1;
+    for (auto n = 0; lead != begin && Unicode::IsFollowUnit(char8_t(*lead)) && n < 3; ++n) --lead;
+    auto next = lead;
+    auto c = NextPoint(next, end);
+    if (next < it) {
+        // 先頭データのシーケンスが it より前で終わるなら、直前の1ユニットが不正なシーケンス
+        --it;
+        return Unicode::ReplacementCharacter;
+    }
+    it = lead;
+    return c;
+}
+
+/**
+ * @brief UTF16 から1文字前を読み込む 不正なサロゲートと非キャラクタは置き換える
+ * @param begin 開始位置
+ * @param it 読み込み位置 begin 以外の文字の境界である事 (読み込んだ分戻る)
+ * @param end 終了位置
+ * @return 文字
+ */
+inline auto PreviousPoint(const char16_t* begin, const char16_t*& it, const char16_t* end) noexcept -> char32_t
+{
+    --it;
+    if (it != begin && Unicode::IsLowSurrogate(*it) && Unicode::IsHighSurrogate(it[-1])) --it;
+    auto next = it;
+    return NextPoint(next, end);
+}
+
+/**
+ * @brief UTF32 から1文字前を読み込む 不正なコードは置き換える
+ * @param begin 開始位置
+ * @param it 読み込み位置 begin 以外である事 (読み込んだ分戻る)
+ * @param end 終了位置
+ * @return 文字
+ */
+inline auto PreviousPoint(const char32_t* begin, const char32_t*& it, const char32_t* end) noexcept -> char32_t
+{
+    static_cast<void>(begin);
+    static_cast<void>(end);
+    auto c = *--it;
+    return Unicode::IsSafeCharacter(c) ? c : Unicode::ReplacementCharacter;
+}
+
+/**
+ * @brief UTF8 を文字の途中で切らずに units ユニット以下に切り詰める
+ *
+ * 切る位置から最大3ユニット戻って先頭データを探すので、文字列の長さに依らず一定時間で終わる
+ * 不正なシーケンスは NextPoint と同じ単位で扱う
+ *
+ * @param text UTF8 文字列
+ * @param units 最大ユニット数 (バイト数)
+ * @return 先頭部分
+ */
+inline auto TruncateUnits(std::string_view text, std::size_t units) noexcept -> std::string_view
+{
+    if (text.size() <= units) return text;
+    auto begin = text.data();
+    auto cut = begin + units;
+    auto lead = cut;
+    for (auto n = 0; lead != begin && Unicode::IsFollowUnit(char8_t(*lead)) && n < 3; ++n) --lead;
+    if (lead != cut) {
+        // 切る位置を跨ぐシーケンスなら、その先頭で切る
+        auto next = lead;
+        NextPoint(next, begin + text.size());
+        if (next > cut) cut = lead;
+    }
+    return text.substr(0, std::size_t(cut - begin));
+}
+
+/**
+ * @brief UTF16 をサロゲートペアの途中で切らずに units ユニット以下に切り詰める
+ * @param text UTF16 文字列
+ * @param units 最大ユニット数
+ * @return 先頭部分
+ */
+inline auto TruncateUnits(std::u16string_view text, std::size_t units) noexcept -> std::u16string_view
+{
+    if (text.size() <= units) return text;
+    if (units && Unicode::IsLowSurrogate(text[units]) && Unicode::IsHighSurrogate(text[units - 1])) --units;
+    return text.substr(0, units);
+}
+
+/**
+ * @brief 末尾の count 文字を返す
+ *
+ * 末尾から 16 バイト毎に先頭データを数え、先頭から走査しない
+ * 文字数は Unicode::Points と同じく先頭データ (UTF16 はローサロゲート以外) の数
+ *
+ * @param text UTF8 文字列
+ * @param count 文字数
+ * @return 末尾部分 count 文字に満たなければ text
+ */
+auto LastPoints(std::string_view text, std::size_t count) noexcept -> std::string_view;
+
+/**
+ * @brief 末尾の count 文字を返す
+ * @param text UTF16 文字列
+ * @param count 文字数
+ * @return 末尾部分 count 文字に満たなければ text
+ */
+auto LastPoints(std::u16string_view text, std::size_t count) noexcept -> std::u16string_view;
+
+/**
+ * @brief UTF16 を UTF8 文字列にする
+ *
+ * EncodingUTF16ToUTF8 と同じ置き換え規則で、出力サイズを先に確定させ ASCII はまとめて変換する
+ * 末尾のハイサロゲートも置き換える
+ *
+ * @param from UTF16 文字列
+ * @return UTF8 文字列
+ */
+auto ToUTF8(std::u16string_view from) -> std::string;
+
+/**
+ * @brief UTF32 を UTF8 文字列にする
+ * @param from UTF32 文字列
+ * @return UTF8 文字列
+ */
+auto ToUTF8(std::u32string_view from) -> std::string;
+
+/**
+ * @brief UTF8 を UTF16 文字列にする
+ *
+ * EncodingUTF8ToUTF16 と同じ置き換え規則で、末尾の不完全なシーケンスも置き換える
+ * 入力ユニット数分を1回確保して詰める
+ *
+ * @param from UTF8 文字列
+ * @return UTF16 文字列
+ */
+auto ToUTF16(std::string_view from) -> std::u16string;
+
+/**
+ * @brief UTF8 を UTF32 文字列にする
+ * @param from UTF8 文字列
+ * @return UTF32 文字列
+ */
+auto ToUTF32(std::string_view from) -> std::u32string;
+
+/**
+ * @brief 複数の文字列をまとめて変換した結果
+ *
+ * オフセット表と変換後の文字列を1つの領域に確保する
+ * i 番目の文字列は data() + offsets()[i] から offsets()[i + 1] の手前まで
+ * 移動元は文字列の無い結果になる (data() と offsets() は nullptr, units() は 0)
+ */
+template <class Char>
+class BatchString
+{
+public:
+
+    /// 各文字列を参照する型
+    using value_type = std::basic_string_view<Char>;
+
+    BatchString(const BatchString&) = delete;
+    BatchString& operator=(const BatchString&) = delete;
+
+    BatchString(BatchString&& other) noexcept
+        : buffer_(std::move(other.buffer_)), count_(std::exchange(other.count_, 0))
+    {
+    }
+
+    auto operator=(BatchString&& other) noexcept -> BatchString&
+    {
+        buffer_ = std::move(other.buffer_);
+        count_ = std::exchange(other.count_, 0);
+        return *this;
+    }
+
+    /// 空の結果を作る
+    BatchString() : BatchString(0, 0) {}
+
+    /**
+     * @brief 領域を確保する
+     * @param count 文字列数
+     * @param units 全文字列の合計ユニット数
+     */
+    BatchString(std::size_t count, std::size_t units)
+        : buffer_(new std::size_t[count + 1 + (units * sizeof(Char) + sizeof(std::size_t) - 1) / sizeof(std::size_t)] {})
+        , count_(count)
+    {
+    }
+
+    /// 文字列数を返す
+    auto size() const noexcept -> std::size_t { return count_; }
+
+    /// 文字列が無いか返す
+    auto empty() const noexcept -> bool { return !count_; }
+
+    /// i 番目の文字列を返す
+    auto operator[](std::size_t i) const noexcept -> value_type
+    {
+        return value_type(data() + buffer_[i], buffer_[i + 1] - buffer_[i]);
+    }
+
+    /// 文字列数 + 1 個のオフセット表を返す
+    auto offsets() const noexcept -> const std::size_t* { return buffer_.get(); }
+
+    /// 文字列数 + 1 個のオフセット表を返す (書き込み用)
+    auto offsets() noexcept -> std::size_t* { return buffer_.get(); }
+
+    /// 全文字列を連結した領域を返す
+    auto data() const noexcept -> const Char*
+    {
+        return buffer_ ? reinterpret_cast<const Char*>(buffer_.get() + count_ + 1) : nullptr;
+    }
+
+    /// 全文字列を連結した領域を返す (書き込み用)
+    auto data() noexcept -> Char*
+    {
+        return buffer_ ? reinterpret_cast<Char*>(buffer_.get() + count_ + 1) : nullptr;
+    }
+
+    /// 全文字列の合計ユニット数を返す
+    auto units() const noexcept -> std::size_t { return buffer_ ? buffer_[count_] : 0; }
+
+private:
+
+    /// オフセット表と文字列の領域
+    std::unique_ptr<std::size_t[]> buffer_;
+
+    /// 文字列数
+    std::size_t count_ {};
+};
+
+/**
+ * @brief UTF16 の文字列群を UTF8 にして1つの領域に詰める
+ *
+ * 全体の出力サイズを先に確定させ、確保は1度だけ行う
+ * 置き換え規則は ToUTF8 と同じ
+ *
+ * @param from UTF16 文字列の配列
+ * @param count 文字列数
+ * @return 変換結果
+ */
+auto ToUTF8Batch(const std::u16string_view* from, std::size_t count) -> BatchString<char>;
+
+/**
+ * @brief UTF32 の文字列群を UTF8 にして1つの領域に詰める
+ * @param from UTF32 文字列の配列
+ * @param count 文字列数
+ * @return 変換結果
+ */
+auto ToUTF8Batch(const std::u32string_view* from, std::size_t count) -> BatchString<char>;
+
+/**
+ * @brief UTF8 の文字列群を UTF16 にして1つの領域に詰める
+ *
+ * 全体の出力サイズを先に確定させ、確保は1度だけ行う
+ * 置き換え規則は ToUTF16 と同じ
+ *
+ * @param from UTF8 文字列の配列
+ * @param count 文字列数
+ * @return 変換結果
+ */
+auto ToUTF16Batch(const std::string_view* from, std::size_t count) -> BatchString<char16_t>;
+
+/**
+ * @brief UTF8 の文字列群を UTF32 にして1つの領域に詰める
+ * @param from UTF8 文字列の配列
+ * @param count 文字列数
+ * @return 変換結果
+ */
+auto ToUTF32Batch(const std::string_view* from, std::size_t count) -> BatchString<char32_t>;
+
+/**
+ * @brief 連続したコンテナ (vector, array 等) の文字列群を UTF8 にして1つの領域に詰める
+ * @param from u16string_view (u32string_view) のコンテナ
+ * @return 変換結果
+ */
+template <class Views>
+auto ToUTF8Batch(const Views& from) -> decltype(ToUTF8Batch(std::data(from), std::size(from)))
+{
+    return ToUTF8Batch(std::data(from), std::size(from));
+}
+
+/**
+ * @brief 連続したコンテナ (vector, array 等) の文字列群を UTF16 にして1つの領域に詰める
+ * @param from string_view のコンテナ
+ * @return 変換結果
+ */
+template <class Views>
+auto ToUTF16Batch(const Views& from) -> decltype(ToUTF16Batch(std::data(from), std::size(from)))
+{
+    return ToUTF16Batch(std::data(from), std::size(from));
+}
+
+/**
+ * @brief 連続したコンテナ (vector, array 等) の文字列群を UTF32 にして1つの領域に詰める
+ * @param from string_view のコンテナ
+ * @return 変換結果
+ */
+template <class Views>
+auto ToUTF32Batch(const Views& from) -> decltype(ToUTF32Batch(std::data(from), std::size(from)))
+{
+    return ToUTF32Batch(std::data(from), std::size(from));
+}
+
+/**
+ * @brief UTF16 を WTF8 文字列にする (末尾のハイサロゲートも変換する)
+ * @param from UTF16 文字列
+ * @return WTF8 文字列
+ */
+auto EncodeWTF8(std::u16string_view from) -> std::string;
+
+/**
+ * @brief WTF8 文字列を UTF16 にする (末尾の不完全なシーケンスは置き換える)
+ *
+ * 3ユニットのサロゲートの対 (CESU8 の表現) はローサロゲートを置き換える
+ *
+ * @param from WTF8 文字列
+ * @return UTF16 文字列
+ */
+auto DecodeWTF8(std::string_view from) -> std::u16string;
+
+/**
+ * @brief UTF16 を CESU8 文字列にする
+ * @param from UTF16 文字列
+ * @return CESU8 文字列
+ */
+auto EncodeCESU8(std::u16string_view from) -> std::string;
+
+/**
+ * @brief CESU8 文字列を UTF16 にする (末尾の不完全なシーケンスは置き換える)
+ * @param from CESU8 文字列
+ * @return UTF16 文字列
+ */
+auto DecodeCESU8(std::string_view from) -> std::u16string;
+
+/**
+ * @brief UTF16 を Java の Modified UTF8 文字列にする
+ * @param from UTF16 文字列
+ * @return Modified UTF8 文字列 (ヌル文字を含まない)
+ */
+auto EncodeModifiedUTF8(std::u16string_view from) -> std::string;
+
+/**
+ * @brief Java の Modified UTF8 文字列を UTF16 にする (末尾の不完全なシーケンスは置き換える)
+ * @param from Modified UTF8 文字列
+ * @return UTF16 文字列
+ */
+auto DecodeModifiedUTF8(std::string_view from) -> std::u16string;
+
 /*
  *
  */
@@ -0,0 +1,358 @@
+﻿/**
+ * @brief 変換とエスケープを1回の走査で行う JSON, HTML の書き出し
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/Escape.hpp"
+#include "Pits/Encoding.hpp"
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+namespace {
+
+using EncodingImplement::CountTrailingZeros;
+
+/// エスケープの種類
+enum class Kind {
+    JSON,
+    HTML,
+};
+
+constexpr char Hex[] = "0123456789abcdef";
+
+/// UTF8 の置換文字
+constexpr auto ReplacementUTF8 = std::string_view("\xef\xbf\xbd");
+
+/// ASCII のエスケープが要る文字か
+template <Kind K>
+constexpr auto IsSpecial(char32_t c) noexcept -> bool
+{
+    if constexpr (K == Kind::JSON) {
+        return c < 0x20 || c == '"' || c == '\\';
+    }
+    else {
+        return c == '&' || c == '<' || c == '>' || c == '"' || c == '\'';
+    }
+}
+
+/**
+ * @brief エスケープが要る文字か ASCII 以外の最初の位置を返す
+ * @param it 開始位置
+ * @param end 終了位置
+ * @return 位置 無ければ end
+ */
+template <Kind K, class Char>
+auto FindSpecial(const Char* it, const Char* end) noexcept -> const Char*
+{
+#ifdef PITS_ENCODING_SSE2
+    if constexpr (sizeof(Char) == 1) {
+        for (; end - it >= 16; it += 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            auto m = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+            if constexpr (K == Kind::JSON) {
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v));
+            }
+            else {
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('&')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('<')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('>')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\'')));
+            }
+            // 最上位ビットは ASCII 以外
+            if (auto mask = unsigned(_mm_movemask_epi8(m) | _mm_movemask_epi8(v))) {
+                return it + CountTrailingZeros(mask);
+            }
+        }
+    }
+    else if constexpr (sizeof(Char) == 2) {
+        auto zero = _mm_setzero_si128();
+        for (; end - it >= 8; it += 8) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            auto ascii = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(0xff80))), zero);
+            auto m = _mm_cmpeq_epi16(v, _mm_set1_epi16('"'));
+            if constexpr (K == Kind::JSON) {
+                m = _mm_or_si128(m, _mm_cmpeq_epi16(v, _mm_set1_epi16('\\')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(short(0xffe0))), zero));
+            }
+            else {
+                m = _mm_or_si128(m, _mm_cmpeq_epi16(v, _mm_set1_epi16('&')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi16(v, _mm_set1_epi16('<')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi16(v, _mm_set1_epi16('>')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi16(v, _mm_set1_epi16('\'')));
+            }
+            m = _mm_or_si128(m, _mm_andnot_si128(ascii, _mm_set1_epi8(-1)));
+            if (auto mask = unsigned(_mm_movemask_epi8(m))) {
+                return it + CountTrailingZeros(mask) / 2;
+            }
+        }
+    }
+#endif
+    for (; it != end; ++it) {
+        auto c = char32_t(static_cast<std::make_unsigned_t<Char>>(*it));
+        if (c >= 0x80 || IsSpecial<K>(c)) break;
+    }
+    return it;
+}
+
+/// ASCII の文字をエスケープして追加する
+template <Kind K>
+void AppendSpecial(char32_t c, std::string& out)
+{
+    if constexpr (K == Kind::JSON) {
+        switch (c) {
+        case '"':   out += "\\\""; return;
+        case '\\':  out += "\\\\"; return;
+        case '\b':  out += "\\b"; return;
+        case '\f':  out += "\\f"; return;
+        case '\n':  out += "\\n"; return;
+        case '\r':  out += "\\r"; return;
+        case '\t':  out += "\\t"; return;
+        default:
+            char units[] = {'\\', 'u', '0', '0', Hex[c >> 4], Hex[c & 15]};
+            out.append(units, sizeof(units));
+            return;
+        }
+    }
+    else {
+        switch (c) {
+        case '&':   out += "&amp;"; return;
+        case '<':   out += "&lt;"; return;
+        case '>':   out += "&gt;"; return;
+        case '"':   out += "&quot;"; return;
+        default:    out += "&#39;"; return;
+        }
+    }
+}
+
+/// \uXXXX を追加する
+inline void AppendUnit(char32_t u, std::string& out)
+{
+    char units[] = {'\\', 'u', Hex[(u >> 12) & 15], Hex[(u >> 8) & 15], Hex[(u >> 4) & 15], Hex[u & 15]};
+    out.append(units, sizeof(units));
+}
+
+/// ASCII 以外の文字を追加する
+template <Kind K>
+void AppendPoint(char32_t c, EscapeOutput output, std::string& out)
+{
+    if (output == EscapeOutput::UTF8) {
+        char units[4];
+        auto end = std::get<1>(Unicode::ConvertUTF32ToUTF8(&c, units));
+        out.append(units, std::size_t(end - units));
+    }
+    else if constexpr (K == Kind::JSON) {
+        if (c > 0xffff) {
+            AppendUnit(0xd800 + ((c - 0x10000) >> 10), out);
+            AppendUnit(0xdc00 + ((c - 0x10000) & 0x3ff), out);
+        }
+        else {
+            AppendUnit(c, out);
+        }
+    }
+    else {
+        char units[12] = {'&', '#', 'x'};
+        auto n = 3;
+        auto shift = 20;
+        while (shift && !(c >> shift)) shift -= 4;
+        for (; shift >= 0; shift -= 4) units[n++] = Hex[(c >> shift) & 15];
+        units[n++] = ';';
+        out.append(units, std::size_t(n));
+    }
+}
+
+/// UTF8 をエスケープして追加する 変わらない並びはまとめて複写する
+template <Kind K>
+void EscapeUTF8(std::string_view text, std::string& out, EscapeOutput output)
+{
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto copied = begin;
+    auto it = begin;
+    out.reserve(out.size() + text.size());
+    for (;;) {
+        it = FindSpecial<K>(it, end);
+        if (it == end) break;
+        auto c = char32_t(static_cast<unsigned char>(*it));
+        if (c < 0x80) {
+            out.append(copied, std::size_t(it - copied));
+            AppendSpecial<K>(c, out);
+            copied = ++it;
+            continue;
+        }
+        auto from = it;
+        c = NextPoint(it, end);
+        auto invalid = c == Unicode::ReplacementCharacter && std::string_view(from, std::size_t(it - from)) != ReplacementUTF8;
+        if (output == EscapeOutput::ASCII || invalid) {
+            out.append(copied, std::size_t(from - copied));
+            AppendPoint<K>(c, output, out);
+            copied = it;
+        }
+    }
+    out.append(copied, std::size_t(end - copied));
+}
+
+/// UTF16, UTF32 を UTF8 にしながらエスケープして追加する
+template <Kind K, class Char>
+void EscapeUnits(std::basic_string_view<Char> text, std::string& out, EscapeOutput output)
+{
+    auto it = text.data();
+    auto end = it + text.size();
+    out.reserve(out.size() + text.size());
+    while (it != end) {
+        // ASCII の並びは幅を詰めて複写する
+        auto run = FindSpecial<K>(it, end);
+        if (run != it) {
+            auto size = out.size();
+            out.resize(size + std::size_t(run - it));
+            EncodingImplement::NarrowASCII(it, std::size_t(run - it), &out[size]);
+            it = run;
+            if (it == end) break;
+        }
+        auto c = char32_t(*it);
+        if (c < 0x80) {
+            AppendSpecial<K>(c, out);
+            ++it;
+            continue;
+        }
+        AppendPoint<K>(NextPoint(it, end), output, out);
+    }
+}
+
+/// 16進の1桁を返す 16進でなければ 16 以上
+constexpr auto HexValue(char c) noexcept -> char32_t
+{
+    return ('0' <= c && c <= '9') ? char32_t(c - '0') :
+           ('a' <= c && c <= 'f') ? char32_t(c - 'a' + 10) :
+           ('A' <= c && c <= 'F') ? char32_t(c - 'A' + 10) : 16;
+}
+
+/// \uXXXX の XXXX を読む 不正なら char32_t(-1)
+inline auto ReadUnit(const char* it, const char* end) noexcept -> char32_t
+{
+    if (end - it < 4) return char32_t(-1);
+    auto u = char32_t {};
+    for (auto i = 0; i < 4; ++i) {
+        auto h = HexValue(it[i]);
+        if (h > 15) return char32_t(-1);
+        u = u * 16 + h;
+    }
+    return u;
+}
+
+/// \ の位置を返す 無ければ end
+inline auto FindBackslash(const char* it, const char* end) noexcept -> const char*
+{
+#ifdef PITS_ENCODING_SSE2
+    auto bs = _mm_set1_epi8('\\');
+    for (; end - it >= 16; it += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        if (auto mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, bs)))) {
+            return it + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    while (it != end && *it != '\\') ++it;
+    return it;
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+void EscapeJSON(std::string_view text, std::string& out, EscapeOutput output)
+{
+    EscapeUTF8<Kind::JSON>(text, out, output);
+}
+
+void EscapeJSON(std::u16string_view text, std::string& out, EscapeOutput output)
+{
+    EscapeUnits<Kind::JSON>(text, out, output);
+}
+
+void EscapeJSON(std::u32string_view text, std::string& out, EscapeOutput output)
+{
+    EscapeUnits<Kind::JSON>(text, out, output);
+}
+
+void EscapeHTML(std::string_view text, std::string& out, EscapeOutput output)
+{
+    EscapeUTF8<Kind::HTML>(text, out, output);
+}
+
+void EscapeHTML(std::u16string_view text, std::string& out, EscapeOutput output)
+{
+    EscapeUnits<Kind::HTML>(text, out, output);
+}
+
+void EscapeHTML(std::u32string_view text, std::string& out, EscapeOutput output)
+{
+    EscapeUnits<Kind::HTML>(text, out, output);
+}
+
+auto UnescapeJSON(std::string_view text, std::string& out) -> bool
+{
+    auto it = text.data();
+    auto end = it + text.size();
+    out.reserve(out.size() + text.size());
+    for (;;) {
+        auto found = FindBackslash(it, end);
+        out.append(it, std::size_t(found - it));
+        if (found == end) return true;
+        it = found + 1;
+        if (it == end) return false;
+
+        auto c = char32_t {};
+        switch (*it++) {
+        case '"':   out += '"'; continue;
+        case '\\':  out += '\\'; continue;
+        case '/':   out += '/'; continue;
+        case 'b':   out += '\b'; continue;
+        case 'f':   out += '\f'; continue;
+        case 'n':   out += '\n'; continue;
+        case 'r':   out += '\r'; continue;
+        case 't':   out += '\t'; continue;
+        case 'u':
+            c = ReadUnit(it, end);
+            if (c == char32_t(-1)) return false;
+            it += 4;
+            break;
+        default:
+            return false;
+        }
+
+        // サロゲートペアを組み立てる
+        if (Unicode::IsHighSurrogate(c) && end - it >= 6 && it[0] == '\\' && it[1] == 'u') {
+            auto low = ReadUnit(it + 2, end);
+            if (low != char32_t(-1) && Unicode::IsLowSurrogate(low)) {
+                c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                it += 6;
+            }
+        }
+        if (!Unicode::IsSafeCharacter(c)) c = Unicode::ReplacementCharacter;
+        char units[4];
+        auto last = std::get<1>(Unicode::ConvertUTF32ToUTF8(&c, units));
+        out.append(units, std::size_t(last - units));
+    }
+}
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
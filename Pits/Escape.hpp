@@ -0,0 +1,136 @@
+﻿/**
+ * @brief 変換とエスケープを1回の走査で行う JSON, HTML の書き出し
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_ESCAPE_HPP_
+#define PITS_ESCAPE_HPP_
+
+#include <string>
+#include <string_view>
+#include <utility>      // declval
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ * エスケープ
+ *
+ * UTF8, UTF16, UTF32 の文字列を UTF8 への変換とエスケープを同時に行って out に追加する
+ * エスケープの要らない ASCII の並びは SSE2 が使える場合 16 バイト毎に探してまとめて複写し、
+ * UTF8 の入力では正しい ASCII 以外の文字も並びに含めて複写する
+ * 不正なシーケンスは置き換える
+ *
+ * JSON ... " \ と制御文字 (U+0000 ～ U+001F) をエスケープする (\b \f \n \r \t 以外は \u00XX)
+ *          EscapeOutput::ASCII では ASCII 以外も \uXXXX にし、U+10000 以上はサロゲートペアにする
+ * HTML ... & < > " ' を文字参照にする
+ *          EscapeOutput::ASCII では ASCII 以外も &#xXXXX; にする
+ *
+ * 引用符は追加しないので、呼び出し側で囲む
+ */
+
+/// エスケープの出力
+enum class EscapeOutput {
+    UTF8,       // ASCII 以外は UTF8 のまま出力する
+    ASCII,      // ASCII 以外もエスケープして ASCII だけにする
+};
+
+/**
+ * @brief JSON の文字列の中身としてエスケープして追加する
+ * @param text UTF8 文字列
+ * @param out 追加先
+ * @param output ASCII 以外の扱い
+ */
+void EscapeJSON(std::string_view text, std::string& out, EscapeOutput output = EscapeOutput::UTF8);
+
+/**
+ * @brief JSON の文字列の中身として UTF8 にしながらエスケープして追加する
+ * @param text UTF16 文字列 対になっていないサロゲートは置き換える
+ * @param out 追加先
+ * @param output ASCII 以外の扱い
+ */
+void EscapeJSON(std::u16string_view text, std::string& out, EscapeOutput output = EscapeOutput::UTF8);
+
+/**
+ * @brief JSON の文字列の中身として UTF8 にしながらエスケープして追加する
+ * @param text UTF32 文字列
+ * @param out 追加先
+ * @param output ASCII 以外の扱い
+ */
+void EscapeJSON(std::u32string_view text, std::string& out, EscapeOutput output = EscapeOutput::UTF8);
+
+/**
+ * @brief HTML のテキストと属性値としてエスケープして追加する
+ * @param text UTF8 文字列
+ * @param out 追加先
+ * @param output ASCII 以外の扱い
+ */
+void EscapeHTML(std::string_view text, std::string& out, EscapeOutput output = EscapeOutput::UTF8);
+
+/**
+ * @brief HTML のテキストと属性値として UTF8 にしながらエスケープして追加する
+ * @param text UTF16 文字列 対になっていないサロゲートは置き換える
+ * @param out 追加先
+ * @param output ASCII 以外の扱い
+ */
+void EscapeHTML(std::u16string_view text, std::string& out, EscapeOutput output = EscapeOutput::UTF8);
+
+/**
+ * @brief HTML のテキストと属性値として UTF8 にしながらエスケープして追加する
+ * @param text UTF32 文字列
+ * @param out 追加先
+ * @param output ASCII 以外の扱い
+ */
+void EscapeHTML(std::u32string_view text, std::string& out, EscapeOutput output = EscapeOutput::UTF8);
+
+/// JSON の文字列の中身としてエスケープした UTF8 文字列を返す
+template <class Text>
+inline auto EscapeJSON(const Text& text, EscapeOutput output = EscapeOutput::UTF8)
+    -> decltype(EscapeJSON(text, std::declval<std::string&>(), output), std::string())
+{
+    auto out = std::string {};
+    EscapeJSON(text, out, output);
+    return out;
+}
+
+/// HTML のテキストと属性値としてエスケープした UTF8 文字列を返す
+template <class Text>
+inline auto EscapeHTML(const Text& text, EscapeOutput output = EscapeOutput::UTF8)
+    -> decltype(EscapeHTML(text, std::declval<std::string&>(), output), std::string())
+{
+    auto out = std::string {};
+    EscapeHTML(text, out, output);
+    return out;
+}
+
+/**
+ * @brief JSON の文字列の中身のエスケープを戻して UTF8 で追加する
+ *
+ * \uXXXX のサロゲートペアは1文字にし、対になっていないサロゲートは置き換える
+ * エスケープ以外はそのまま複写する
+ *
+ * @param text 引用符を除いた JSON の文字列の中身
+ * @param out 追加先
+ * @return 正しいエスケープだけであったか 偽なら out は誤りの手前まで追加した状態
+ */
+auto UnescapeJSON(std::string_view text, std::string& out) -> bool;
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
@@ -0,0 +1,335 @@
+﻿/**
+ * @brief 書記素クラスタの分割 (UAX #29)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/Grapheme.hpp"
+#include "Pits/Encoding.hpp"
+#include "Pits/UnicodeTable.hpp"
+#include <cstdint>      // uint8_t
+#include <type_traits>  // make_unsigned_t
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ *
+ */
+
+namespace {
+
+using namespace UnicodeTable;
+
+/// Grapheme_Cluster_Break を返す
+constexpr auto Break(std::uint8_t value) noexcept -> std::uint8_t
+{
+    return value & GraphemeBreakMask;
+}
+
+/// 境界で必ず分割する値か (GB4, GB5)
+constexpr auto IsControl(std::uint8_t gcb) noexcept -> bool
+{
+    return gcb == GraphemeCR || gcb == GraphemeLF || gcb == GraphemeControl;
+}
+
+/// Extended_Pictographic Extend* の後の状態
+enum Emoji {
+    EmojiNone,
+    EmojiExtend,    // ExtPict Extend* の直後
+    EmojiZWJ,       // ExtPict Extend* ZWJ の直後
+};
+
+/**
+ * @brief 2文字の間が境界か返す
+ * @param prev 前の文字の Grapheme
+ * @param next 後の文字の Grapheme
+ * @param ri prev で終わる連続した Regional_Indicator の数
+ * @param emoji prev までの Emoji の状態
+ */
+constexpr auto IsBreak(std::uint8_t prev, std::uint8_t next, std::size_t ri, Emoji emoji) noexcept -> bool
+{
+    auto p = Break(prev);
+    auto n = Break(next);
+    if (p == GraphemeCR && n == GraphemeLF) return false;                       // GB3
+    if (IsControl(p) || IsControl(n)) return true;                              // GB4, GB5
+    if (p == GraphemeL) {                                                       // GB6
+        if (n == GraphemeL || n == GraphemeV || n == GraphemeLV || n == GraphemeLVT) return false;
+    }
+    if ((p == GraphemeLV || p == GraphemeV) && (n == GraphemeV || n == GraphemeT)) return false;    // GB7
+    if ((p == GraphemeLVT || p == GraphemeT) && n == GraphemeT) return false;   // GB8
+    if (n == GraphemeExtend || n == GraphemeZWJ) return false;                  // GB9
+    if (n == GraphemeSpacingMark) return false;                                 // GB9a
+    if (p == GraphemePrepend) return false;                                     // GB9b
+    if (emoji == EmojiZWJ && (next & GraphemeExtendedPictographic)) return false;    // GB11
+    if (p == GraphemeRegionalIndicator && n == GraphemeRegionalIndicator && ri % 2) return false;  // GB12, GB13
+    return true;                                                                // GB999
+}
+
+/// 先頭から順に境界を判定する
+class Segmenter {
+public:
+    /**
+     * @brief 次の文字を与える
+     * @param next 次の文字の Grapheme
+     * @return 直前が境界か (最初の文字の前は境界)
+     */
+    auto Feed(std::uint8_t next) noexcept -> bool
+    {
+        auto result = first_ || IsBreak(prev_, next, ri_, emoji_);
+        auto n = Break(next);
+        ri_ = (n == GraphemeRegionalIndicator) ? ri_ + 1 : 0;
+        if (next & GraphemeExtendedPictographic) {
+            emoji_ = EmojiExtend;
+        } else if (emoji_ == EmojiExtend && n == GraphemeExtend) {
+            emoji_ = EmojiExtend;
+        } else if (emoji_ == EmojiExtend && n == GraphemeZWJ) {
+            emoji_ = EmojiZWJ;
+        } else {
+            emoji_ = EmojiNone;
+        }
+        prev_ = next;
+        first_ = false;
+        return result;
+    }
+
+private:
+    std::uint8_t prev_ = 0;
+    std::size_t ri_ = 0;
+    Emoji emoji_ = EmojiNone;
+    bool first_ = true;
+};
+
+/// 境界判定を省略できる ASCII か (CR 以外)
+template <class Char>
+constexpr auto IsSimpleASCII(Char c) noexcept -> bool
+{
+    return char32_t(std::make_unsigned_t<Char>(c)) <= 0x7f && c != Char('\r');
+}
+
+/**
+ * @brief 境界判定を省略できる CJK か
+ *
+ * ひらがな (U+3041 ～ U+3096), カタカナ (U+30A1 ～ U+30FF), CJK 統合漢字と拡張 A は全て Other で、
+ * 後に Extend, ZWJ, SpacingMark が続かなければ前後が境界になる
+ * (結合する濁点 U+3099, U+309A は範囲に含まない)
+ */
+constexpr auto IsSimpleCJK(char32_t c) noexcept -> bool
+{
+    return (0x4e00 <= c && c <= 0x9fff) || (0x3400 <= c && c <= 0x4dbf) ||
+           (0x3041 <= c && c <= 0x3096) || (0x30a1 <= c && c <= 0x30ff);
+}
+
+/// 後に結合しない文字が続けば境界になる文字か (CR 以外の ASCII と CJK)
+constexpr auto IsSimplePoint(char32_t c) noexcept -> bool
+{
+    return (c <= 0x7f && c != U'\r') || IsSimpleCJK(c);
+}
+
+/// 前の文字に結合する値か (GB9, GB9a)
+constexpr auto IsExtending(std::uint8_t gcb) noexcept -> bool
+{
+    return gcb == GraphemeExtend || gcb == GraphemeZWJ || gcb == GraphemeSpacingMark;
+}
+
+/**
+ * @brief 1文字前に戻る NextPoint で同じ文字を読む位置を返す
+ * @param begin 先頭
+ * @param it 位置 begin 以外である事
+ * @param end 末尾
+ */
+template <class Char>
+inline auto PreviousPoint(const Char* begin, const Char* it, const Char* end) noexcept -> const Char*
+{
+    Pits::PreviousPoint(begin, it, end);
+    return it;
+}
+
+/// 位置の文字の Grapheme を返す
+template <class Char>
+inline auto PointAt(const Char* it, const Char* end) noexcept -> std::uint8_t
+{
+    return GetGrapheme(NextPoint(it, end));
+}
+
+template <class Char>
+auto NextBoundary(std::basic_string_view<Char> text, std::size_t pos) noexcept -> std::size_t
+{
+    if (pos >= text.size()) return text.size();
+    if (pos + 1 < text.size() && IsSimpleASCII(text[pos]) && IsSimpleASCII(text[pos + 1])) {
+        return pos + 1;
+    }
+
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto it = begin + pos;
+    auto first = NextPoint(it, end);
+
+    // ASCII と CJK の後は次の文字が結合しなければ境界なので状態機械を使わない
+    if (it != end && IsSimplePoint(first)) {
+        auto next = it;
+        auto c = NextPoint(next, end);
+        if (IsSimplePoint(c) || !IsExtending(Break(GetGrapheme(c)))) return std::size_t(it - begin);
+    }
+
+    auto segmenter = Segmenter();
+    segmenter.Feed(GetGrapheme(first));
+    while (it != end) {
+        auto next = it;
+        if (segmenter.Feed(GetGrapheme(NextPoint(next, end)))) break;
+        it = next;
+    }
+    return std::size_t(it - begin);
+}
+
+template <class Char>
+auto IsBoundary(std::basic_string_view<Char> text, std::size_t pos) noexcept -> bool
+{
+    if (pos == 0 || pos >= text.size()) return pos <= text.size();
+
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto it = begin + pos;
+    auto prev = PreviousPoint(begin, it, end);
+    auto check = prev;
+    NextPoint(check, end);
+    if (check != it) return false;  // 文字の途中
+
+    auto p = PointAt(prev, end);
+    auto n = PointAt(it, end);
+
+    // GB12, GB13 の為に前に続く Regional_Indicator を数える
+    auto ri = std::size_t {};
+    if (Break(p) == GraphemeRegionalIndicator && Break(n) == GraphemeRegionalIndicator) {
+        for (auto back = it; back != begin;) {
+            back = PreviousPoint(begin, back, end);
+            if (Break(PointAt(back, end)) != GraphemeRegionalIndicator) break;
+            ++ri;
+        }
+    }
+
+    // GB11 の為に ZWJ の前の Extend* と Extended_Pictographic を探す
+    auto emoji = EmojiNone;
+    if (Break(p) == GraphemeZWJ && (n & GraphemeExtendedPictographic)) {
+        for (auto back = prev; back != begin;) {
+            back = PreviousPoint(begin, back, end);
+            auto value = PointAt(back, end);
+            if (value & GraphemeExtendedPictographic) {
+                emoji = EmojiZWJ;
+                break;
+            }
+            if (Break(value) != GraphemeExtend) break;
+        }
+    }
+    return IsBreak(p, n, ri, emoji);
+}
+
+template <class Char>
+auto PreviousBoundary(std::basic_string_view<Char> text, std::size_t pos) noexcept -> std::size_t
+{
+    if (pos == 0) return 0;
+    if (pos > text.size()) return text.size();
+
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto it = begin + pos;
+    do {
+        it = PreviousPoint(begin, it, end);
+    } while (it != begin && !IsBoundary(text, std::size_t(it - begin)));
+    return std::size_t(it - begin);
+}
+
+template <class Char>
+auto Count(std::basic_string_view<Char> text) noexcept -> std::size_t
+{
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto count = std::size_t {};
+    auto segmenter = Segmenter();
+    for (auto it = begin; it != end;) {
+        if (char32_t(std::make_unsigned_t<Char>(*it)) <= 0x7f) {
+            // ASCII が続く範囲は CR LF 以外の全ての間が境界
+            auto run = EncodingImplement::SkipASCII(it, end);
+            count += segmenter.Feed(GetGrapheme(char32_t(*it)));
+            for (auto c = it + 1; c != run; ++c) {
+                count += !(c[-1] == Char('\r') && *c == Char('\n'));
+            }
+            if (run - it > 1) {
+                segmenter = Segmenter();
+                segmenter.Feed(GetGrapheme(char32_t(run[-1])));
+            }
+            it = run;
+            continue;
+        }
+        auto c = NextPoint(it, end);
+        count += segmenter.Feed(GetGrapheme(c));
+        if (IsSimpleCJK(c)) {
+            // CJK が続く範囲は全ての間が境界で、どれも Other なので状態も変わらない
+            for (auto next = it; next != end && IsSimpleCJK(NextPoint(next, end)); it = next) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto NextGraphemeBoundary(std::string_view text, std::size_t pos) noexcept -> std::size_t
+{
+    return NextBoundary(text, pos);
+}
+
+auto NextGraphemeBoundary(std::u16string_view text, std::size_t pos) noexcept -> std::size_t
+{
+    return NextBoundary(text, pos);
+}
+
+auto PreviousGraphemeBoundary(std::string_view text, std::size_t pos) noexcept -> std::size_t
+{
+    return PreviousBoundary(text, pos);
+}
+
+auto PreviousGraphemeBoundary(std::u16string_view text, std::size_t pos) noexcept -> std::size_t
+{
+    return PreviousBoundary(text, pos);
+}
+
+auto IsGraphemeBoundary(std::string_view text, std::size_t pos) noexcept -> bool
+{
+    return IsBoundary(text, pos);
+}
+
+auto IsGraphemeBoundary(std::u16string_view text, std::size_t pos) noexcept -> bool
+{
+    return IsBoundary(text, pos);
+}
+
+auto CountGraphemes(std::string_view text) noexcept -> std::size_t
+{
+    return Count(text);
+}
+
+auto CountGraphemes(std::u16string_view text) noexcept -> std::size_t
+{
+    return Count(text);
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
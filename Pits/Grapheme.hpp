@@ -0,0 +1,211 @@
+﻿/**
+ * @brief 書記素クラスタの分割 (UAX #29)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_GRAPHEME_HPP_
+#define PITS_GRAPHEME_HPP_
+
+#include <cstddef>      // size_t ptrdiff_t
+#include <iterator>     // forward_iterator_tag
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ * 書記素クラスタ
+ *
+ * テーブルはビルド時に ucd/GraphemeBreakProperty.txt, ucd/emoji-data.txt から生成する
+ * 拡張書記素クラスタ (GB1 ～ GB13, GB999) の規則に従う
+ * 位置はコードユニット単位で、不正なシーケンスは置換文字として扱う
+ *
+ * 参考
+ * - UAX #29    ... https://www.unicode.org/reports/tr29/
+ */
+
+/**
+ * @brief 次の境界を返す
+ *
+ * ASCII が続く場合はテーブルを引かずに 1 ユニット進める
+ *
+ * @param text UTF8 文字列
+ * @param pos 境界の位置
+ * @return pos より後の最初の境界 pos が末尾なら末尾
+ */
+auto NextGraphemeBoundary(std::string_view text, std::size_t pos) noexcept -> std::size_t;
+
+/**
+ * @brief 次の境界を返す
+ * @param text UTF16 文字列
+ * @param pos 境界の位置
+ * @return pos より後の最初の境界 pos が末尾なら末尾
+ */
+auto NextGraphemeBoundary(std::u16string_view text, std::size_t pos) noexcept -> std::size_t;
+
+/**
+ * @brief 前の境界を返す
+ * @param text UTF8 文字列
+ * @param pos 位置
+ * @return pos より前の最後の境界 pos が 0 なら 0
+ */
+auto PreviousGraphemeBoundary(std::string_view text, std::size_t pos) noexcept -> std::size_t;
+
+/**
+ * @brief 前の境界を返す
+ * @param text UTF16 文字列
+ * @param pos 位置
+ * @return pos より前の最後の境界 pos が 0 なら 0
+ */
+auto PreviousGraphemeBoundary(std::u16string_view text, std::size_t pos) noexcept -> std::size_t;
+
+/**
+ * @brief 境界か返す
+ * @param text UTF8 文字列
+ * @param pos 位置
+ * @return 先頭と末尾は境界 文字の途中は境界ではない
+ */
+auto IsGraphemeBoundary(std::string_view text, std::size_t pos) noexcept -> bool;
+
+/**
+ * @brief 境界か返す
+ * @param text UTF16 文字列
+ * @param pos 位置
+ * @return 先頭と末尾は境界 文字の途中は境界ではない
+ */
+auto IsGraphemeBoundary(std::u16string_view text, std::size_t pos) noexcept -> bool;
+
+/**
+ * @brief 書記素クラスタ数を返す
+ *
+ * ASCII が続く範囲は CR LF だけを判定して数える
+ *
+ * @param text UTF8 文字列
+ * @return 書記素クラスタ数
+ */
+auto CountGraphemes(std::string_view text) noexcept -> std::size_t;
+
+/**
+ * @brief 書記素クラスタ数を返す
+ * @param text UTF16 文字列
+ * @return 書記素クラスタ数
+ */
+auto CountGraphemes(std::u16string_view text) noexcept -> std::size_t;
+
+/*
+ *
+ */
+
+/**
+ * @brief 書記素クラスタを順に返すイテレータ
+ * @tparam Char char または char16_t
+ */
+template <class Char>
+class GraphemeIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::basic_string_view<Char>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    /// 終端
+    GraphemeIterator() noexcept = default;
+
+    /**
+     * @brief 位置を指定して作る
+     * @param text 文字列
+     * @param pos 境界の位置
+     */
+    GraphemeIterator(value_type text, std::size_t pos) noexcept
+        : text_(text), pos_(pos), next_(NextGraphemeBoundary(text, pos)) {}
+
+    /// 現在の書記素クラスタ
+    auto operator*() const noexcept -> value_type { return text_.substr(pos_, next_ - pos_); }
+
+    /// 現在の位置 (コードユニット単位)
+    auto position() const noexcept -> std::size_t { return pos_; }
+
+    auto operator++() noexcept -> GraphemeIterator&
+    {
+        pos_ = next_;
+        next_ = NextGraphemeBoundary(text_, pos_);
+        return *this;
+    }
+
+    auto operator++(int) noexcept -> GraphemeIterator
+    {
+        auto old = *this;
+        ++*this;
+        return old;
+    }
+
+    /// 同じ文字列の同じ位置か 終端とは末尾の位置が等しい
+    friend auto operator==(const GraphemeIterator& l, const GraphemeIterator& r) noexcept -> bool
+    {
+        return l.Remain() == r.Remain();
+    }
+
+    friend auto operator!=(const GraphemeIterator& l, const GraphemeIterator& r) noexcept -> bool
+    {
+        return !(l == r);
+    }
+
+private:
+    /// 残りのユニット数
+    auto Remain() const noexcept -> std::size_t { return text_.size() - pos_; }
+
+    value_type text_;
+    std::size_t pos_ = 0;
+    std::size_t next_ = 0;
+};
+
+/**
+ * @brief 書記素クラスタの範囲 (range-based for 用)
+ * @tparam Char char または char16_t
+ */
+template <class Char>
+class GraphemeRange {
+public:
+    explicit GraphemeRange(std::basic_string_view<Char> text) noexcept : text_(text) {}
+
+    auto begin() const noexcept -> GraphemeIterator<Char> { return GraphemeIterator<Char>(text_, 0); }
+    auto end() const noexcept -> GraphemeIterator<Char> { return GraphemeIterator<Char>(); }
+
+private:
+    std::basic_string_view<Char> text_;
+};
+
+/// UTF8 文字列の書記素クラスタの範囲を返す
+inline auto Graphemes(std::string_view text) noexcept -> GraphemeRange<char>
+{
+    return GraphemeRange<char>(text);
+}
+
+/// UTF16 文字列の書記素クラスタの範囲を返す
+inline auto Graphemes(std::u16string_view text) noexcept -> GraphemeRange<char16_t>
+{
+    return GraphemeRange<char16_t>(text);
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
@@ -0,0 +1,219 @@
+﻿/**
+ * @brief 日本語の検索用の畳み込み (全角半角, ひらがなカタカナ, 濁点の結合)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/JapaneseFold.hpp"
+#include "Pits/Encoding.hpp"
+#include "Pits/UnicodeTable.hpp"
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ *
+ */
+
+namespace {
+
+using namespace UnicodeTable;
+
+/// 仮名の範囲
+constexpr auto KanaLast = char32_t(0x30ff);
+
+/// 半角カナの範囲
+constexpr auto HalfwidthKanaLast = char32_t(0xff9f);
+
+/// 全角英数記号の範囲
+constexpr auto FullwidthFirst = char32_t(0xff01);
+constexpr auto FullwidthLast = char32_t(0xff5e);
+
+/// 全角空白
+constexpr auto IdeographicSpace = char32_t(0x3000);
+
+/// ひらがなとカタカナの差
+constexpr auto KanaOffset = char32_t(0x60);
+
+/// 濁点と半濁点
+enum Mark {
+    MarkNone,
+    MarkVoiced,
+    MarkSemiVoiced,
+};
+
+/// 変換の対象になり得る文字か (U+3000 ～ U+30FF, U+FF01 ～ U+FF9F)
+constexpr auto IsTarget(char32_t c) noexcept -> bool
+{
+    return (IdeographicSpace <= c && c <= KanaLast) || (FullwidthFirst <= c && c <= HalfwidthKanaLast);
+}
+
+/// 濁点か半濁点か返す
+constexpr auto GetMark(char32_t c, unsigned folds) noexcept -> Mark
+{
+    switch (c) {
+    case 0x3099:
+    case 0x309b:
+        return (folds & FoldVoicedMarks) ? MarkVoiced : MarkNone;
+    case 0x309a:
+    case 0x309c:
+        return (folds & FoldVoicedMarks) ? MarkSemiVoiced : MarkNone;
+    case 0xff9e:
+        return (folds & FoldHalfwidthKatakana) ? MarkVoiced : MarkNone;
+    case 0xff9f:
+        return (folds & FoldHalfwidthKatakana) ? MarkSemiVoiced : MarkNone;
+    default:
+        return MarkNone;
+    }
+}
+
+/// 濁点か半濁点を合成した文字を返す 無ければ 0
+constexpr auto Compose(char32_t c, Mark mark) noexcept -> char32_t
+{
+    if (c < KanaFirst || KanaLast < c || mark == MarkNone) return 0;
+    auto delta = (mark == MarkVoiced ? KanaVoiced : KanaSemiVoiced)[c - KanaFirst];
+    return delta ? c + delta : 0;
+}
+
+/// 全角半角を変換する
+constexpr auto Widen(char32_t c, unsigned folds) noexcept -> char32_t
+{
+    if ((folds & FoldHalfwidthKatakana) && HalfwidthKanaFirst <= c && c <= HalfwidthKanaLast) {
+        return HalfwidthKana[c - HalfwidthKanaFirst];
+    }
+    if (folds & FoldFullwidthASCII) {
+        if (FullwidthFirst <= c && c <= FullwidthLast) return c - 0xfee0;
+        if (c == IdeographicSpace) return U' ';
+    }
+    return c;
+}
+
+/// ひらがなとカタカナを揃える (ぁ ～ ゖ, ゝ ゞ と ァ ～ ヶ, ヽ ヾ)
+constexpr auto FoldKana(char32_t c, unsigned folds) noexcept -> char32_t
+{
+    auto hiragana = (0x3041 <= c && c <= 0x3096) || c == 0x309d || c == 0x309e;
+    auto katakana = (0x30a1 <= c && c <= 0x30f6) || c == 0x30fd || c == 0x30fe;
+    if ((folds & FoldToKatakana) && hiragana) return c + KanaOffset;
+    if ((folds & FoldToHiragana) && !(folds & FoldToKatakana) && katakana) return c - KanaOffset;
+    return c;
+}
+
+/// UTF8 で追加する
+inline void Append(char32_t c, std::string& out)
+{
+    char units[4];
+    auto end = std::get<1>(ConvertUTF32ToUTF8(&c, units));
+    out.append(units, std::size_t(end - units));
+}
+
+/// UTF8 のバイト数を返す
+constexpr auto UTF8Size(char32_t c) noexcept -> std::size_t
+{
+    return c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+}
+
+/**
+ * @brief 畳み込みで変わる文字を順に通知する
+ * @param text UTF8 文字列
+ * @param folds JapaneseFolds の組み合わせ
+ * @param emit emit(from, to, c) [from, to) を文字 c に置き換える
+ */
+template <class Emit>
+void Fold(std::string_view text, unsigned folds, Emit&& emit)
+{
+    auto end = text.data() + text.size();
+    auto it = text.data();
+    while (it != end) {
+        // ASCII は変わらないので読み飛ばす
+        it = EncodingImplement::SkipASCII(it, end);
+        if (it == end) break;
+
+        auto from = it;
+        auto c = NextPoint(it, end);
+        if (!IsTarget(c)) {
+            // 置き換えた不正なシーケンスも変更として扱う
+            if (c == ReplacementCharacter && std::string_view(from, std::size_t(it - from)) != "\xef\xbf\xbd") {
+                emit(from, it, c);
+            }
+            continue;
+        }
+
+        auto folded = Widen(c, folds);
+        auto merged = false;
+        if (it != end) {
+            auto next = it;
+            auto mark = GetMark(NextPoint(next, end), folds);
+            // 半角の濁点は FoldVoicedMarks が無くても半角カナの後なら合成する
+            auto half = HalfwidthKanaFirst <= c && c <= HalfwidthKanaLast;
+            if (mark != MarkNone && (half || (folds & FoldVoicedMarks))) {
+                if (auto composed = Compose(folded, mark)) {
+                    folded = composed;
+                    it = next;
+                    merged = true;
+                }
+            }
+        }
+        folded = FoldKana(folded, folds);
+        if (folded != c || merged) {
+            emit(from, it, folded);
+        }
+    }
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto FoldJapanese(std::string_view text, unsigned folds, std::string& buffer) -> std::string_view
+{
+    // 1回目は変わる文字だけで結果の長さを求める
+    auto size = text.size();
+    auto first = static_cast<const char*>(nullptr);     // 最初に変わる位置
+    Fold(text, folds, [&](const char* from, const char* to, char32_t c) {
+        size = size - std::size_t(to - from) + UTF8Size(c);
+        if (!first) first = from;
+    });
+    if (!first) {
+        return text;
+    }
+
+    // 2回目は確保した長さに、変わる文字の前までをまとめて複写し、変わった文字を追加する
+    // 最初に変わる位置より前は変わらないので走査しない
+    auto copied = text.data();      // buffer に複写済みの位置
+    buffer.clear();
+    buffer.reserve(size);
+    Fold(text.substr(std::size_t(first - text.data())), folds, [&](const char* from, const char* to, char32_t c) {
+        buffer.append(copied, std::size_t(from - copied));
+        Append(c, buffer);
+        copied = to;
+    });
+    buffer.append(copied, std::size_t(text.data() + text.size() - copied));
+    return buffer;
+}
+
+auto FoldJapanese(std::string_view text, unsigned folds) -> std::string
+{
+    auto buffer = std::string {};
+    auto result = FoldJapanese(text, folds, buffer);
+    if (result.data() != buffer.data()) {
+        return std::string(result);
+    }
+    return buffer;
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
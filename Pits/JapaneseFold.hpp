@@ -0,0 +1,84 @@
+﻿/**
+ * @brief 日本語の検索用の畳み込み (全角半角, ひらがなカタカナ, 濁点の結合)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_JAPANESEFOLD_HPP_
+#define PITS_JAPANESEFOLD_HPP_
+
+#include <string>
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ * 日本語の畳み込み
+ *
+ * 検索の索引等の為に、複数の変換を1回の走査でまとめて行う
+ * 変換は U+3000 ～ U+30FF と U+FF01 ～ U+FF9F の範囲だけで、他の文字はそのまま出力する
+ * 変わる場合は変わる文字だけで結果の長さを求めてから出力を丁度の長さで1度だけ確保する
+ * (不正なシーケンスを置換文字にして長くなる場合も含む)
+ *
+ * - 半角カナ (U+FF61 ～ U+FF9F) は全角にし、続く半角の濁点と半濁点 (ｶﾞ, ﾊﾟ) は合成済みの文字にする
+ *   結合できない半角の濁点と半濁点は全角の ゛ ゜ (U+309B, U+309C) にする
+ * - 全角英数記号 (U+FF01 ～ U+FF5E) と全角空白 (U+3000) は ASCII にする
+ * - 仮名の後の濁点と半濁点 (結合文字 U+3099, U+309A と単独の U+309B, U+309C) は合成済みの文字にする
+ * - ひらがなとカタカナは片方に揃える (対応の無い ヷ ヸ ヹ ヺ ヿ ゟ 等はそのまま)
+ *
+ * 不正なシーケンスは置き換える
+ */
+
+/// 畳み込みの種類 (組み合わせて指定する)
+enum JapaneseFolds : unsigned {
+    FoldHalfwidthKatakana   = 0x01, // 半角カナを全角にする
+    FoldFullwidthASCII      = 0x02, // 全角英数記号と全角空白を ASCII にする
+    FoldVoicedMarks         = 0x04, // 仮名と濁点, 半濁点を合成する
+    FoldToKatakana          = 0x08, // ひらがなをカタカナにする
+    FoldToHiragana          = 0x10, // カタカナをひらがなにする (FoldToKatakana が優先)
+
+    /// 検索の索引用の既定
+    FoldJapaneseDefault = FoldHalfwidthKatakana | FoldFullwidthASCII | FoldVoicedMarks | FoldToKatakana,
+};
+
+/**
+ * @brief 畳み込む 変わらない場合は入力をそのまま返す
+ *
+ * 変わらない部分はまとめて buffer に追加する
+ *
+ * @param text UTF8 文字列
+ * @param folds JapaneseFolds の組み合わせ
+ * @param buffer 変わる場合に結果を格納する
+ * @return text または buffer を参照する結果
+ */
+auto FoldJapanese(std::string_view text, unsigned folds, std::string& buffer) -> std::string_view;
+
+/**
+ * @brief 畳み込んだ文字列を返す
+ * @param text UTF8 文字列
+ * @param folds JapaneseFolds の組み合わせ
+ * @return 畳み込んだ UTF8 文字列
+ */
+auto FoldJapanese(std::string_view text, unsigned folds = FoldJapaneseDefault) -> std::string;
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
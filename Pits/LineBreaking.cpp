@@ -0,0 +1,301 @@
+﻿/**
+ * @brief 行分割 (UAX #14) と日本語の禁則処理
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/LineBreaking.hpp"
+#include "Pits/Encoding.hpp"
+#include "Pits/UnicodeProperty.hpp"
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ *
+ */
+
+namespace {
+
+using LB = LineBreak;
+
+/// 2文字の間の扱い
+enum Action {
+    ActionProhibited,   // 改行しない
+    ActionAllowed,      // 改行できる
+    ActionMandatory,    // 必ず改行する
+};
+
+/// いずれかの改行クラスか
+template <class... Classes>
+constexpr auto IsAny(LB cls, Classes... classes) noexcept -> bool
+{
+    return ((cls == classes) || ...);
+}
+
+/// East_Asian_Width が F, W, H か (LB30)
+constexpr auto IsEastAsian(char32_t c) noexcept -> bool
+{
+    if ((UnicodeTable::GetWidth(c) & UnicodeTable::WidthMask) == UnicodeTable::WidthWide) return true;
+    return (0xff61 <= c && c <= 0xffdc) || (0xffe8 <= c && c <= 0xffee);
+}
+
+/// 未割り当ての Extended_Pictographic か (LB30b)
+constexpr auto IsUnassignedPictographic(char32_t c) noexcept -> bool
+{
+    return (UnicodeTable::GetGrapheme(c) & UnicodeTable::GraphemeExtendedPictographic)
+        && GetGeneralCategory(c) == GeneralCategory::Cn;
+}
+
+/// 改行クラスを解決する (LB1)
+constexpr auto Resolve(char32_t c, LB cls, LineBreakRule rule) noexcept -> LB
+{
+    switch (cls) {
+    case LB::AI:
+    case LB::SG:
+    case LB::XX:
+        return LB::AL;
+    case LB::SA: {
+        auto gc = GetGeneralCategory(c);
+        return (gc == GeneralCategory::Mn || gc == GeneralCategory::Mc) ? LB::CM : LB::AL;
+    }
+    case LB::CJ:
+        return rule == LineBreakRule::Loose ? LB::ID : LB::NS;
+    default:
+        return cls;
+    }
+}
+
+/// 先頭から順に改行できる位置を判定する
+template <class Char>
+class Breaker {
+public:
+    explicit Breaker(LineBreakRule rule) noexcept : rule_(rule) {}
+
+    /**
+     * @brief 次の文字を与える
+     * @param c 次の文字
+     * @param rest c の後の位置 (先読み用)
+     * @param end 終了位置
+     * @return 直前の扱い (最初の文字の前は改行しない)
+     */
+    auto Feed(char32_t c, const Char* rest, const Char* end) noexcept -> Action
+    {
+        rest_ = rest;
+        end_ = end;
+        auto raw = GetLineBreak(c);
+        auto cls = Resolve(c, raw, rule_);
+        auto action = Decide(c, cls);
+        zwj_ = (raw == LB::ZWJ);
+        return action;
+    }
+
+private:
+    /// 直前との間を判定し、状態を更新する
+    auto Decide(char32_t c, LB cls) noexcept -> Action
+    {
+        if (first_) {                                                               // LB2
+            if (IsAny(cls, LB::CM, LB::ZWJ)) cls = LB::AL;                          // LB10
+            Update(c, cls);
+            first_ = false;
+            return ActionProhibited;
+        }
+
+        auto p = prev_;
+        if (IsAny(cls, LB::CM, LB::ZWJ)) {
+            // LB4 ～ LB8a より前に判定しても結果は変わらない
+            if (!IsAny(p, LB::BK, LB::CR, LB::LF, LB::NL, LB::SP, LB::ZW)) return ActionProhibited;   // LB9 (直前の文字として扱う)
+            cls = LB::AL;                                                           // LB10
+        }
+        if (p == LB::BK) return Update(c, cls), ActionMandatory;                    // LB4
+        if (p == LB::CR && cls == LB::LF) return Update(c, cls), ActionProhibited;  // LB5
+        if (IsAny(p, LB::CR, LB::LF, LB::NL)) return Update(c, cls), ActionMandatory;
+        if (IsAny(cls, LB::BK, LB::CR, LB::LF, LB::NL)) return Update(c, cls), ActionProhibited;  // LB6
+        if (IsAny(cls, LB::SP, LB::ZW)) return Update(c, cls), ActionProhibited;    // LB7
+        if (p == LB::ZW || (p == LB::SP && space_ == LB::ZW)) return Update(c, cls), ActionAllowed;   // LB8
+        if (zwj_) return Update(c, cls), ActionProhibited;                          // LB8a
+
+        auto action = Pair(c, cls);
+        Update(c, cls);
+        return action;
+    }
+
+    /// LB11 ～ LB31
+    auto Pair(char32_t c, LB cls) const noexcept -> Action
+    {
+        auto p = prev_;
+        auto s = (p == LB::SP) ? space_ : p;    // SP* の前
+        if (cls == LB::WJ || p == LB::WJ) return ActionProhibited;                  // LB11
+        if (p == LB::GL) return ActionProhibited;                                   // LB12
+        if (cls == LB::GL && !IsAny(p, LB::SP, LB::BA, LB::HY)) return ActionProhibited;  // LB12a
+        if (IsAny(cls, LB::CL, LB::CP, LB::EX, LB::IS, LB::SY)) return ActionProhibited;  // LB13
+        if (s == LB::OP) return ActionProhibited;                                   // LB14
+        if (s == LB::QU && cls == LB::OP) return ActionProhibited;                  // LB15
+        if (IsAny(s, LB::CL, LB::CP) && cls == LB::NS) return ActionProhibited;     // LB16
+        if (s == LB::B2 && cls == LB::B2) return ActionProhibited;                  // LB17
+        if (p == LB::SP) return ActionAllowed;                                      // LB18
+        if (cls == LB::QU || p == LB::QU) return ActionProhibited;                  // LB19
+        if (cls == LB::CB || p == LB::CB) return ActionAllowed;                     // LB20
+        if (IsAny(cls, LB::BA, LB::HY, LB::NS) || p == LB::BB) return ActionProhibited;   // LB21
+        if (hyphen_) return ActionProhibited;                                       // LB21a
+        if (p == LB::SY && cls == LB::HL) return ActionProhibited;                  // LB21b
+        if (cls == LB::IN) return ActionProhibited;                                 // LB22
+        if (IsAny(p, LB::AL, LB::HL) && cls == LB::NU) return ActionProhibited;     // LB23
+        if (p == LB::NU && IsAny(cls, LB::AL, LB::HL)) return ActionProhibited;
+        if (p == LB::PR && IsAny(cls, LB::ID, LB::EB, LB::EM)) return ActionProhibited;   // LB23a
+        if (IsAny(p, LB::ID, LB::EB, LB::EM) && cls == LB::PO) return ActionProhibited;
+        if (IsAny(p, LB::PR, LB::PO) && IsAny(cls, LB::AL, LB::HL)) return ActionProhibited;  // LB24
+        if (IsAny(p, LB::AL, LB::HL) && IsAny(cls, LB::PR, LB::PO)) return ActionProhibited;
+        if (IsAny(p, LB::PR, LB::PO, LB::OP, LB::HY, LB::IS) && cls == LB::NU) return ActionProhibited;   // LB25
+        if (IsAny(p, LB::PR, LB::PO) && cls == LB::OP && IsNumberAhead()) return ActionProhibited;
+        if (number_ && cls == LB::NU) return ActionProhibited;
+        if ((number_ || closed_) && IsAny(cls, LB::PR, LB::PO)) return ActionProhibited;
+        if (p == LB::JL && IsAny(cls, LB::JL, LB::JV, LB::H2, LB::H3)) return ActionProhibited;   // LB26
+        if (IsAny(p, LB::JV, LB::H2) && IsAny(cls, LB::JV, LB::JT)) return ActionProhibited;
+        if (IsAny(p, LB::JT, LB::H3) && cls == LB::JT) return ActionProhibited;
+        if (IsAny(p, LB::JL, LB::JV, LB::JT, LB::H2, LB::H3) && cls == LB::PO) return ActionProhibited;    // LB27
+        if (p == LB::PR && IsAny(cls, LB::JL, LB::JV, LB::JT, LB::H2, LB::H3)) return ActionProhibited;
+        if (IsAny(p, LB::AL, LB::HL) && IsAny(cls, LB::AL, LB::HL)) return ActionProhibited;  // LB28
+        if (p == LB::IS && IsAny(cls, LB::AL, LB::HL)) return ActionProhibited;     // LB29
+        if (IsAny(p, LB::AL, LB::HL, LB::NU) && cls == LB::OP && !IsEastAsian(c)) return ActionProhibited;   // LB30
+        if (p == LB::CP && IsAny(cls, LB::AL, LB::HL, LB::NU) && !IsEastAsian(char_)) return ActionProhibited;
+        if (p == LB::RI && cls == LB::RI && ri_ % 2) return ActionProhibited;       // LB30a
+        if (cls == LB::EM && (p == LB::EB || IsUnassignedPictographic(char_))) return ActionProhibited;    // LB30b
+        return ActionAllowed;                                                       // LB31
+    }
+
+    /// 先読みして CM* NU が続くか返す (LB25)
+    auto IsNumberAhead() const noexcept -> bool
+    {
+        for (auto it = rest_; it != end_;) {
+            auto c = NextPoint(it, end_);
+            auto cls = Resolve(c, GetLineBreak(c), rule_);
+            if (!IsAny(cls, LB::CM, LB::ZWJ)) return cls == LB::NU;
+        }
+        return false;
+    }
+
+    /// 文字を直前の文字にする
+    void Update(char32_t c, LB cls) noexcept
+    {
+        hyphen_ = IsAny(cls, LB::HY, LB::BA) && prev_ == LB::HL && !first_;
+        closed_ = number_ && IsAny(cls, LB::CL, LB::CP);
+        number_ = (cls == LB::NU) || (number_ && IsAny(cls, LB::SY, LB::IS));
+        ri_ = (cls == LB::RI) ? ri_ + 1 : 0;
+        if (cls != LB::SP) space_ = cls;
+        prev_ = cls;
+        char_ = c;
+    }
+
+    LineBreakRule rule_;
+    LB prev_ = LB::XX;          // 直前の文字の改行クラス (LB9, LB10 の適用後)
+    LB space_ = LB::XX;         // 直前の SP 以外の文字の改行クラス
+    std::size_t ri_ = 0;        // 直前に続く RI の数
+    bool first_ = true;         // 先頭
+    bool zwj_ = false;          // 直前の文字が ZWJ (LB8a)
+    bool hyphen_ = false;       // 直前が HL (HY | BA) (LB21a)
+    char32_t char_ = 0;         // 直前の文字 (LB9 で結合した文字を除く)
+    bool number_ = false;       // 直前が NU (NU | SY | IS)* の途中 (LB25)
+    bool closed_ = false;       // 直前が NU (NU | SY | IS)* (CL | CP) (LB25)
+    const Char* rest_ = nullptr;
+    const Char* end_ = nullptr;
+};
+
+template <class Char>
+auto Next(std::basic_string_view<Char> text, std::size_t pos, LineBreakRule rule) noexcept -> LineBreakPoint
+{
+    auto begin = text.data();
+    auto end = begin + text.size();
+    if (pos >= text.size()) return {text.size(), true};
+
+    auto it = begin + pos;
+    auto breaker = Breaker<Char>(rule);
+    auto c = NextPoint(it, end);
+    breaker.Feed(c, it, end);
+    while (it != end) {
+        auto next = it;
+        c = NextPoint(next, end);
+        auto action = breaker.Feed(c, next, end);
+        if (action != ActionProhibited) return {std::size_t(it - begin), action == ActionMandatory};
+        it = next;
+    }
+    return {text.size(), true};                                                     // LB3
+}
+
+/// ビットを立てる
+inline void SetBit(std::uint64_t* bitmap, std::size_t pos) noexcept
+{
+    bitmap[pos / 64] |= std::uint64_t(1) << (pos % 64);
+}
+
+template <class Char>
+auto Find(std::basic_string_view<Char> text, std::uint64_t* breaks, std::uint64_t* mandatory, LineBreakRule rule) noexcept
+    -> std::size_t
+{
+    auto size = LineBreakBitmapSize(text.size());
+    for (auto i = std::size_t {}; i < size; ++i) breaks[i] = 0;
+    if (mandatory) {
+        for (auto i = std::size_t {}; i < size; ++i) mandatory[i] = 0;
+    }
+    if (text.empty()) return 0;
+
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto count = std::size_t {};
+    auto breaker = Breaker<Char>(rule);
+    for (auto it = begin; it != end;) {
+        auto pos = std::size_t(it - begin);
+        auto c = NextPoint(it, end);
+        auto action = breaker.Feed(c, it, end);
+        if (action == ActionProhibited) continue;
+        SetBit(breaks, pos);
+        if (mandatory && action == ActionMandatory) SetBit(mandatory, pos);
+        ++count;
+    }
+    SetBit(breaks, text.size());                                                    // LB3
+    if (mandatory) SetBit(mandatory, text.size());
+    return count + 1;
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto NextLineBreak(std::string_view text, std::size_t pos, LineBreakRule rule) noexcept -> LineBreakPoint
+{
+    return Next(text, pos, rule);
+}
+
+auto NextLineBreak(std::u16string_view text, std::size_t pos, LineBreakRule rule) noexcept -> LineBreakPoint
+{
+    return Next(text, pos, rule);
+}
+
+auto FindLineBreaks(std::string_view text, std::uint64_t* breaks, std::uint64_t* mandatory, LineBreakRule rule) noexcept
+    -> std::size_t
+{
+    return Find(text, breaks, mandatory, rule);
+}
+
+auto FindLineBreaks(std::u16string_view text, std::uint64_t* breaks, std::uint64_t* mandatory, LineBreakRule rule) noexcept
+    -> std::size_t
+{
+    return Find(text, breaks, mandatory, rule);
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,227 @@
+﻿/**
+ * @brief 行分割 (UAX #14) と日本語の禁則処理
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_LINEBREAKING_HPP_
+#define PITS_LINEBREAKING_HPP_
+
+#include <cstddef>      // size_t ptrdiff_t
+#include <cstdint>      // uint64_t
+#include <iterator>     // forward_iterator_tag
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ * 行分割
+ *
+ * 改行クラスは UnicodeProperty.hpp の GetLineBreak を使い、
+ * LB1 ～ LB31 の規則 (Unicode 14.0) で改行できる位置を求める
+ * 位置はコードユニット単位で、その位置の文字の前で改行できる事を示す
+ * 文字列の先頭は含まず、末尾は必ず改行する位置 (LB3) として含む
+ * 不正なシーケンスは置換文字 (AL) として扱う
+ * 数字の規則 (LB25) は LineBreakTest.txt と同じく UAX #14 Example 7 の正規表現
+ * (PR | PO)? (OP | HY)? NU (NU | SY | IS)* (CL | CP)? (PR | PO)? の内側で改行しない
+ *
+ * LineBreakRule::Standard は LB1 の既定どおり小書きの仮名や長音記号 (CJ) を NS として扱い、行頭に置かない
+ * これは JIS X 4051 の厳しい禁則と同じなので LineBreakRule::Japanese は Standard の別名
+ * LineBreakRule::Loose は CJ を ID として扱うテーラリングで、CJ の前でも改行する
+ * (CSS の line-break: normal, loose の CJ の扱い)
+ * 括弧類, 句読点, 中点, 繰り返し記号等の行頭行末禁則は UAX #14 の規則で扱われる
+ *
+ * 参考
+ * - UAX #14        ... https://www.unicode.org/reports/tr14/
+ * - JIS X 4051     ... https://www.w3.org/TR/jlreq/#characters_not_starting_a_line
+ */
+
+/// 禁則の規則
+enum class LineBreakRule {
+    Standard,               // UAX #14 の既定 (CJ は NS)
+    Loose,                  // CJ を ID にするテーラリング
+    Japanese = Standard,    // 日本語の厳しい禁則 (JIS X 4051) 既定と同じ
+};
+
+/// 改行できる位置
+struct LineBreakPoint {
+    std::size_t position;   // 位置 (コードユニット単位)
+    bool mandatory;         // 必ず改行する (改行文字の後と末尾)
+};
+
+/**
+ * @brief 次の改行できる位置を返す
+ * @param text UTF8 文字列
+ * @param pos 0 または改行できる位置
+ * @param rule 禁則の規則
+ * @return pos より後の最初の改行できる位置 pos が末尾なら {末尾, true}
+ */
+auto NextLineBreak(std::string_view text, std::size_t pos, LineBreakRule rule = LineBreakRule::Standard) noexcept
+    -> LineBreakPoint;
+
+/**
+ * @brief 次の改行できる位置を返す
+ * @param text UTF16 文字列
+ * @param pos 0 または改行できる位置
+ * @param rule 禁則の規則
+ * @return pos より後の最初の改行できる位置 pos が末尾なら {末尾, true}
+ */
+auto NextLineBreak(std::u16string_view text, std::size_t pos, LineBreakRule rule = LineBreakRule::Standard) noexcept
+    -> LineBreakPoint;
+
+/**
+ * @brief 改行位置のビットマップに必要な要素数を返す
+ * @param units 文字列のコードユニット数
+ * @return 位置 0 ～ units の分の uint64_t の数
+ */
+constexpr auto LineBreakBitmapSize(std::size_t units) noexcept -> std::size_t
+{
+    return units / 64 + 1;
+}
+
+/**
+ * @brief 段落全体の改行できる位置を1回の走査でビットマップに書き込む
+ *
+ * 位置 i のビットは bitmap[i / 64] の (i % 64) ビット目
+ *
+ * @param text UTF8 文字列
+ * @param breaks 改行できる位置 LineBreakBitmapSize(text.size()) 要素
+ * @param mandatory 必ず改行する位置 LineBreakBitmapSize(text.size()) 要素 不要なら nullptr
+ * @param rule 禁則の規則
+ * @return 改行できる位置の数
+ */
+auto FindLineBreaks(std::string_view text, std::uint64_t* breaks, std::uint64_t* mandatory = nullptr,
+                    LineBreakRule rule = LineBreakRule::Standard) noexcept -> std::size_t;
+
+/**
+ * @brief 段落全体の改行できる位置を1回の走査でビットマップに書き込む
+ * @param text UTF16 文字列
+ * @param breaks 改行できる位置 LineBreakBitmapSize(text.size()) 要素
+ * @param mandatory 必ず改行する位置 LineBreakBitmapSize(text.size()) 要素 不要なら nullptr
+ * @param rule 禁則の規則
+ * @return 改行できる位置の数
+ */
+auto FindLineBreaks(std::u16string_view text, std::uint64_t* breaks, std::uint64_t* mandatory = nullptr,
+                    LineBreakRule rule = LineBreakRule::Standard) noexcept -> std::size_t;
+
+/*
+ *
+ */
+
+/**
+ * @brief 改行できる位置を順に返すイテレータ
+ * @tparam Char char または char16_t
+ */
+template <class Char>
+class LineBreakIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = LineBreakPoint;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    /// 終端
+    LineBreakIterator() noexcept = default;
+
+    /**
+     * @brief 先頭から走査する
+     * @param text 文字列
+     * @param rule 禁則の規則
+     */
+    LineBreakIterator(std::basic_string_view<Char> text, LineBreakRule rule) noexcept
+        : text_(text), rule_(rule), point_ {0, false}, end_(text.empty())
+    {
+        ++*this;
+    }
+
+    auto operator*() const noexcept -> reference { return point_; }
+    auto operator->() const noexcept -> pointer { return &point_; }
+
+    auto operator++() noexcept -> LineBreakIterator&
+    {
+        if (point_.position == text_.size()) {
+            end_ = true;
+        } else {
+            point_ = NextLineBreak(text_, point_.position, rule_);
+        }
+        return *this;
+    }
+
+    auto operator++(int) noexcept -> LineBreakIterator
+    {
+        auto old = *this;
+        ++*this;
+        return old;
+    }
+
+    /// 終端同士か、同じ位置か
+    friend auto operator==(const LineBreakIterator& l, const LineBreakIterator& r) noexcept -> bool
+    {
+        return (l.end_ || r.end_) ? l.end_ == r.end_ : l.point_.position == r.point_.position;
+    }
+
+    friend auto operator!=(const LineBreakIterator& l, const LineBreakIterator& r) noexcept -> bool
+    {
+        return !(l == r);
+    }
+
+private:
+    std::basic_string_view<Char> text_;
+    LineBreakRule rule_ = LineBreakRule::Standard;
+    LineBreakPoint point_ {0, false};
+    bool end_ = true;
+};
+
+/**
+ * @brief 改行できる位置の範囲 (range-based for 用)
+ * @tparam Char char または char16_t
+ */
+template <class Char>
+class LineBreakRange {
+public:
+    LineBreakRange(std::basic_string_view<Char> text, LineBreakRule rule) noexcept : text_(text), rule_(rule) {}
+
+    auto begin() const noexcept -> LineBreakIterator<Char> { return LineBreakIterator<Char>(text_, rule_); }
+    auto end() const noexcept -> LineBreakIterator<Char> { return LineBreakIterator<Char>(); }
+
+private:
+    std::basic_string_view<Char> text_;
+    LineBreakRule rule_;
+};
+
+/// UTF8 文字列の改行できる位置の範囲を返す
+inline auto LineBreaks(std::string_view text, LineBreakRule rule = LineBreakRule::Standard) noexcept
+    -> LineBreakRange<char>
+{
+    return LineBreakRange<char>(text, rule);
+}
+
+/// UTF16 文字列の改行できる位置の範囲を返す
+inline auto LineBreaks(std::u16string_view text, LineBreakRule rule = LineBreakRule::Standard) noexcept
+    -> LineBreakRange<char16_t>
+{
+    return LineBreakRange<char16_t>(text, rule);
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
@@ -0,0 +1,389 @@
+﻿/**
+ * @brief ユニコード正規化 (NFC, NFD, NFKC, NFKD)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/Normalize.hpp"
+#include "Pits/Encoding.hpp"
+#include "Pits/UnicodeTable.hpp"
+#include <algorithm>    // max
+#include <iterator>     // size
+#include <tuple>        // get
+#include <type_traits>  // make_unsigned_t
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ *
+ */
+
+namespace {
+
+/// ハングル音節の算術的な分解, 合成
+constexpr auto HangulSBase = char32_t(0xac00);
+constexpr auto HangulLBase = char32_t(0x1100);
+constexpr auto HangulVBase = char32_t(0x1161);
+constexpr auto HangulTBase = char32_t(0x11a7);
+constexpr auto HangulLCount = char32_t(19);
+constexpr auto HangulVCount = char32_t(21);
+constexpr auto HangulTCount = char32_t(28);
+constexpr auto HangulNCount = HangulVCount * HangulTCount;
+constexpr auto HangulSCount = HangulLCount * HangulNCount;
+
+/// 正規化形式毎の設定
+struct FormTraits
+{
+    std::uint16_t no;           // QC=N のビット
+    std::uint16_t maybe;        // QC=M のビット
+    std::uint16_t decompose;    // 分解する文字のビット
+    bool compat;                // 互換分解する
+    bool compose;               // 正準合成する
+};
+
+/// 正規化形式毎の設定を返す
+constexpr auto GetTraits(NormalizationForm form) noexcept -> FormTraits
+{
+    using namespace UnicodeTable;
+    switch (form) {
+    case NormalizationForm::NFD:    return {NormalizationNFDNo, 0, NormalizationNFDNo, false, false};
+    case NormalizationForm::NFKC:   return {NormalizationNFKCNo, NormalizationNFKCMaybe, NormalizationNFKDNo, true, true};
+    case NormalizationForm::NFKD:   return {NormalizationNFKDNo, 0, NormalizationNFKDNo, true, false};
+    default:                        return {NormalizationNFCNo, NormalizationNFCMaybe, NormalizationNFDNo, false, true};
+    }
+}
+
+/// 正規化のプロパティを返す
+inline auto GetProperty(char32_t c) noexcept -> std::uint16_t
+{
+    return UnicodeTable::GetNormalization(c);
+}
+
+/// プロパティから結合クラスを返す
+constexpr auto CombiningClass(std::uint16_t property) noexcept -> std::uint8_t
+{
+    return std::uint8_t(property & UnicodeTable::NormalizationCombiningClass);
+}
+
+/// 手前が安定した境界になる文字 (結合クラス 0 かつ QC=Y) であるか返す
+constexpr auto IsBoundary(std::uint16_t property, const FormTraits& traits) noexcept -> bool
+{
+    return !(property & (UnicodeTable::NormalizationCombiningClass | traits.no | traits.maybe));
+}
+
+/// クイックチェックの結果と、最初に QC=Y でなくなる文字より前の最後の境界位置
+struct CheckResult
+{
+    QuickCheckResult result;
+    std::size_t stable;
+};
+
+/// クイックチェックする (UAX #15 9. Detecting Normalization Forms)
+template <class Char>
+auto Check(std::basic_string_view<Char> text, const FormTraits& traits) noexcept -> CheckResult
+{
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto it = begin;
+    auto last = std::uint8_t {};
+    auto result = QuickCheckResult::Yes;
+    auto stable = std::size_t {};
+
+    while (it != end) {
+
+        // ASCII は全て境界になる
+        if (char32_t(std::make_unsigned_t<Char>(*it)) <= 0x7f) {
+            auto run = EncodingImplement::SkipASCII(it, end);
+            if (result == QuickCheckResult::Yes) {
+                stable = std::size_t(run - 1 - begin);
+            }
+            last = 0;
+            it = run;
+            continue;
+        }
+
+        auto at = it;
+        auto c = char32_t {};
+        if constexpr (sizeof(Char) == sizeof(char)) {
+            auto to32 = EncodingUTF8ToUTF32(it, end);
+            c = std::get<1>(to32);
+            if (c > CharacterMax) return {QuickCheckResult::No, stable};
+            it = std::get<0>(to32);
+        }
+        else {
+            c = char32_t(*it++);
+            if (!IsSafeCharacter(c)) return {QuickCheckResult::No, stable};
+        }
+
+        auto property = GetProperty(c);
+        auto cc = CombiningClass(property);
+        if (cc && last > cc) return {QuickCheckResult::No, stable};
+        if (property & traits.no) return {QuickCheckResult::No, stable};
+        if (property & traits.maybe) {
+            result = QuickCheckResult::Maybe;
+        }
+        else if (result == QuickCheckResult::Yes && !cc) {
+            stable = std::size_t(at - begin);
+        }
+        last = cc;
+    }
+    return {result, stable};
+}
+
+/// 正準順序を保って文字を追加する
+void AppendOrdered(std::u32string& out, char32_t c)
+{
+    auto cc = CombiningClass(GetProperty(c));
+    auto i = out.size();
+    out.push_back(c);
+    if (!cc) return;
+    for (; i > 0 && CombiningClass(GetProperty(out[i - 1])) > cc; --i) {
+        out[i] = out[i - 1];
+    }
+    out[i] = c;
+}
+
+/// 1文字を完全分解して正準順序で追加する
+void Decompose(char32_t c, const FormTraits& traits, std::u32string& out)
+{
+    if (HangulSBase <= c && c < HangulSBase + HangulSCount) {
+        auto s = c - HangulSBase;
+        out.push_back(HangulLBase + s / HangulNCount);
+        out.push_back(HangulVBase + (s % HangulNCount) / HangulTCount);
+        if (s % HangulTCount) out.push_back(HangulTBase + s % HangulTCount);
+        return;
+    }
+    if (!(GetProperty(c) & traits.decompose)) {
+        AppendOrdered(out, c);
+        return;
+    }
+
+    // (コードポイント, 正準分解, 互換分解) の組を二分探索する
+    using UnicodeTable::Decompositions;
+    auto lo = std::size_t {};
+    auto hi = std::size(Decompositions) / 3;
+    while (lo < hi) {
+        auto mid = (lo + hi) / 2;
+        if (Decompositions[mid * 3] < c) lo = mid + 1;
+        else hi = mid;
+    }
+    auto packed = Decompositions[lo * 3 + (traits.compat ? 2 : 1)];
+    auto d = UnicodeTable::DecompositionData + (packed >> 5);
+    for (auto n = packed & 0x1f; n; --n) {
+        AppendOrdered(out, *d++);
+    }
+}
+
+/// 2文字を合成した文字を返す 合成しない場合は 0
+auto ComposePair(char32_t a, char32_t b) noexcept -> char32_t
+{
+    if (HangulLBase <= a && a < HangulLBase + HangulLCount && HangulVBase <= b && b < HangulVBase + HangulVCount) {
+        return HangulSBase + ((a - HangulLBase) * HangulVCount + (b - HangulVBase)) * HangulTCount;
+    }
+    if (HangulSBase <= a && a < HangulSBase + HangulSCount && !((a - HangulSBase) % HangulTCount)
+        && HangulTBase < b && b < HangulTBase + HangulTCount) {
+        return a + (b - HangulTBase);
+    }
+
+    // 2文字目になり得るのは NFC_QC=M の文字だけ
+    if (!(GetProperty(b) & UnicodeTable::NormalizationNFCMaybe)) return 0;
+
+    using UnicodeTable::Compositions;
+    auto lo = std::size_t {};
+    auto hi = std::size(Compositions) / 3;
+    while (lo < hi) {
+        auto mid = (lo + hi) / 2;
+        auto first = Compositions[mid * 3];
+        auto second = Compositions[mid * 3 + 1];
+        if (first < a || (first == a && second < b)) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo * 3 < std::size(Compositions) && Compositions[lo * 3] == a && Compositions[lo * 3 + 1] == b) {
+        return Compositions[lo * 3 + 2];
+    }
+    return 0;
+}
+
+/// 正準順序に並んだ from 以降を正準合成する
+void Compose(std::u32string& s, std::size_t from)
+{
+    if (s.size() <= from) return;
+
+    auto starter = from;
+    auto last = int(CombiningClass(GetProperty(s[from])));
+    if (last) last = 0x100;     // スターター以外で始まる場合は合成しない
+    auto to = from + 1;
+
+    for (auto i = from + 1; i < s.size(); ++i) {
+        auto c = s[i];
+        auto cc = CombiningClass(GetProperty(c));
+        auto composite = (last < 0x100) ? ComposePair(s[starter], c) : char32_t {};
+        if (composite && (last < cc || last == 0)) {
+            s[starter] = composite;
+            continue;
+        }
+        if (!cc) starter = to;
+        last = cc;
+        s[to++] = c;
+    }
+    s.resize(to);
+}
+
+/// 正規化した UTF32 を UTF8 で追加する
+void AppendUTF8(const std::u32string& from, std::string& out)
+{
+    for (auto c : from) {
+        char units[4];
+        auto end = std::get<1>(ConvertUTF32ToUTF8(&c, units));
+        out.append(units, std::size_t(end - units));
+    }
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto GetCombiningClass(char32_t c) noexcept -> std::uint8_t
+{
+    return CombiningClass(GetProperty(c));
+}
+
+auto QuickCheck(std::string_view text, NormalizationForm form) noexcept -> QuickCheckResult
+{
+    return Check(text, GetTraits(form)).result;
+}
+
+auto QuickCheck(std::u32string_view text, NormalizationForm form) noexcept -> QuickCheckResult
+{
+    return Check(text, GetTraits(form)).result;
+}
+
+auto IsNormalized(std::string_view text, NormalizationForm form) -> bool
+{
+    auto buffer = std::string {};
+    return Normalize(text, form, buffer).data() == text.data();
+}
+
+auto IsNormalized(std::u32string_view text, NormalizationForm form) -> bool
+{
+    switch (QuickCheck(text, form)) {
+    case QuickCheckResult::Yes: return true;
+    case QuickCheckResult::No:  return false;
+    default:                    return Normalize(text, form) == text;
+    }
+}
+
+auto Normalize(std::string_view text, NormalizationForm form, std::string& buffer) -> std::string_view
+{
+    auto traits = GetTraits(form);
+    auto check = Check(text, traits);
+    if (check.result == QuickCheckResult::Yes) {
+        return text;
+    }
+
+    // 安定した境界より前はそのまま使う
+    auto work = std::u32string {};
+    auto rest = text.substr(check.stable);
+    auto it = rest.data();
+    auto end = it + rest.size();
+    while (it != end) {
+        Decompose(NextPoint(it, end), traits, work);
+    }
+    if (traits.compose) {
+        Compose(work, 0);
+    }
+
+    buffer.assign(text.data(), check.stable);
+    AppendUTF8(work, buffer);
+    if (check.result == QuickCheckResult::Maybe && std::string_view(buffer).substr(check.stable) == rest) {
+        return text;
+    }
+    return buffer;
+}
+
+auto Normalize(std::string_view text, NormalizationForm form) -> std::string
+{
+    auto buffer = std::string {};
+    auto result = Normalize(text, form, buffer);
+    if (result.data() != buffer.data()) {
+        return std::string(result);
+    }
+    return buffer;
+}
+
+auto Normalize(std::u32string_view text, NormalizationForm form) -> std::u32string
+{
+    auto traits = GetTraits(form);
+    auto check = Check(text, traits);
+    auto out = std::u32string(text.substr(0, check.stable));
+    if (check.result == QuickCheckResult::Yes) {
+        out.append(text.substr(check.stable));
+        return out;
+    }
+
+    // 安定した境界より前はそのまま使う
+    for (auto c : text.substr(check.stable)) {
+        Decompose(IsSafeCharacter(c) ? c : ReplacementCharacter, traits, out);
+    }
+    if (traits.compose) {
+        Compose(out, check.stable);
+    }
+    return out;
+}
+
+/*
+ *
+ */
+
+void Normalizer::Append(std::string_view text, std::string& out)
+{
+    auto old = pending_.size();
+    pending_.append(text);
+
+    // 追加した範囲 (と直前の入力末尾の不完全なシーケンス) から後ろ向きに境界を探す
+    auto traits = GetTraits(form_);
+    auto begin = pending_.data();
+    auto end = begin + pending_.size();
+    auto lower = std::max(std::size_t(1), old > 3 ? old - 3 : std::size_t {});
+    for (auto i = pending_.size(); i-- > lower; ) {
+        auto p = begin + i;
+        if ((*p & 0xc0) == 0x80) continue;
+        auto c = char32_t(std::uint8_t(*p));
+        if (c > 0x7f) {
+            c = std::get<1>(EncodingUTF8ToUTF32(p, end));
+            if (c > CharacterMax) continue;
+        }
+        if (!IsBoundary(GetProperty(c), traits)) continue;
+
+        // 境界の手前までを正規化して出力する
+        auto buffer = std::string {};
+        out.append(Normalize(std::string_view(begin, i), form_, buffer));
+        pending_.erase(0, i);
+        return;
+    }
+}
+
+void Normalizer::Finish(std::string& out)
+{
+    auto buffer = std::string {};
+    out.append(Normalize(pending_, form_, buffer));
+    pending_.clear();
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,172 @@
+﻿/**
+ * @brief ユニコード正規化 (NFC, NFD, NFKC, NFKD)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_NORMALIZE_HPP_
+#define PITS_NORMALIZE_HPP_
+
+#include <cstdint>      // uint8_t
+#include <string>
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ * 正規化
+ *
+ * テーブルはビルド時に ucd/ 以下の UCD ファイルから tools/UnicodeTableGenerator で生成する
+ * 不正なシーケンスは ToUTF16 等と同じく置き換え文字にしてから正規化する
+ *
+ * 参考
+ * - UAX #15        ... https://www.unicode.org/reports/tr15/
+ */
+
+/// 正規化形式
+enum class NormalizationForm {
+    NFC,    // 正準分解後に正準合成
+    NFD,    // 正準分解
+    NFKC,   // 互換分解後に正準合成
+    NFKD,   // 互換分解
+};
+
+/// クイックチェックの結果
+enum class QuickCheckResult {
+    Yes,    // 正規化済み
+    No,     // 正規化されていない
+    Maybe,  // 正規化して比較しないと分からない
+};
+
+/**
+ * @brief 正準結合クラス (Canonical_Combining_Class) を返す
+ * @param c 文字
+ * @return 結合クラス 0 はスターター
+ */
+auto GetCombiningClass(char32_t c) noexcept -> std::uint8_t;
+
+/**
+ * @brief 正規化済みであるかを1度の走査で判定する
+ * @param text UTF8 文字列 (不正なシーケンスを含む場合は No)
+ * @param form 正規化形式
+ * @return 判定結果
+ */
+auto QuickCheck(std::string_view text, NormalizationForm form) noexcept -> QuickCheckResult;
+
+/**
+ * @brief 正規化済みであるかを1度の走査で判定する
+ * @param text UTF32 文字列 (不正なコードを含む場合は No)
+ * @param form 正規化形式
+ * @return 判定結果
+ */
+auto QuickCheck(std::u32string_view text, NormalizationForm form) noexcept -> QuickCheckResult;
+
+/**
+ * @brief 正規化済みであるか返す クイックチェックで Maybe の場合だけ正規化して比較する
+ * @param text UTF8 文字列
+ * @param form 正規化形式
+ * @return 真偽
+ */
+auto IsNormalized(std::string_view text, NormalizationForm form) -> bool;
+
+/**
+ * @brief 正規化済みであるか返す クイックチェックで Maybe の場合だけ正規化して比較する
+ * @param text UTF32 文字列
+ * @param form 正規化形式
+ * @return 真偽
+ */
+auto IsNormalized(std::u32string_view text, NormalizationForm form) -> bool;
+
+/**
+ * @brief 正規化する 正規化済みなら入力をそのまま返す
+ *
+ * 最初に正規化が必要になる位置より前の安定した境界までは複写せずに済ませる
+ *
+ * @param text UTF8 文字列
+ * @param form 正規化形式
+ * @param buffer 正規化が必要な場合に結果を格納する
+ * @return text または buffer を参照する結果
+ */
+auto Normalize(std::string_view text, NormalizationForm form, std::string& buffer) -> std::string_view;
+
+/**
+ * @brief 正規化した文字列を返す
+ * @param text UTF8 文字列
+ * @param form 正規化形式
+ * @return 正規化した UTF8 文字列
+ */
+auto Normalize(std::string_view text, NormalizationForm form) -> std::string;
+
+/**
+ * @brief 正規化した文字列を返す
+ * @param text UTF32 文字列
+ * @param form 正規化形式
+ * @return 正規化した UTF32 文字列
+ */
+auto Normalize(std::u32string_view text, NormalizationForm form) -> std::u32string;
+
+/**
+ * @brief 長い文字列を分割して入力しながら正規化する
+ *
+ * 結合クラス 0 かつクイックチェック Yes の文字の手前を安定した境界とし、
+ * 境界までを正規化して出力し、以降は次の入力まで保持する
+ * 入力の切れ目で分断された UTF8 シーケンスも次の入力と繋げて扱う
+ */
+class Normalizer
+{
+public:
+
+    Normalizer(const Normalizer&) = default;
+    Normalizer& operator=(const Normalizer&) = default;
+    Normalizer(Normalizer&&) noexcept = default;
+    Normalizer& operator=(Normalizer&&) noexcept = default;
+
+    /**
+     * @brief 正規化形式を指定して作成する
+     * @param form 正規化形式
+     */
+    explicit Normalizer(NormalizationForm form) noexcept : form_(form) {}
+
+    /**
+     * @brief 入力の続きを正規化して出力に追加する
+     * @param text UTF8 文字列の一部
+     * @param out 出力先
+     */
+    void Append(std::string_view text, std::string& out);
+
+    /**
+     * @brief 保持している残りを正規化して出力に追加し、最初の状態に戻る
+     * @param out 出力先
+     */
+    void Finish(std::string& out);
+
+private:
+
+    /// 正規化形式
+    NormalizationForm form_;
+
+    /// 境界が確定していない入力
+    std::string pending_;
+};
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
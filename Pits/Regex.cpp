@@ -0,0 +1,1071 @@
+﻿/**
+ * @brief UTF8 のバイト列を直接照合する DFA の正規表現
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/Regex.hpp"
+#include "Pits/Encoding.hpp"
+#include "Pits/Search.hpp"
+#include "Pits/UnicodeProperty.hpp"
+#include <algorithm>    // sort unique
+#include <cstdint>      // uint8_t uint32_t
+#include <map>
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+namespace {
+
+/// 繰り返し回数の上限
+constexpr auto RepeatMax = 1000;
+
+/// 括弧の入れ子の上限
+constexpr auto DepthMax = 200;
+
+/// NFA の状態数の上限 (入れ子の繰り返しは回数の積で増えるので全体で抑える)
+constexpr auto StateMax = std::size_t(1) << 22;
+
+/// 一般カテゴリの短縮名 (GeneralCategory の順)
+constexpr const char* GeneralCategoryNames[] = {
+    "Cn", "Lu", "Ll", "Lt", "Lm", "Lo", "Mn", "Mc", "Me", "Nd", "Nl", "No", "Pc", "Pd", "Ps",
+    "Pe", "Pi", "Pf", "Po", "Sm", "Sc", "Sk", "So", "Zs", "Zl", "Zp", "Cc", "Cf", "Cs", "Co",
+};
+
+/*
+ *
+ */
+
+/// コードポイントの範囲
+struct Range {
+    char32_t first;
+    char32_t last;
+};
+
+using Ranges = std::vector<Range>;
+
+/// 範囲を整列して重なりと隣接をまとめる
+void Normalize(Ranges& ranges)
+{
+    std::sort(ranges.begin(), ranges.end(), [](auto& a, auto& b) { return a.first < b.first; });
+    auto out = std::size_t {};
+    for (auto& r : ranges) {
+        if (out && r.first <= ranges[out - 1].last + 1) {
+            ranges[out - 1].last = std::max(ranges[out - 1].last, r.last);
+        } else {
+            ranges[out++] = r;
+        }
+    }
+    ranges.resize(out);
+}
+
+/// 補集合を返す (整列済みである事)
+auto Negate(const Ranges& ranges) -> Ranges
+{
+    auto result = Ranges {};
+    auto next = char32_t {};
+    for (auto& r : ranges) {
+        if (next < r.first) result.push_back({next, r.first - 1});
+        next = r.last + 1;
+    }
+    if (next <= Unicode::CharacterMax) result.push_back({next, Unicode::CharacterMax});
+    return result;
+}
+
+/// 条件を満たす文字の範囲を返す
+template <class Predicate>
+auto Collect(Predicate predicate) -> Ranges
+{
+    auto result = Ranges {};
+    for (auto c = char32_t {}; c <= Unicode::CharacterMax; ++c) {
+        if (!predicate(c)) continue;
+        if (!result.empty() && result.back().last + 1 == c) {
+            result.back().last = c;
+        } else {
+            result.push_back({c, c});
+        }
+    }
+    return result;
+}
+
+/*
+ *
+ */
+
+/// 構文木
+struct Node {
+    enum Kind {
+        Empty,      // 空文字列
+        Class,      // 文字クラス (リテラルは1文字のクラス)
+        Concat,     // 連接
+        Alternate,  // 選択
+        Repeat,     // 繰り返し
+        Begin,      // ^
+        End,        // $
+    };
+
+    Kind kind = Empty;
+    Ranges ranges;
+    std::vector<Node> children;
+    int min = 0;
+    int max = -1;   // -1 は無制限
+};
+
+/**
+ * @brief パターンを構文木にする
+ */
+class Parser
+{
+public:
+
+    explicit Parser(std::string_view pattern) noexcept
+        : it_(pattern.data()), end_(pattern.data() + pattern.size())
+    {
+    }
+
+    /// 構文木にする 失敗したら error() に理由を返す
+    auto Parse(Node& node) -> bool
+    {
+        if (!ParseAlternate(node)) return false;
+        if (it_ != end_) return Fail("unmatched )");
+        return true;
+    }
+
+    auto error() const noexcept -> const std::string& { return error_; }
+
+private:
+
+    auto Fail(const char* message) -> bool
+    {
+        error_ = message;
+        return false;
+    }
+
+    auto Peek(char c) const noexcept -> bool { return it_ != end_ && *it_ == c; }
+
+    /// a|b|c
+    auto ParseAlternate(Node& node) -> bool
+    {
+        if (++depth_ > DepthMax) return Fail("nested too deeply");
+        auto first = Node {};
+        if (!ParseConcat(first)) return false;
+        if (!Peek('|')) {
+            node = std::move(first);
+            --depth_;
+            return true;
+        }
+        node.kind = Node::Alternate;
+        node.children.push_back(std::move(first));
+        while (Peek('|')) {
+            ++it_;
+            auto next = Node {};
+            if (!ParseConcat(next)) return false;
+            node.children.push_back(std::move(next));
+        }
+        --depth_;
+        return true;
+    }
+
+    /// abc
+    auto ParseConcat(Node& node) -> bool
+    {
+        node.kind = Node::Concat;
+        while (it_ != end_ && !Peek('|') && !Peek(')')) {
+            auto item = Node {};
+            if (!ParseRepeat(item)) return false;
+            node.children.push_back(std::move(item));
+        }
+        if (node.children.empty()) {
+            node.kind = Node::Empty;
+        } else if (node.children.size() == 1) {
+            auto only = std::move(node.children[0]);
+            node = std::move(only);
+        }
+        return true;
+    }
+
+    /// 10 進数を読む
+    auto ParseNumber(int& value) -> bool
+    {
+        if (it_ == end_ || *it_ < '0' || '9' < *it_) return false;
+        value = 0;
+        while (it_ != end_ && '0' <= *it_ && *it_ <= '9') {
+            value = std::min(value * 10 + (*it_++ - '0'), RepeatMax + 1);
+        }
+        return true;
+    }
+
+    /// {n}, {n,}, {n,m} 量指定子でなければ読まずに偽を返す
+    auto ParseBraces(int& min, int& max) -> bool
+    {
+        auto save = it_;
+        ++it_;
+        if (!ParseNumber(min)) {
+            it_ = save;
+            return false;
+        }
+        max = min;
+        if (Peek(',')) {
+            ++it_;
+            max = -1;
+            ParseNumber(max);
+        }
+        if (!Peek('}')) {
+            it_ = save;
+            return false;
+        }
+        ++it_;
+        return true;
+    }
+
+    /// 要素と量指定子
+    auto ParseRepeat(Node& node) -> bool
+    {
+        if (!ParseAtom(node)) return false;
+        for (;;) {
+            auto min = 0;
+            auto max = -1;
+            if (Peek('*')) {
+                ++it_;
+            } else if (Peek('+')) {
+                ++it_;
+                min = 1;
+            } else if (Peek('?')) {
+                ++it_;
+                max = 1;
+            } else if (!Peek('{') || !ParseBraces(min, max)) {
+                return true;
+            }
+            if (RepeatMax < min || RepeatMax < max || (0 <= max && max < min)) return Fail("invalid repetition");
+            if (node.kind == Node::Begin || node.kind == Node::End) return Fail("nothing to repeat");
+            if (Peek('?')) ++it_;   // 最短一致
+            auto repeat = Node {};
+            repeat.kind = Node::Repeat;
+            repeat.min = min;
+            repeat.max = max;
+            repeat.children.push_back(std::move(node));
+            node = std::move(repeat);
+        }
+    }
+
+    /// 1文字のクラスにする
+    static void Literal(Node& node, char32_t c)
+    {
+        node.kind = Node::Class;
+        node.ranges = {{c, c}};
+    }
+
+    /// 要素
+    auto ParseAtom(Node& node) -> bool
+    {
+        switch (*it_) {
+        case '(':
+            ++it_;
+            if (end_ - it_ >= 2 && it_[0] == '?' && it_[1] == ':') it_ += 2;
+            if (!ParseAlternate(node)) return false;
+            if (!Peek(')')) return Fail("missing )");
+            ++it_;
+            return true;
+        case '[':
+            ++it_;
+            node.kind = Node::Class;
+            return ParseClass(node.ranges);
+        case '.':
+            ++it_;
+            node.kind = Node::Class;
+            node.ranges = {{0, U'\n' - 1}, {U'\n' + 1, Unicode::CharacterMax}};
+            return true;
+        case '^':
+            ++it_;
+            node.kind = Node::Begin;
+            return true;
+        case '$':
+            ++it_;
+            node.kind = Node::End;
+            return true;
+        case '\\':
+            ++it_;
+            node.kind = Node::Class;
+            return ParseEscape(node.ranges);
+        case '*':
+        case '+':
+        case '?':
+            return Fail("nothing to repeat");
+        default:
+            Literal(node, NextPoint(it_, end_));
+            return true;
+        }
+    }
+
+    /// 16 進数を読む
+    auto ParseHex(char32_t& c, int digits) -> bool
+    {
+        c = 0;
+        auto count = 0;
+        for (; it_ != end_ && count < digits; ++it_, ++count) {
+            auto h = *it_;
+            auto v = ('0' <= h && h <= '9') ? h - '0' : ('a' <= h && h <= 'f') ? h - 'a' + 10 : ('A' <= h && h <= 'F') ? h - 'A' + 10 : -1;
+            if (v < 0) break;
+            c = c * 16 + char32_t(v);
+        }
+        return count && c <= Unicode::CharacterMax;
+    }
+
+    /// \ に続く文字 (クラスか1文字)
+    auto ParseEscape(Ranges& ranges) -> bool
+    {
+        if (it_ == end_) return Fail("trailing \\");
+        auto c = *it_++;
+        auto negate = false;
+        switch (c) {
+        case 'D': negate = true; [[fallthrough]];
+        case 'd': ranges = {{U'0', U'9'}}; break;
+        case 'W': negate = true; [[fallthrough]];
+        case 'w': ranges = {{U'0', U'9'}, {U'A', U'Z'}, {U'_', U'_'}, {U'a', U'z'}}; break;
+        case 'S': negate = true; [[fallthrough]];
+        case 's': ranges = {{U'\t', U'\r'}, {U' ', U' '}}; break;
+        case 'P': negate = true; [[fallthrough]];
+        case 'p': if (!ParseProperty(ranges)) return false; break;
+        case 'n': ranges = {{U'\n', U'\n'}}; break;
+        case 't': ranges = {{U'\t', U'\t'}}; break;
+        case 'r': ranges = {{U'\r', U'\r'}}; break;
+        case 'f': ranges = {{U'\f', U'\f'}}; break;
+        case 'v': ranges = {{U'\v', U'\v'}}; break;
+        case 'x':
+        case 'u': {
+            auto code = char32_t {};
+            auto braces = c == 'x' && Peek('{');
+            if (braces) ++it_;
+            if (!ParseHex(code, braces ? 6 : c == 'x' ? 2 : 4)) return Fail("invalid hexadecimal escape");
+            if (braces) {
+                if (!Peek('}')) return Fail("missing }");
+                ++it_;
+            }
+            ranges = {{code, code}};
+            break;
+        }
+        default:
+            if (('0' <= c && c <= '9') || ('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z')) {
+                return Fail("unknown escape");
+            }
+            --it_;
+            auto code = NextPoint(it_, end_);
+            ranges = {{code, code}};
+            break;
+        }
+        if (negate) ranges = Negate(ranges);
+        return true;
+    }
+
+    /// \p{...} の名前
+    auto ParseProperty(Ranges& ranges) -> bool
+    {
+        if (!Peek('{')) return Fail("missing {");
+        auto first = ++it_;
+        while (it_ != end_ && *it_ != '}') ++it_;
+        if (it_ == end_) return Fail("missing }");
+        auto name = std::string_view(first, std::size_t(it_ - first));
+        ++it_;
+
+        if (name == "Any") {
+            ranges = {{0, Unicode::CharacterMax}};
+            return true;
+        }
+
+        // 一般カテゴリ (1文字なら大分類)
+        auto categories = std::uint32_t {};
+        for (auto i = 0; i < 30; ++i) {
+            auto gc = std::string_view(GeneralCategoryNames[i]);
+            if (gc == name || (name.size() == 1 && gc[0] == name[0])) categories |= std::uint32_t(1) << i;
+        }
+        if (categories) {
+            ranges = Collect([&](char32_t c) {
+                return (categories >> unsigned(Unicode::GetGeneralCategory(c))) & 1;
+            });
+            return true;
+        }
+
+        // 用字
+        for (auto i = std::size_t {}; i < std::size(UnicodeTable::ScriptNames); ++i) {
+            if (name == UnicodeTable::ScriptNames[i]) {
+                auto script = Unicode::Script(i);
+                ranges = Collect([&](char32_t c) { return Unicode::GetScript(c) == script; });
+                return true;
+            }
+        }
+        return Fail("unknown property");
+    }
+
+    /// [...] の中で1文字を読む
+    auto ParseClassPoint(char32_t& c, Ranges& escaped) -> bool
+    {
+        if (*it_ != '\\') {
+            c = NextPoint(it_, end_);
+            return true;
+        }
+        ++it_;
+        if (!ParseEscape(escaped)) return false;
+        c = (escaped.size() == 1 && escaped[0].first == escaped[0].last) ? escaped[0].first : char32_t(-1);
+        return true;
+    }
+
+    /// [...]
+    auto ParseClass(Ranges& ranges) -> bool
+    {
+        auto negate = Peek('^');
+        if (negate) ++it_;
+        auto first = true;
+        for (;;) {
+            if (it_ == end_) return Fail("missing ]");
+            if (*it_ == ']' && !first) break;
+            first = false;
+
+            auto escaped = Ranges {};
+            auto c = char32_t {};
+            if (!ParseClassPoint(c, escaped)) return false;
+            if (c == char32_t(-1)) {
+                // \d 等のクラス
+                ranges.insert(ranges.end(), escaped.begin(), escaped.end());
+                continue;
+            }
+            if (end_ - it_ >= 2 && it_[0] == '-' && it_[1] != ']') {
+                ++it_;
+                auto last = char32_t {};
+                if (!ParseClassPoint(last, escaped)) return false;
+                if (last == char32_t(-1) || last < c) return Fail("invalid class range");
+                ranges.push_back({c, last});
+            } else {
+                ranges.push_back({c, c});
+            }
+        }
+        ++it_;
+        Normalize(ranges);
+        if (negate) ranges = Negate(ranges);
+        return true;
+    }
+
+    const char* it_;
+    const char* end_;
+    int depth_ {};
+    std::string error_;
+};
+
+/*
+ *
+ */
+
+/// NFA の状態
+struct NfaState {
+    enum Kind : std::uint8_t {
+        Byte,       // lo ～ hi のバイトで out へ
+        Split,      // out と out1 へ
+        Begin,      // 先頭なら out へ
+        End,        // 末尾なら out へ
+        Match,      // out 番目のパターンに一致
+    };
+
+    Kind kind;
+    std::uint8_t lo;
+    std::uint8_t hi;
+    std::uint32_t out;
+    std::uint32_t out1;
+};
+
+/// UTF8 にする (正しいコードポイントである事)
+auto EncodeUTF8(char32_t c, std::uint8_t* units) noexcept -> int
+{
+    if (c <= 0x7f) {
+        units[0] = std::uint8_t(c);
+        return 1;
+    }
+    if (c <= 0x7ff) {
+        units[0] = std::uint8_t(0xc0 | (c >> 6));
+        units[1] = std::uint8_t(0x80 | (c & 0x3f));
+        return 2;
+    }
+    if (c <= 0xffff) {
+        units[0] = std::uint8_t(0xe0 | (c >> 12));
+        units[1] = std::uint8_t(0x80 | ((c >> 6) & 0x3f));
+        units[2] = std::uint8_t(0x80 | (c & 0x3f));
+        return 3;
+    }
+    units[0] = std::uint8_t(0xf0 | (c >> 18));
+    units[1] = std::uint8_t(0x80 | ((c >> 12) & 0x3f));
+    units[2] = std::uint8_t(0x80 | ((c >> 6) & 0x3f));
+    units[3] = std::uint8_t(0x80 | (c & 0x3f));
+    return 4;
+}
+
+/**
+ * @brief コードポイントの範囲を、各バイトが範囲になる UTF8 のバイト列の範囲に分ける
+ *
+ * 例えば U+0080 ～ U+07FF は [c2-df][80-bf] の1つになる
+ *
+ * @param first 先頭 (サロゲートを含まない事)
+ * @param last 末尾
+ * @param f (const uint8_t* lo, const uint8_t* hi, int units) を受け取る関数
+ */
+template <class F>
+void SplitUTF8(char32_t first, char32_t last, F& f)
+{
+    // UTF8 の長さが変わる所で分ける
+    for (auto max : {char32_t(0x7f), char32_t(0x7ff), char32_t(0xffff)}) {
+        if (first <= max && max < last) {
+            SplitUTF8(first, max, f);
+            SplitUTF8(max + 1, last, f);
+            return;
+        }
+    }
+
+    // 後続データが全範囲にならない所で分ける
+    std::uint8_t lo[4] {};
+    std::uint8_t hi[4] {};
+    auto units = EncodeUTF8(last, hi);
+    for (auto i = 1; i < units; ++i) {
+        auto mask = (char32_t(1) << (6 * i)) - 1;
+        if ((first & ~mask) != (last & ~mask)) {
+            if (first & mask) {
+                SplitUTF8(first, first | mask, f);
+                SplitUTF8((first | mask) + 1, last, f);
+                return;
+            }
+            if ((last & mask) != mask) {
+                SplitUTF8(first, (last & ~mask) - 1, f);
+                SplitUTF8(last & ~mask, last, f);
+                return;
+            }
+        }
+    }
+    EncodeUTF8(first, lo);
+    f(lo, hi, units);
+}
+
+/// NFA
+struct Nfa {
+    std::vector<NfaState> states;
+
+    /// 各パターンの開始状態
+    std::vector<std::uint32_t> starts;
+
+    /// バイトから同値類への表と同値類の数
+    std::uint8_t classes[256] {};
+    std::size_t classCount {};
+
+    /// 状態数が上限を超えたか
+    bool tooLarge = false;
+
+    /// 状態を追加する 上限を超えたら追加せず tooLarge にする
+    auto Add(NfaState state) -> std::uint32_t
+    {
+        if (states.size() >= StateMax) {
+            tooLarge = true;
+            return 0;
+        }
+        states.push_back(state);
+        return std::uint32_t(states.size() - 1);
+    }
+
+    /// 分岐を追加する
+    auto AddSplit(std::uint32_t out, std::uint32_t out1) -> std::uint32_t
+    {
+        return Add({NfaState::Split, 0, 0, out, out1});
+    }
+
+    /// 構文木を next に続く状態にして開始状態を返す
+    auto Compile(const Node& node, std::uint32_t next) -> std::uint32_t
+    {
+        // 上限を超えたら残りは組み立てない
+        if (tooLarge) return next;
+
+        switch (node.kind) {
+        case Node::Empty:
+            return next;
+        case Node::Class:
+            return CompileClass(node.ranges, next);
+        case Node::Concat:
+            for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+                next = Compile(*it, next);
+            }
+            return next;
+        case Node::Alternate: {
+            auto entry = Compile(node.children.back(), next);
+            for (auto i = node.children.size() - 1; i--;) {
+                entry = AddSplit(Compile(node.children[i], next), entry);
+            }
+            return entry;
+        }
+        case Node::Repeat: {
+            auto& child = node.children[0];
+            if (node.max < 0) {
+                // x* は分岐から x を経て分岐に戻る
+                auto loop = AddSplit(0, next);
+                states[loop].out = Compile(child, loop);
+                next = loop;
+            } else {
+                // x{0,n} は (x(x)?)? の様に後ろから組み立てる
+                auto tail = next;
+                for (auto i = node.min; i < node.max && !tooLarge; ++i) {
+                    tail = AddSplit(Compile(child, tail), next);
+                }
+                next = tail;
+            }
+            for (auto i = 0; i < node.min && !tooLarge; ++i) {
+                next = Compile(child, next);
+            }
+            return next;
+        }
+        case Node::Begin:
+            return Add({NfaState::Begin, 0, 0, next, 0});
+        case Node::End:
+            return Add({NfaState::End, 0, 0, next, 0});
+        }
+        return next;
+    }
+
+    /// 文字クラスを UTF8 のバイト列のトライにする
+    auto CompileClass(const Ranges& ranges, std::uint32_t next) -> std::uint32_t
+    {
+        // トライの辺 (child が 0 なら next へ)
+        struct Edge {
+            std::uint8_t lo;
+            std::uint8_t hi;
+            std::size_t child;
+        };
+        auto trie = std::vector<std::vector<Edge>>(1);
+        auto insert = [&](const std::uint8_t* lo, const std::uint8_t* hi, int units) {
+            auto node = std::size_t {};
+            for (auto i = 0; i < units; ++i) {
+                auto& edges = trie[node];
+                auto last = i + 1 == units;
+                if (!last && !edges.empty() && edges.back().lo == lo[i] && edges.back().hi == hi[i] && edges.back().child) {
+                    node = edges.back().child;
+                    continue;
+                }
+                auto child = last ? std::size_t {} : trie.size();
+                trie[node].push_back({lo[i], hi[i], child});
+                if (!last) trie.emplace_back();
+                node = child;
+            }
+        };
+
+        // サロゲートを除く
+        for (auto& r : ranges) {
+            if (r.last < 0xd800 || 0xdfff < r.first) {
+                SplitUTF8(r.first, r.last, insert);
+                continue;
+            }
+            if (r.first < 0xd800) SplitUTF8(r.first, 0xd7ff, insert);
+            if (0xdfff < r.last) SplitUTF8(0xe000, r.last, insert);
+        }
+
+        // 何にも一致しないクラスは遷移の無いバイトの状態にする
+        if (trie[0].empty()) return Add({NfaState::Byte, 1, 0, next, 0});
+        return CompileTrie(trie, 0, next);
+    }
+
+    template <class Trie>
+    auto CompileTrie(const Trie& trie, std::size_t node, std::uint32_t next) -> std::uint32_t
+    {
+        auto& edges = trie[node];
+        auto entry = std::uint32_t {};
+        for (auto i = edges.size(); i--;) {
+            auto& e = edges[i];
+            auto out = e.child ? CompileTrie(trie, e.child, next) : next;
+            auto state = Add({NfaState::Byte, e.lo, e.hi, out, 0});
+            entry = (i + 1 == edges.size()) ? state : AddSplit(state, entry);
+        }
+        return entry;
+    }
+
+    /// バイトの同値類を求める
+    void MakeClasses()
+    {
+        bool boundary[257] {};
+        for (auto& s : states) {
+            if (s.kind != NfaState::Byte || s.hi < s.lo) continue;
+            boundary[s.lo] = true;
+            boundary[s.hi + 1] = true;
+        }
+        auto id = 0;
+        for (auto b = 0; b < 256; ++b) {
+            if (b && boundary[b]) ++id;
+            classes[b] = std::uint8_t(id);
+        }
+        classCount = std::size_t(id) + 1;
+    }
+};
+
+/// 構文木の先頭のリテラルを集める
+void CollectPrefix(const Node& node, std::string& prefix, bool& done)
+{
+    if (done) return;
+    if (node.kind == Node::Concat) {
+        for (auto& child : node.children) CollectPrefix(child, prefix, done);
+        return;
+    }
+    if (node.kind == Node::Class && node.ranges.size() == 1 && node.ranges[0].first == node.ranges[0].last &&
+        !Unicode::IsSurrogate(node.ranges[0].first)) {
+        std::uint8_t units[4] {};
+        auto n = EncodeUTF8(node.ranges[0].first, units);
+        prefix.append(reinterpret_cast<const char*>(units), std::size_t(n));
+        return;
+    }
+    done = true;
+}
+
+/*
+ *
+ */
+
+/**
+ * @brief 遅延 DFA
+ *
+ * DFA の状態は NFA の状態の集合で、遷移は初めて通る時に求めて表に記録する
+ */
+class Dfa
+{
+public:
+
+    /// 遷移が未計算
+    static constexpr auto Unknown = std::int32_t(-1);
+
+    /**
+     * @param nfa NFA
+     * @param restart 各位置でパターンの開始状態を加える (部分一致)
+     * @param limit 状態数の上限
+     */
+    Dfa(const Nfa& nfa, bool restart, std::size_t limit)
+        : nfa_(nfa), restart_(restart), limit_(std::max(limit, std::size_t(4))), marks_(nfa.states.size())
+    {
+    }
+
+    /// 先頭の状態
+    auto Start() -> std::int32_t
+    {
+        if (start_ == Unknown) start_ = Intern(Closure({}, true, false));
+        return start_;
+    }
+
+    /// 一致の途中でない状態 (部分一致で開始状態だけの集合)
+    auto Restart() -> std::int32_t
+    {
+        if (restartState_ == Unknown) restartState_ = Intern(Closure({}, false, false));
+        return restartState_;
+    }
+
+    /// 遷移する
+    auto Next(std::int32_t s, std::uint8_t byte) -> std::int32_t
+    {
+        auto cls = nfa_.classes[byte];
+        auto& cached = table_[std::size_t(s) * nfa_.classCount + cls];
+        if (cached != Unknown) return cached;
+
+        auto stepped = std::vector<std::uint32_t> {};
+        for (auto i : states_[std::size_t(s)].set) {
+            auto& n = nfa_.states[i];
+            if (n.kind == NfaState::Byte && n.lo <= byte && byte <= n.hi) stepped.push_back(n.out);
+        }
+        auto set = Closure(stepped, false, false);
+        if (states_.size() >= limit_ && !index_.count(set)) {
+            // キャッシュを捨てる (s も無効になるので表には記録しない)
+            Reset();
+            return Intern(std::move(set));
+        }
+        auto t = Intern(std::move(set));
+        table_[std::size_t(s) * nfa_.classCount + cls] = t;
+        return t;
+    }
+
+    /// 遷移先が無く、これ以上一致しないか
+    auto IsDead(std::int32_t s) const noexcept -> bool { return states_[std::size_t(s)].set.empty(); }
+
+    /// この位置で一致したパターン
+    auto Matches(std::int32_t s) const noexcept -> const std::vector<std::uint32_t>&
+    {
+        return states_[std::size_t(s)].matches;
+    }
+
+    /// ここで文字列が終わる場合に一致するパターン (Matches を含む)
+    auto EndMatches(std::int32_t s) -> const std::vector<std::uint32_t>&
+    {
+        auto& state = states_[std::size_t(s)];
+        if (!state.endsReady) {
+            auto ends = std::vector<std::uint32_t> {};
+            for (auto i : state.set) {
+                if (nfa_.states[i].kind == NfaState::End) ends.push_back(i);
+            }
+            auto set = ends.empty() ? std::vector<std::uint32_t> {} : Closure(ends, s == start_, true, false);
+            state.ends = state.matches;
+            for (auto i : set) {
+                if (nfa_.states[i].kind == NfaState::Match) state.ends.push_back(nfa_.states[i].out);
+            }
+            std::sort(state.ends.begin(), state.ends.end());
+            state.ends.erase(std::unique(state.ends.begin(), state.ends.end()), state.ends.end());
+            state.endsReady = true;
+        }
+        return state.ends;
+    }
+
+    /// キャッシュを捨てた回数
+    auto resets() const noexcept -> std::size_t { return resets_; }
+
+private:
+
+    struct State {
+        std::vector<std::uint32_t> set;         // Byte, End, Match の NFA の状態 (昇順)
+        std::vector<std::uint32_t> matches;     // 一致したパターン
+        std::vector<std::uint32_t> ends;        // 末尾で一致するパターン
+        bool endsReady = false;
+    };
+
+    /**
+     * @brief ε 遷移で辿れる状態を集める
+     * @param from 起点
+     * @param atStart 先頭の位置か (^ を通れる)
+     * @param atEnd 末尾の位置か ($ を通れる)
+     * @param restart 部分一致なら各パターンの開始状態も起点にする
+     */
+    auto Closure(std::vector<std::uint32_t> from, bool atStart, bool atEnd, bool restart = true) -> std::vector<std::uint32_t>
+    {
+        if (restart && (restart_ || atStart)) {
+            from.insert(from.end(), nfa_.starts.begin(), nfa_.starts.end());
+        }
+        if (++generation_ == 0) {
+            std::fill(marks_.begin(), marks_.end(), 0);
+            generation_ = 1;
+        }
+        auto set = std::vector<std::uint32_t> {};
+        auto& stack = from;
+        while (!stack.empty()) {
+            auto i = stack.back();
+            stack.pop_back();
+            if (marks_[i] == generation_) continue;
+            marks_[i] = generation_;
+            auto& n = nfa_.states[i];
+            switch (n.kind) {
+            case NfaState::Byte:
+                if (n.lo <= n.hi) set.push_back(i);
+                break;
+            case NfaState::Match:
+                set.push_back(i);
+                break;
+            case NfaState::Split:
+                stack.push_back(n.out1);
+                stack.push_back(n.out);
+                break;
+            case NfaState::Begin:
+                if (atStart) stack.push_back(n.out);
+                break;
+            case NfaState::End:
+                if (atEnd) {
+                    stack.push_back(n.out);
+                } else {
+                    set.push_back(i);
+                }
+                break;
+            }
+        }
+        std::sort(set.begin(), set.end());
+        return set;
+    }
+
+    /// 集合の状態番号を返す 無ければ追加する
+    auto Intern(std::vector<std::uint32_t> set) -> std::int32_t
+    {
+        auto found = index_.find(set);
+        if (found != index_.end()) return found->second;
+
+        auto state = State {};
+        for (auto i : set) {
+            if (nfa_.states[i].kind == NfaState::Match) state.matches.push_back(nfa_.states[i].out);
+        }
+        std::sort(state.matches.begin(), state.matches.end());
+        state.matches.erase(std::unique(state.matches.begin(), state.matches.end()), state.matches.end());
+
+        auto id = std::int32_t(states_.size());
+        index_.emplace(set, id);
+        state.set = std::move(set);
+        states_.push_back(std::move(state));
+        table_.resize(states_.size() * nfa_.classCount, Unknown);
+        return id;
+    }
+
+    /// キャッシュを捨てる
+    void Reset()
+    {
+        states_.clear();
+        table_.clear();
+        index_.clear();
+        start_ = Unknown;
+        restartState_ = Unknown;
+        ++resets_;
+    }
+
+    const Nfa& nfa_;
+    bool restart_;
+    std::size_t limit_;
+
+    std::vector<State> states_;
+    std::vector<std::int32_t> table_;
+    std::map<std::vector<std::uint32_t>, std::int32_t> index_;
+
+    std::int32_t start_ {Unknown};
+    std::int32_t restartState_ {Unknown};
+    std::size_t resets_ {};
+
+    /// Closure の訪問済みの印
+    std::vector<std::uint32_t> marks_;
+    std::uint32_t generation_ {};
+};
+
+} // namespace
+
+/*
+ *
+ */
+
+/// NFA と部分一致用, 全体一致用の DFA
+struct Regex::Machine {
+    Machine(Nfa&& n, std::string&& p, std::size_t cache)
+        : nfa(std::move(n)), prefix(std::move(p)), search(nfa, true, cache), match(nfa, false, cache)
+    {
+    }
+
+    Nfa nfa;
+
+    /// 1パターンの場合の先頭のリテラル
+    std::string prefix;
+
+    Dfa search;
+    Dfa match;
+};
+
+Regex::Regex(Regex&&) noexcept = default;
+Regex& Regex::operator=(Regex&&) noexcept = default;
+Regex::~Regex() = default;
+
+Regex::Regex(std::string_view pattern, std::size_t cache)
+    : Regex(&pattern, 1, cache)
+{
+}
+
+Regex::Regex(const std::string_view* patterns, std::size_t count, std::size_t cache)
+{
+    auto nfa = Nfa {};
+    auto prefix = std::string {};
+    for (auto i = std::size_t {}; i < count; ++i) {
+        auto node = Node {};
+        auto parser = Parser(patterns[i]);
+        if (!parser.Parse(node)) {
+            error_ = "pattern " + std::to_string(i) + ": " + parser.error();
+            return;
+        }
+        auto match = nfa.Add({NfaState::Match, 0, 0, std::uint32_t(i), 0});
+        nfa.starts.push_back(nfa.Compile(node, match));
+        if (nfa.tooLarge) {
+            error_ = "pattern " + std::to_string(i) + ": too large";
+            return;
+        }
+        if (count == 1) {
+            auto done = false;
+            CollectPrefix(node, prefix, done);
+        }
+    }
+    nfa.MakeClasses();
+    machine_ = std::make_unique<Machine>(std::move(nfa), std::move(prefix), cache);
+}
+
+Regex::Regex(Views, const std::vector<std::string_view>& patterns, std::size_t cache)
+    : Regex(patterns.data(), patterns.size(), cache)
+{
+}
+
+auto Regex::size() const noexcept -> std::size_t
+{
+    return machine_ ? machine_->nfa.starts.size() : 0;
+}
+
+auto Regex::Match(std::string_view text) -> bool
+{
+    if (!machine_) return false;
+    auto& dfa = machine_->match;
+    auto s = dfa.Start();
+    for (auto c : text) {
+        s = dfa.Next(s, std::uint8_t(c));
+        if (dfa.IsDead(s)) return false;
+    }
+    return !dfa.EndMatches(s).empty();
+}
+
+auto Regex::Search(std::string_view text) -> bool
+{
+    if (!machine_) return false;
+    auto& dfa = machine_->search;
+    auto& prefix = machine_->prefix;
+    auto s = dfa.Start();
+    if (!dfa.Matches(s).empty()) return true;
+
+    for (auto i = std::size_t {}; i < text.size();) {
+        // 一致の途中でなければリテラルの位置まで読み飛ばす
+        if (!prefix.empty() && s == dfa.Restart()) {
+            i = Find(text, prefix, i);
+            if (i == std::string_view::npos) break;
+        }
+        s = dfa.Next(s, std::uint8_t(text[i++]));
+        if (!dfa.Matches(s).empty()) return true;
+        if (dfa.IsDead(s)) return false;
+    }
+    return !dfa.EndMatches(s).empty();
+}
+
+auto Regex::SearchAll(std::string_view text, std::vector<std::size_t>& matched) -> bool
+{
+    matched.clear();
+    if (!machine_) return false;
+    auto& dfa = machine_->search;
+    auto found = std::vector<bool>(size());
+    auto remain = size();
+    auto add = [&](const std::vector<std::uint32_t>& ids) {
+        for (auto id : ids) {
+            if (!found[id]) {
+                found[id] = true;
+                --remain;
+            }
+        }
+    };
+
+    auto s = dfa.Start();
+    add(dfa.Matches(s));
+    for (auto i = std::size_t {}; i < text.size() && remain && !dfa.IsDead(s); ++i) {
+        s = dfa.Next(s, std::uint8_t(text[i]));
+        add(dfa.Matches(s));
+    }
+    if (remain) add(dfa.EndMatches(s));
+
+    for (auto i = std::size_t {}; i < found.size(); ++i) {
+        if (found[i]) matched.push_back(i);
+    }
+    return !matched.empty();
+}
+
+auto Regex::GetCacheResets() const noexcept -> std::size_t
+{
+    return machine_ ? machine_->search.resets() + machine_->match.resets() : 0;
+}
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,156 @@
+﻿/**
+ * @brief UTF8 のバイト列を直接照合する DFA の正規表現
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_REGEX_HPP_
+#define PITS_REGEX_HPP_
+
+#include <cstddef>      // size_t
+#include <iterator>     // begin end data
+#include <memory>       // unique_ptr
+#include <string>
+#include <string_view>
+#include <utility>      // declval
+#include <vector>
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ * 正規表現
+ *
+ * 文字クラスは UTF8 のバイト列のオートマトンにして NFA を作り、照合時に必要な DFA の状態だけを作る (遅延 DFA)
+ * DFA の状態数が上限に達したらキャッシュを捨てて作り直すので、メモリ使用量は上限で抑えられる
+ * 照合は1バイトずつ表を引くだけで、バックトラックはしない
+ *
+ * 複数のパターンを1つの DFA にまとめ、入力を1回走査してどのパターンが一致したか求められる
+ * パターンが1つで先頭がリテラルの場合、一致の途中でない間は Find (SIMD) でリテラルの位置まで読み飛ばす
+ *
+ * 構文 (部分一致や位置は扱わず、一致するかだけを求める)
+ * - リテラル, .(改行以外), [...], [^...], (...), (?:...), |
+ * - *, +, ?, {n}, {n,}, {n,m} (最短一致の ? は受け付けるが結果は変わらない)
+ * - ^ (先頭), $ (末尾)
+ * - \d \D \w \W \s \S (ASCII の範囲), \n \t \r \f \v, \xHH, \x{HHHHHH}, \uHHHH
+ * - \p{...} \P{...} 一般カテゴリの短縮名 (L, Lu, Nd 等), 用字 (Han, Hiragana 等), Any
+ *
+ * 繰り返しは {1000} まで、括弧の入れ子は 200 段まで、NFA の状態数は全パターンで 4M まで (超えると誤り)
+ * 不正なシーケンスはどの文字クラスにも一致しない
+ * DFA のキャッシュを更新するので、同じオブジェクトを複数のスレッドで同時に使わない事
+ */
+
+/**
+ * @brief UTF8 の正規表現 (複数パターン可)
+ */
+class Regex
+{
+public:
+
+    /// DFA の状態数の既定の上限
+    static constexpr auto DefaultCache = std::size_t(1024);
+
+    Regex(const Regex&) = delete;
+    Regex& operator=(const Regex&) = delete;
+    Regex(Regex&&) noexcept;
+    Regex& operator=(Regex&&) noexcept;
+    ~Regex();
+
+    /**
+     * @brief パターンを翻訳する
+     * @param pattern UTF8 のパターン
+     * @param cache DFA の状態数の上限
+     */
+    explicit Regex(std::string_view pattern, std::size_t cache = DefaultCache);
+
+    /**
+     * @brief 複数のパターンを1つの DFA に翻訳する
+     * @param patterns UTF8 のパターンの配列
+     * @param count パターン数
+     * @param cache DFA の状態数の上限
+     */
+    Regex(const std::string_view* patterns, std::size_t count, std::size_t cache = DefaultCache);
+
+    /**
+     * @brief パターンのコンテナから翻訳する
+     * @param patterns std::vector<std::string> 等
+     * @param cache DFA の状態数の上限
+     */
+    template <class Patterns, class = decltype(std::string_view(*std::data(std::declval<const Patterns&>())))>
+    explicit Regex(const Patterns& patterns, std::size_t cache = DefaultCache)
+        : Regex(Views {}, std::vector<std::string_view>(std::begin(patterns), std::end(patterns)), cache)
+    {
+    }
+
+    /// 翻訳の誤り 無ければ空
+    auto error() const noexcept -> const std::string& { return error_; }
+
+    /// パターン数を返す
+    auto size() const noexcept -> std::size_t;
+
+    /**
+     * @brief 文字列全体がいずれかのパターンに一致するか返す
+     * @param text UTF8 文字列
+     * @return 一致したか (翻訳に失敗していれば偽)
+     */
+    auto Match(std::string_view text) -> bool;
+
+    /**
+     * @brief 文字列の一部がいずれかのパターンに一致するか返す
+     *
+     * 最初に一致した所で走査を終える
+     *
+     * @param text UTF8 文字列
+     * @return 一致したか (翻訳に失敗していれば偽)
+     */
+    auto Search(std::string_view text) -> bool;
+
+    /**
+     * @brief 文字列の一部に一致したパターンを全て返す
+     *
+     * 全てのパターンが一致するか入力の末尾まで1回だけ走査する
+     *
+     * @param text UTF8 文字列
+     * @param matched 一致したパターンの添字 (昇順)
+     * @return 一致したパターンが有るか
+     */
+    auto SearchAll(std::string_view text, std::vector<std::size_t>& matched) -> bool;
+
+    /// DFA のキャッシュを捨てた回数を返す (上限の調整用)
+    auto GetCacheResets() const noexcept -> std::size_t;
+
+private:
+
+    /// コンテナから変換したパターンの区別
+    struct Views {};
+
+    /// コンテナから変換したパターンを翻訳する
+    Regex(Views, const std::vector<std::string_view>& patterns, std::size_t cache);
+
+    struct Machine;
+
+    /// NFA と DFA
+    std::unique_ptr<Machine> machine_;
+
+    /// 翻訳の誤り
+    std::string error_;
+};
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
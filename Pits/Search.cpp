@@ -0,0 +1,254 @@
+﻿/**
+ * @brief 文字の境界を守る UTF8 の検索
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/Search.hpp"
+#include "Pits/CaseFold.hpp"
+#include "Pits/Encoding.hpp"
+#include <algorithm>    // find
+#include <cstdint>      // uint64_t
+#include <cstring>      // memcmp
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+namespace {
+
+using EncodingImplement::CountTrailingZeros;
+
+constexpr auto npos = std::string_view::npos;
+
+/// 符号無しのバイト値
+constexpr auto Byte(char c) noexcept -> unsigned
+{
+    return static_cast<unsigned char>(c);
+}
+
+/// UTF8 後続データか
+constexpr auto IsFollow(char c) noexcept -> bool
+{
+    return (Byte(c) & 0xc0) == 0x80;
+}
+
+/// 末尾の文字が途中で切れているか
+auto IsTruncated(std::string_view pattern) noexcept -> bool
+{
+    // 最後の先頭データから必要な長さを求める
+    auto n = pattern.size();
+    auto i = n;
+    while (i && IsFollow(pattern[i - 1]) && n - i < 3) --i;
+    if (!i) return false;
+    auto lead = Byte(pattern[i - 1]);
+    auto need = std::size_t(lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1);
+    return n - (i - 1) < need;
+}
+
+/// 単純畳み込み ASCII はテーブルを引かない
+inline auto Fold(char32_t c) noexcept -> char32_t
+{
+    if (c < 0x80) return (U'A' <= c && c <= U'Z') ? c + 0x20 : c;
+    return Unicode::SimpleCaseFold(c);
+}
+
+/**
+ * @brief バイト列を検索する
+ * @param begin 文字列の先頭
+ * @param it 検索の開始位置
+ * @param end 文字列の末尾
+ * @param pattern パターン 空ではなく、先頭は先頭データである事
+ * @return 位置 無ければ npos
+ */
+auto FindUnits(const char* begin, const char* it, const char* end, std::string_view pattern) noexcept -> std::size_t
+{
+    auto p = pattern.data();
+    auto last = pattern.size() - 1;
+    auto truncated = IsTruncated(pattern);
+
+    // 先頭と末尾のバイトが一致した候補の残りを比較し、末尾が文字の途中でないか確かめる
+    auto accept = [&](const char* q) {
+        return std::memcmp(q + 1, p + 1, last) == 0 && (!truncated || q + last + 1 == end || !IsFollow(q[last + 1]));
+    };
+
+#ifdef PITS_ENCODING_SSE2
+    // 16 箇所の先頭と末尾のバイトを同時に比べる
+    auto first = _mm_set1_epi8(p[0]);
+    auto tail = _mm_set1_epi8(p[last]);
+    for (; std::size_t(end - it) >= last + 16; it += 16) {
+        auto a = _mm_cmpeq_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(it)));
+        auto b = _mm_cmpeq_epi8(tail, _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + last)));
+        for (auto mask = unsigned(_mm_movemask_epi8(_mm_and_si128(a, b))); mask; mask &= mask - 1) {
+            auto q = it + CountTrailingZeros(mask);
+            if (accept(q)) return std::size_t(q - begin);
+        }
+    }
+#endif
+    for (; std::size_t(end - it) > last; ++it) {
+        if (it[0] == p[0] && it[last] == p[last] && accept(it)) return std::size_t(it - begin);
+    }
+    return npos;
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto Find(std::string_view text, char32_t c, std::size_t pos) noexcept -> std::size_t
+{
+    if (pos >= text.size() || Unicode::IsUnsafeCharacter(c)) return npos;
+    char units[4] {};
+    auto end = std::get<1>(Unicode::ConvertUTF32ToUTF8(&c, units));
+    auto begin = text.data();
+    return FindUnits(begin, begin + pos, begin + text.size(), std::string_view(units, std::size_t(end - units)));
+}
+
+auto FindAnyOf(std::string_view text, std::u32string_view set, std::size_t pos) noexcept -> std::size_t
+{
+    if (pos >= text.size()) return npos;
+
+    // 集合の文字の先頭バイトの表と、先頭バイトの種類
+    constexpr auto lanes = 8;
+    std::uint64_t leads[4] {};
+    char firsts[lanes] {};
+    auto count = 0;
+    for (auto c : set) {
+        if (Unicode::IsUnsafeCharacter(c)) continue;
+        char units[4] {};
+        Unicode::ConvertUTF32ToUTF8(&c, units);
+        auto b = Byte(units[0]);
+        if (leads[b / 64] & (std::uint64_t(1) << (b % 64))) continue;
+        leads[b / 64] |= std::uint64_t(1) << (b % 64);
+        if (count < lanes) firsts[count] = units[0];
+        ++count;
+    }
+    if (!count) return npos;
+
+    auto begin = text.data();
+    auto end = begin + text.size();
+
+    // 候補の文字が集合に含まれるか (不正なシーケンスの置換文字は含めない)
+    auto contains = [&](const char* q) {
+        if (!(Byte(*q) & 0x80)) return true;
+        auto it = q;
+        auto c = NextPoint(it, end);
+        if (c == Unicode::ReplacementCharacter && std::string_view(q, std::size_t(it - q)) != "\xef\xbf\xbd") {
+            return false;
+        }
+        return std::find(set.begin(), set.end(), c) != set.end();
+    };
+
+    auto it = begin + pos;
+#ifdef PITS_ENCODING_SSE2
+    if (count <= lanes) {
+        __m128i vs[lanes];
+        for (auto i = 0; i < count; ++i) vs[i] = _mm_set1_epi8(firsts[i]);
+        for (; end - it >= 16; it += 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            auto m = _mm_cmpeq_epi8(v, vs[0]);
+            for (auto i = 1; i < count; ++i) m = _mm_or_si128(m, _mm_cmpeq_epi8(v, vs[i]));
+            for (auto mask = unsigned(_mm_movemask_epi8(m)); mask; mask &= mask - 1) {
+                auto q = it + CountTrailingZeros(mask);
+                if (contains(q)) return std::size_t(q - begin);
+            }
+        }
+    }
+#endif
+    for (; it != end; ++it) {
+        auto b = Byte(*it);
+        if ((leads[b / 64] & (std::uint64_t(1) << (b % 64))) && contains(it)) return std::size_t(it - begin);
+    }
+    return npos;
+}
+
+auto Find(std::string_view text, std::string_view pattern, std::size_t pos) noexcept -> std::size_t
+{
+    if (pos > text.size()) return npos;
+    if (pattern.empty()) return pos;
+    if (IsFollow(pattern[0]) || pattern.size() > text.size() - pos) return npos;
+    auto begin = text.data();
+    return FindUnits(begin, begin + pos, begin + text.size(), pattern);
+}
+
+auto FindCaseless(std::string_view text, std::string_view pattern, std::size_t pos) noexcept -> TextMatch
+{
+    if (pos > text.size()) return {npos, 0};
+    if (pattern.empty()) return {pos, 0};
+
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto pend = pattern.data() + pattern.size();
+    auto pit = pattern.data();
+    auto first = Fold(NextPoint(pit, pend));
+
+    // q から1文字ずつ畳み込んで比較し、一致した末尾を返す
+    auto match = [&](const char* q) -> const char* {
+        auto p = pattern.data();
+        while (p != pend) {
+            if (q == end || Fold(NextPoint(q, end)) != Fold(NextPoint(p, pend))) return nullptr;
+        }
+        return q;
+    };
+
+    auto it = begin + pos;
+    if (first < 0x80) {
+        // 候補は大文字と小文字の ASCII と、ASCII に畳み込まれ得る2バイト以上の文字の先頭
+        auto lower = char(first);
+        auto upper = (U'a' <= first && first <= U'z') ? char(first - 0x20) : lower;
+        auto candidate = [&](const char* q) -> TextMatch {
+            auto e = match(q);
+            return e ? TextMatch {std::size_t(q - begin), std::size_t(e - q)} : TextMatch {npos, 0};
+        };
+#ifdef PITS_ENCODING_SSE2
+        auto vl = _mm_set1_epi8(lower);
+        auto vu = _mm_set1_epi8(upper);
+        auto vm = _mm_set1_epi8(char(0xc2));
+        for (; end - it >= 16; it += 16) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            auto m = _mm_or_si128(_mm_cmpeq_epi8(v, vl), _mm_cmpeq_epi8(v, vu));
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_max_epu8(v, vm), v));
+            for (auto mask = unsigned(_mm_movemask_epi8(m)); mask; mask &= mask - 1) {
+                auto found = candidate(it + CountTrailingZeros(mask));
+                if (found.position != npos) return found;
+            }
+        }
+#endif
+        for (; it != end; ++it) {
+            if (*it == lower || *it == upper || Byte(*it) >= 0xc2) {
+                auto found = candidate(it);
+                if (found.position != npos) return found;
+            }
+        }
+        return {npos, 0};
+    }
+
+    // ASCII 以外で始まるパターンは ASCII を読み飛ばして1文字ずつ比較する
+    while (it != end) {
+        it = EncodingImplement::SkipASCII(it, end);
+        if (it == end) break;
+        auto q = it;
+        if (Fold(NextPoint(it, end)) == first) {
+            if (auto e = match(q)) return {std::size_t(q - begin), std::size_t(e - q)};
+        }
+    }
+    return {npos, 0};
+}
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,98 @@
+﻿/**
+ * @brief 文字の境界を守る UTF8 の検索
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_SEARCH_HPP_
+#define PITS_SEARCH_HPP_
+
+#include <cstddef>      // size_t
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ * UTF8 の検索
+ *
+ * std::string_view::find と異なり、文字の途中から始まる一致や文字の途中で終わる一致は返さない
+ * (例えば "\x81\x82" は "あ" の中に有っても見つからない)
+ * 位置はコードユニット単位で、見つからなければ std::string_view::npos を返す
+ *
+ * SSE2 が使える場合は 16 バイト毎に先頭バイト (部分文字列は先頭と末尾のバイト) で候補を絞り、
+ * 候補の位置だけを比較する
+ */
+
+/// 大文字小文字を区別しない検索の一致
+struct TextMatch {
+    std::size_t position;   // 位置 (コードユニット単位) 見つからなければ npos
+    std::size_t length;     // 一致した長さ (コードユニット単位) パターンの長さと異なる事が有る
+};
+
+/**
+ * @brief 文字を検索する
+ * @param text UTF8 文字列
+ * @param c 文字 サロゲート等の不正な値は見つからない
+ * @param pos 検索の開始位置
+ * @return 位置 無ければ npos
+ */
+auto Find(std::string_view text, char32_t c, std::size_t pos = 0) noexcept -> std::size_t;
+
+/**
+ * @brief 文字の集合のいずれかを検索する
+ *
+ * 集合の文字の先頭バイトが 8 種類以下なら SIMD で絞り込む
+ *
+ * @param text UTF8 文字列
+ * @param set 文字の集合
+ * @param pos 検索の開始位置
+ * @return 最初に見つかった位置 無ければ npos
+ */
+auto FindAnyOf(std::string_view text, std::u32string_view set, std::size_t pos = 0) noexcept -> std::size_t;
+
+/**
+ * @brief 部分文字列を検索する
+ *
+ * 先頭が後続データのパターンは見つからない
+ * 末尾の文字が途中で切れているパターンは、文字の途中で終わる位置では見つからない
+ *
+ * @param text UTF8 文字列
+ * @param pattern UTF8 文字列 空なら pos を返す
+ * @param pos 検索の開始位置
+ * @return 位置 無ければ npos
+ */
+auto Find(std::string_view text, std::string_view pattern, std::size_t pos = 0) noexcept -> std::size_t;
+
+/**
+ * @brief 大文字小文字を区別せずに部分文字列を検索する
+ *
+ * 1文字ずつ単純畳み込み (Simple_Case_Folding) して比較する
+ * K (U+212A KELVIN SIGN) と k の様に UTF8 の長さが異なる文字も一致する
+ * 不正なシーケンスは置換文字として比較する
+ *
+ * @param text UTF8 文字列
+ * @param pattern UTF8 文字列 空なら {pos, 0} を返す
+ * @param pos 検索の開始位置
+ * @return 一致した範囲 無ければ {npos, 0}
+ */
+auto FindCaseless(std::string_view text, std::string_view pattern, std::size_t pos = 0) noexcept -> TextMatch;
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
@@ -6,16 +6,497 @@
 
 #include "Pits/StringStream.hpp"
 
+#include "Pits/Timer.hpp"
+
+#include <algorithm>    // max
+#include <condition_variable>
+#include <cstdio>       // FILE fopen fwrite
+#include <deque>
+#include <mutex>
+#include <thread>
+
 /*
  *
  */
 
 namespace Pits {
+namespace StringStreamImplement {
+
+/*
+ *
+ */
+
+namespace {
+
+/**
+ * @brief 非公開メンバへのポインタを GetMember(Tag) で返す
+ *
+ * 明示的実体化のテンプレート引数はアクセス制御を受けない事を使う
+ * GetMember は実体化する Tag 毎に名前空間で宣言しておく
+ */
+template <class Tag, typename Tag::type Member>
+struct MemberAccess
+{
+    friend auto GetMember(Tag) -> typename Tag::type { return Member; }
+};
+
+/// basic_stringbuf が所有する文字列
+template <class Char>
+struct StringMember
+{
+    using type = std::basic_string<Char> std::basic_stringbuf<Char>::*;
+};
+
+auto GetMember(StringMember<char>) -> StringMember<char>::type;
+auto GetMember(StringMember<wchar_t>) -> StringMember<wchar_t>::type;
+auto GetMember(StringMember<char16_t>) -> StringMember<char16_t>::type;
+auto GetMember(StringMember<char32_t>) -> StringMember<char32_t>::type;
+
+/**
+ * @brief basic_stringbuf のプロテクトへアクセスするだけの継承クラス
+ */
+template <class Char>
+class BufferAccess : public std::basic_stringbuf<Char>
+{
+    // ユーティリティクラスでしかないので作成不可にする
+    BufferAccess() = delete;
+
+public:
+
+    /// 書き込んだ最も後ろの位置までの長さ 書き込み領域が無ければ -1
+    static auto HighMark(std::basic_stringbuf<Char>* sbuf) noexcept -> std::ptrdiff_t
+    {
+        auto p = static_cast<BufferAccess*>(sbuf);
+        if (!p->pptr()) return -1;
+        auto hi = (p->egptr() && p->egptr() > p->pptr()) ? p->egptr() : p->pptr();
+        return hi - p->pbase();
+    }
+
+#if defined(__GLIBCXX__)
+    /// 所有する文字列に合わせてポインタを設定し直す
+    static void Initialize(std::basic_stringbuf<Char>* sbuf)
+    {
+        auto p = static_cast<BufferAccess*>(sbuf);
+        p->_M_stringbuf_init(p->_M_mode);
+    }
+#endif
+};
+
+#if defined(__GLIBCXX__) && _GLIBCXX_USE_CXX11_ABI
+
+// libstdc++ は確保済みの領域へ長さを変えずに書き込むので、取り出す時に長さを埋めずに設定する
+#define PITS_STRINGSTREAM_MOVABLE 1
+
+/// basic_string の長さの設定
+template <class Char>
+struct SetLengthMember
+{
+    using type = void (std::basic_string<Char>::*)(typename std::basic_string<Char>::size_type);
+};
+
+auto GetMember(SetLengthMember<char>) -> SetLengthMember<char>::type;
+auto GetMember(SetLengthMember<wchar_t>) -> SetLengthMember<wchar_t>::type;
+auto GetMember(SetLengthMember<char16_t>) -> SetLengthMember<char16_t>::type;
+auto GetMember(SetLengthMember<char32_t>) -> SetLengthMember<char32_t>::type;
+
+template struct MemberAccess<StringMember<char>, &std::basic_stringbuf<char>::_M_string>;
+template struct MemberAccess<StringMember<wchar_t>, &std::basic_stringbuf<wchar_t>::_M_string>;
+template struct MemberAccess<StringMember<char16_t>, &std::basic_stringbuf<char16_t>::_M_string>;
+template struct MemberAccess<StringMember<char32_t>, &std::basic_stringbuf<char32_t>::_M_string>;
+template struct MemberAccess<SetLengthMember<char>, &std::basic_string<char>::_M_set_length>;
+template struct MemberAccess<SetLengthMember<wchar_t>, &std::basic_string<wchar_t>::_M_set_length>;
+template struct MemberAccess<SetLengthMember<char16_t>, &std::basic_string<char16_t>::_M_set_length>;
+template struct MemberAccess<SetLengthMember<char32_t>, &std::basic_string<char32_t>::_M_set_length>;
+
+/// 書き込んだ範囲を所有する文字列の長さにする
+template <class Char>
+void SetLength(std::basic_stringbuf<Char>* sbuf, std::basic_string<Char>& s)
+{
+    auto hi = BufferAccess<Char>::HighMark(sbuf);
+    if (hi >= 0) (s.*GetMember(SetLengthMember<Char>()))(std::size_t(hi));
+}
+
+/// 所有する文字列に合わせてポインタを設定し直す
+template <class Char>
+void Initialize(std::basic_stringbuf<Char>* sbuf, std::basic_string<Char>&)
+{
+    BufferAccess<Char>::Initialize(sbuf);
+}
+
+#elif defined(_LIBCPP_VERSION)
+
+// libc++ は文字列を確保済みの長さまで伸ばして書き込むので、取り出す時に縮める
+#define PITS_STRINGSTREAM_MOVABLE 1
+
+/// 書き込んだ最も後ろの位置
+template <class Char>
+struct HighMarkMember
+{
+    using type = Char* std::basic_stringbuf<Char>::*;
+};
+
+auto GetMember(HighMarkMember<char>) -> HighMarkMember<char>::type;
+auto GetMember(HighMarkMember<wchar_t>) -> HighMarkMember<wchar_t>::type;
+auto GetMember(HighMarkMember<char16_t>) -> HighMarkMember<char16_t>::type;
+auto GetMember(HighMarkMember<char32_t>) -> HighMarkMember<char32_t>::type;
+
+template struct MemberAccess<StringMember<char>, &std::basic_stringbuf<char>::__str_>;
+template struct MemberAccess<StringMember<wchar_t>, &std::basic_stringbuf<wchar_t>::__str_>;
+template struct MemberAccess<StringMember<char16_t>, &std::basic_stringbuf<char16_t>::__str_>;
+template struct MemberAccess<StringMember<char32_t>, &std::basic_stringbuf<char32_t>::__str_>;
+template struct MemberAccess<HighMarkMember<char>, &std::basic_stringbuf<char>::__hm_>;
+template struct MemberAccess<HighMarkMember<wchar_t>, &std::basic_stringbuf<wchar_t>::__hm_>;
+template struct MemberAccess<HighMarkMember<char16_t>, &std::basic_stringbuf<char16_t>::__hm_>;
+template struct MemberAccess<HighMarkMember<char32_t>, &std::basic_stringbuf<char32_t>::__hm_>;
+
+template <class Char>
+void SetLength(std::basic_stringbuf<Char>* sbuf, std::basic_string<Char>& s)
+{
+    auto hi = BufferAccess<Char>::HighMark(sbuf);
+    if (hi < 0) return;
+    if (auto mark = sbuf->*GetMember(HighMarkMember<Char>())) {
+        hi = std::max(hi, mark - s.data());
+    }
+    s.resize(std::size_t(hi));
+}
+
+/// 自身を渡すと代入は何もせずポインタだけ設定し直す
+template <class Char>
+void Initialize(std::basic_stringbuf<Char>* sbuf, std::basic_string<Char>& s)
+{
+    sbuf->str(s);
+}
+
+#endif
+
+template <class Char>
+auto Release(std::basic_stringbuf<Char>* sbuf) -> std::basic_string<Char>
+{
+#ifdef PITS_STRINGSTREAM_MOVABLE
+    auto& s = sbuf->*GetMember(StringMember<Char>());
+    SetLength(sbuf, s);
+    auto out = std::move(s);
+    s.clear();
+    Initialize(sbuf, s);
+    return out;
+#else
+    auto out = sbuf->str();
+    sbuf->str(std::basic_string<Char>());
+    return out;
+#endif
+}
+
+template <class Char>
+void Adopt(std::basic_stringbuf<Char>* sbuf, std::basic_string<Char>&& from)
+{
+#ifdef PITS_STRINGSTREAM_MOVABLE
+    auto& s = sbuf->*GetMember(StringMember<Char>());
+    s = std::move(from);
+    Initialize(sbuf, s);
+#else
+    sbuf->str(from);
+#endif
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto ReleaseString(std::basic_stringbuf<char>* sbuf) -> std::basic_string<char>
+{
+    return Release(sbuf);
+}
+
+auto ReleaseString(std::basic_stringbuf<wchar_t>* sbuf) -> std::basic_string<wchar_t>
+{
+    return Release(sbuf);
+}
+
+auto ReleaseString(std::basic_stringbuf<char16_t>* sbuf) -> std::basic_string<char16_t>
+{
+    return Release(sbuf);
+}
+
+auto ReleaseString(std::basic_stringbuf<char32_t>* sbuf) -> std::basic_string<char32_t>
+{
+    return Release(sbuf);
+}
+
+void AdoptString(std::basic_stringbuf<char>* sbuf, std::basic_string<char>&& s)
+{
+    Adopt(sbuf, std::move(s));
+}
+
+void AdoptString(std::basic_stringbuf<wchar_t>* sbuf, std::basic_string<wchar_t>&& s)
+{
+    Adopt(sbuf, std::move(s));
+}
+
+void AdoptString(std::basic_stringbuf<char16_t>* sbuf, std::basic_string<char16_t>&& s)
+{
+    Adopt(sbuf, std::move(s));
+}
+
+void AdoptString(std::basic_stringbuf<char32_t>* sbuf, std::basic_string<char32_t>&& s)
+{
+    Adopt(sbuf, std::move(s));
+}
 
 /*
  *
  */
 
+} // namespace StringStreamImplement
+
+/*
+ *
+ */
+
+/**
+ * @brief 書き込むスレッドと書き出しスレッドで共有するバッファとファイル
+ */
+class AsyncFileStreamBuf::Writer
+{
+public:
+
+    Writer(const char* path, BacklogPolicy policy, std::size_t bufferBytes, std::size_t buffers)
+        : policy_(policy), bufferBytes_(std::max(bufferBytes, std::size_t(1)))
+    {
+        file_ = std::fopen(path, "wb");
+        if (!file_) {
+            error_ = std::string("cannot open ") + path;
+            return;
+        }
+        // バッファ毎に1回の write にする
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+
+        buffers = std::max(buffers, std::size_t(2));
+        for (auto i = std::size_t {}; i != buffers; ++i) {
+            buffers_.emplace_back(new char[bufferBytes_]);
+            free_.push_back(buffers - 1 - i);
+        }
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    ~Writer() { Close(); }
+
+    auto IsOpen() const noexcept -> bool { return file_ != nullptr; }
+
+    auto Buffer(std::size_t index) const noexcept -> char* { return buffers_[index].get(); }
+    auto BufferBytes() const noexcept -> std::size_t { return bufferBytes_; }
+
+    /// 書き込みに使うバッファを取り出す
+    auto Take() -> std::size_t
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto index = free_.back();
+        free_.pop_back();
+        return index;
+    }
+
+    /**
+     * @brief 書き込んだバッファを書き出しスレッドへ渡し、次に書き込むバッファを返す
+     * @param index 書き込んだバッファ
+     * @param size 書き込んだバイト数
+     * @return 次に書き込むバッファ 捨てた場合と空の場合は index
+     */
+    auto Submit(std::size_t index, std::size_t size) -> std::size_t
+    {
+        if (!size) return index;
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            if (policy_ == BacklogPolicy::Drop) {
+                statistics_.dropped += size;
+                return index;
+            }
+            ++statistics_.blocked;
+            freed_.wait(lock, [&] { return !free_.empty(); });
+        }
+        full_.emplace_back(index, size);
+        wake_.notify_one();
+        auto next = free_.back();
+        free_.pop_back();
+        return next;
+    }
+
+    /**
+     * @brief 空いているバッファが2つ以上あれば書き込んだバッファを書き出しスレッドへ渡す
+     *
+     * 一杯になった時の為に空いているバッファを1つ残す 残せなければ待たず捨てもしない
+     *
+     * @param index 書き込んだバッファ 渡せた場合は次に書き込むバッファにする
+     * @param size 書き込んだバイト数
+     * @return 渡せたか
+     */
+    auto TrySubmit(std::size_t& index, std::size_t size) -> bool
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!size || free_.size() < 2) return false;
+        full_.emplace_back(index, size);
+        wake_.notify_one();
+        index = free_.back();
+        free_.pop_back();
+        return true;
+    }
+
+    /**
+     * @brief 書き出し待ちを全て書き出して閉じる
+     *
+     * 最後のバッファは BacklogPolicy に関わらず捨てずに書き出し待ちへ加える
+     *
+     * @param index 最後に書き込んだバッファ
+     * @param size 書き込んだバイト数
+     * @return 全て書き出せたか
+     */
+    auto Close(std::size_t index = 0, std::size_t size = 0) -> bool
+    {
+        if (!file_) return error_.empty();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size) full_.emplace_back(index, size);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+        if (std::fclose(file_) != 0 && error_.empty()) error_ = "close failed";
+        file_ = nullptr;
+        return error_.empty();
+    }
+
+    auto Error() const -> std::string
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+    auto GetStatistics() const -> AsyncSinkStatistics
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return statistics_;
+    }
+
+private:
+
+    /// 書き出しスレッド
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stop_ || !full_.empty(); });
+            if (full_.empty()) return;
+            auto [index, size] = full_.front();
+            full_.pop_front();
+
+            lock.unlock();
+            Timer timer;
+            auto written = std::fwrite(buffers_[index].get(), 1, size, file_);
+            auto elapsed = timer.GetElapsed();
+            lock.lock();
+
+            if (written != size && error_.empty()) error_ = "write failed";
+            ++statistics_.flushes;
+            statistics_.bytes += written;
+            statistics_.lastFlushSeconds = elapsed;
+            statistics_.maxFlushSeconds = std::max(statistics_.maxFlushSeconds, elapsed);
+            statistics_.totalFlushSeconds += elapsed;
+            free_.push_back(index);
+            freed_.notify_one();
+        }
+    }
+
+    std::FILE* file_ = nullptr;
+    BacklogPolicy policy_;
+    std::size_t bufferBytes_;
+    std::vector<std::unique_ptr<char[]>> buffers_;
+
+    /// 以下は mutex_ で守る
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;      // 書き出し待ちが増えた, 止める
+    std::condition_variable freed_;     // バッファが空いた
+    std::vector<std::size_t> free_;     // 空いているバッファ
+    std::deque<std::pair<std::size_t, std::size_t>> full_;  // 書き出し待ち (バッファ, バイト数)
+    bool stop_ = false;
+    std::string error_;
+    AsyncSinkStatistics statistics_ {};
+
+    std::thread thread_;
+};
+
+/*
+ *
+ */
+
+AsyncFileStreamBuf::AsyncFileStreamBuf(const char* path, BacklogPolicy policy, std::size_t bufferBytes, std::size_t buffers)
+    : writer_(std::make_unique<Writer>(path, policy, bufferBytes, buffers))
+{
+    if (writer_->IsOpen()) {
+        current_ = writer_->Take();
+        auto data = writer_->Buffer(current_);
+        setp(data, data + writer_->BufferBytes());
+    }
+}
+
+AsyncFileStreamBuf::~AsyncFileStreamBuf()
+{
+    close();
+}
+
+auto AsyncFileStreamBuf::is_open() const noexcept -> bool
+{
+    return writer_->IsOpen();
+}
+
+auto AsyncFileStreamBuf::error() const -> std::string
+{
+    return writer_->Error();
+}
+
+auto AsyncFileStreamBuf::close() -> bool
+{
+    if (!writer_->IsOpen()) return writer_->Error().empty();
+    auto size = std::size_t(pptr() - pbase());
+    setp(nullptr, nullptr);
+    return writer_->Close(current_, size);
+}
+
+auto AsyncFileStreamBuf::GetStatistics() const -> AsyncSinkStatistics
+{
+    return writer_->GetStatistics();
+}
+
+auto AsyncFileStreamBuf::overflow(int_type c) -> int_type
+{
+    if (!writer_->IsOpen() || !Handoff()) return traits_type::eof();
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+}
+
+auto AsyncFileStreamBuf::sync() -> int
+{
+    if (!writer_->IsOpen()) return -1;
+
+    // 少ししか書き込んでいないバッファは渡さずに書き込み続け、書き出しを大きな単位に保つ
+    // 渡す場合も BacklogPolicy は使わず、一杯になった時の為に空いているバッファを1つ残す
+    auto size = std::size_t(pptr() - pbase());
+    if (size * 2 >= writer_->BufferBytes() && writer_->TrySubmit(current_, size)) {
+        auto data = writer_->Buffer(current_);
+        setp(data, data + writer_->BufferBytes());
+    }
+    return writer_->Error().empty() ? 0 : -1;
+}
+
+auto AsyncFileStreamBuf::Handoff() -> bool
+{
+    current_ = writer_->Submit(current_, std::size_t(pptr() - pbase()));
+    auto data = writer_->Buffer(current_);
+    setp(data, data + writer_->BufferBytes());
+    return writer_->Error().empty();
+}
+
 /*
  *
  */
@@ -7,10 +7,22 @@
 #ifndef PITS_STRINGSTREAM_HPP_
 #define PITS_STRINGSTREAM_HPP_
 
-#include <memory>       // allocator
+#include <algorithm>    // max
+#include <charconv>     // to_chars
+#include <climits>      // INT_MAX
+#include <cstddef>      // size_t
+#include <memory>       // allocator unique_ptr
+#include <ostream>
+#include <streambuf>
 #include <string>       // char_traits
 #include <string_view>
 #include <sstream>
+#include <system_error> // errc
+#include <type_traits>
+#include <utility>      // forward
+#include <vector>
+
+#include "Pits/Encoding.hpp"
 
 /*
  *
@@ -67,8 +79,101 @@ public:
         }
         return string_view();
     }
+
+    /// 再確保せずに書き込める要素数を返す
+    static auto Capacity(const stringbuf* sbuf) noexcept -> std::size_t
+    {
+        if (auto p = static_cast<const ToStringViewImpl*>(sbuf)) {
+            return std::size_t(p->epptr() - p->pbase());
+        }
+        return 0;
+    }
+};
+
+/**
+ * @brief ストリームの基底より先にバッファを構築する為の保持クラス
+ */
+template <class Buffer>
+struct BufferHolder
+{
+    template <class... Args>
+    explicit BufferHolder(Args&&... args) : buffer_(std::forward<Args>(args)...) {}
+
+    /// ストリームのバッファ
+    Buffer buffer_;
 };
 
+/**
+ * @brief 文字の途中で切らずに収まるユニット数を返す
+ * @param s 書き込む文字列
+ * @param room 空き容量 (n より小さい事)
+ * @return UTF8 の後続データ, UTF16 のローサロゲートの手前まで戻した room
+ */
+template <class Char>
+inline auto FitUnits(const Char* s, std::size_t room) noexcept -> std::size_t
+{
+    if constexpr (sizeof(Char) == 1) {
+        auto fit = room;
+        for (auto n = 0; fit && n < 3 && (static_cast<unsigned char>(s[fit]) & 0xc0) == 0x80; ++n) --fit;
+        return (static_cast<unsigned char>(s[fit]) & 0xc0) == 0x80 ? room : fit;
+    } else if constexpr (sizeof(Char) == 2) {
+        return (room && (char16_t(s[room]) & 0xfc00) == 0xdc00 && (char16_t(s[room - 1]) & 0xfc00) == 0xd800) ? room - 1 : room;
+    } else {
+        return room;
+    }
+}
+
+/// 文字のユニット型なら 1, 2, 4 (UTF8, UTF16, UTF32) でなければ 0
+template <class T>
+constexpr auto UnitSize = std::size_t(
+    (std::is_same_v<T, char> || std::is_same_v<T, char8_t>) ? 1 :
+    std::is_same_v<T, char16_t> ? 2 :
+    std::is_same_v<T, char32_t> ? 4 :
+    std::is_same_v<T, wchar_t> ? sizeof(wchar_t) : 0);
+
+/// static_assert を遅延させる為の偽
+template <class T>
+constexpr auto AlwaysFalse = false;
+
+/*
+ *
+ */
+
+/**
+ * @brief バッファの内容を取り出して空にする
+ *
+ * 既定の Traits, Allocator の char, wchar_t, char16_t, char32_t は
+ * StringStream.cpp の多重定義が複写せずに取り出す それ以外は複写する
+ */
+template <class Char, class Traits, class Allocator>
+inline auto ReleaseString(std::basic_stringbuf<Char, Traits, Allocator>* sbuf) -> std::basic_string<Char, Traits, Allocator>
+{
+    auto out = sbuf->str();
+    sbuf->str(std::basic_string<Char, Traits, Allocator>());
+    return out;
+}
+
+auto ReleaseString(std::basic_stringbuf<char>* sbuf) -> std::basic_string<char>;
+auto ReleaseString(std::basic_stringbuf<wchar_t>* sbuf) -> std::basic_string<wchar_t>;
+auto ReleaseString(std::basic_stringbuf<char16_t>* sbuf) -> std::basic_string<char16_t>;
+auto ReleaseString(std::basic_stringbuf<char32_t>* sbuf) -> std::basic_string<char32_t>;
+
+/**
+ * @brief 文字列をバッファにする
+ *
+ * ReleaseString と同じく既定の型は複写しない それ以外は複写する
+ */
+template <class Char, class Traits, class Allocator>
+inline void AdoptString(std::basic_stringbuf<Char, Traits, Allocator>* sbuf, std::basic_string<Char, Traits, Allocator>&& s)
+{
+    sbuf->str(s);
+}
+
+void AdoptString(std::basic_stringbuf<char>* sbuf, std::basic_string<char>&& s);
+void AdoptString(std::basic_stringbuf<wchar_t>* sbuf, std::basic_string<wchar_t>&& s);
+void AdoptString(std::basic_stringbuf<char16_t>* sbuf, std::basic_string<char16_t>&& s);
+void AdoptString(std::basic_stringbuf<char32_t>* sbuf, std::basic_string<char32_t>&& s);
+
 /*
  *
  */
@@ -104,8 +209,22 @@ public:
     /// バッファを参照する型
     using string_view = std::basic_string_view<Char>;
 
+    /// バッファを所有する文字列の型
+    using string = std::basic_string<Char, Traits, Allocator>;
+
     using stringstream::stringstream;
 
+    /**
+     * @brief 文字列を複写せずにバッファにする
+     * @param s バッファにする文字列
+     * @param mode 開くモード
+     */
+    explicit BasicStringStream(string&& s, std::ios_base::openmode mode = std::ios_base::in | std::ios_base::out)
+        : stringstream(mode)
+    {
+        adopt(std::move(s));
+    }
+
     /**
      * @brief バッファの内容を string_view 型のオブジェクトで返す
      * @return string_view 
@@ -113,15 +232,1280 @@ public:
     auto str() const -> string_view
     {
         using impl = StringStreamImplement::ToStringViewImpl<Char, Traits, Allocator>;
-        return impl::ToStringView(rdbuf());
+        return impl::ToStringView(this->rdbuf());
     };
 
+    /**
+     * @brief バッファを複写せずに取り出して空にする (C++20 の std::move(ss).str() 相当)
+     *
+     * C++17 でも libstdc++, libc++ は複写しない その他の標準ライブラリは複写する
+     * 内容は std::basic_stringstream::str() と同じく書き込んだ最も後ろの位置まで
+     *
+     * @return バッファの内容
+     */
+    auto release() -> string
+    {
+#if __cplusplus > 201703L
+        return std::move(*this->rdbuf()).str();
+#else
+        return StringStreamImplement::ReleaseString(this->rdbuf());
+#endif
+    }
+
+    /**
+     * @brief 文字列を複写せずにバッファにする (C++20 の str(string&&) 相当)
+     *
+     * 位置は先頭に戻り、状態フラグは変えない
+     *
+     * @param s バッファにする文字列
+     */
+    void adopt(string&& s)
+    {
+#if __cplusplus > 201703L
+        this->rdbuf()->str(std::move(s));
+#else
+        StringStreamImplement::AdoptString(this->rdbuf(), std::move(s));
+#endif
+    }
+
+};
+
+/*
+ *
+ */
+
+/// スレッド毎のストリームプールの統計
+struct StringStreamPoolStatistics {
+    std::size_t hits;       // 構築済みのストリームを渡した回数
+    std::size_t misses;     // ストリームを構築した回数
+    std::size_t pooled;     // 保持しているストリームの数
+    std::size_t retained;   // 保持しているバッファの合計バイト数
+};
+
+namespace StringStreamImplement {
+
+/**
+ * @brief スレッド毎に構築済みの BasicStringStream を保持するプール
+ *
+ * 返されたストリームはバッファを残して空にし、状態フラグ, 例外の指定と書式を既定に戻す
+ * 書式は copyfmt でプールを作った時の既定を写すので、ロケール, tie, iword, pword と
+ * register_callback の登録も既定に戻る (ロケールはプールを作った時のグローバルロケール)
+ * 保持するバッファの合計が limit を超える場合と Slots 個を超える場合は破棄する
+ */
+template <class Char>
+class StringStreamPool
+{
+public:
+
+    using stream = BasicStringStream<Char>;
+
+    /// 保持するストリームの最大数
+    static constexpr auto Slots = std::size_t(8);
+
+    /// 保持するバッファの合計の既定の上限 [byte]
+    static constexpr auto DefaultLimit = std::size_t(64 * 1024);
+
+    StringStreamPool(const StringStreamPool&) = delete;
+    StringStreamPool& operator=(const StringStreamPool&) = delete;
+
+    /// 呼び出したスレッドのプールを返す
+    static auto Local() -> StringStreamPool&
+    {
+        thread_local StringStreamPool pool;
+        return pool;
+    }
+
+    /// 構築済みのストリームを取り出す 無ければ構築する
+    auto Acquire() -> stream*
+    {
+        if (count_) {
+            ++hits_;
+            auto ss = free_[--count_].release();
+            retained_ -= Bytes(ss);
+            return ss;
+        }
+        ++misses_;
+        return new stream;
+    }
+
+    /// ストリームを空にしてプールへ戻す
+    void Release(stream* ss) noexcept
+    {
+        auto owned = std::unique_ptr<stream>(ss);
+        auto bytes = Bytes(ss);
+        if (count_ == Slots || !limit_ || retained_ + bytes > limit_) return;
+
+        // 左辺値を渡して C++20 の str(string&&) によるバッファの解放を避ける
+        static const auto empty = std::basic_string<Char>();
+        ss->stringstream::str(empty);
+        ss->exceptions(std::ios_base::goodbit);
+        ss->clear();
+        ss->copyfmt(defaults_);
+
+        retained_ += bytes;
+        free_[count_++] = std::move(owned);
+    }
+
+    /// 保持するバッファの合計の上限を設定し、超える分を破棄する
+    void SetLimit(std::size_t bytes) noexcept
+    {
+        limit_ = bytes;
+        while (count_ && (!limit_ || retained_ > limit_)) {
+            retained_ -= Bytes(free_[--count_].get());
+            free_[count_].reset();
+        }
+    }
+
+    auto GetStatistics() const noexcept -> StringStreamPoolStatistics
+    {
+        return {hits_, misses_, count_, retained_};
+    }
+
+private:
+
+    StringStreamPool() = default;
+
+    /// バッファのバイト数
+    static auto Bytes(const stream* ss) noexcept -> std::size_t
+    {
+        using impl = ToStringViewImpl<Char, std::char_traits<Char>, std::allocator<Char>>;
+        return impl::Capacity(ss->rdbuf()) * sizeof(Char);
+    }
+
+    /// 返されたストリームへ写す既定の書式
+    std::basic_ios<Char> defaults_ {nullptr};
+
+    std::unique_ptr<stream> free_[Slots];
+    std::size_t count_ {};
+    std::size_t retained_ {};
+    std::size_t limit_ = DefaultLimit;
+    std::size_t hits_ {};
+    std::size_t misses_ {};
+};
+
+} // namespace StringStreamImplement
+
+/**
+ * @brief スレッド毎のプールから借りた BasicStringStream
+ *
+ * 破棄する時にプールへ返す 借りたスレッドで破棄する事
+ */
+template <class Char>
+class PooledStringStream
+{
+    using pool = StringStreamImplement::StringStreamPool<Char>;
+
+public:
+
+    using stream = BasicStringStream<Char>;
+
+    PooledStringStream(const PooledStringStream&) = delete;
+    PooledStringStream& operator=(const PooledStringStream&) = delete;
+
+    PooledStringStream(PooledStringStream&& other) noexcept : stream_(other.stream_) { other.stream_ = nullptr; }
+
+    auto operator=(PooledStringStream&& other) noexcept -> PooledStringStream&
+    {
+        if (this != &other) {
+            Release();
+            stream_ = other.stream_;
+            other.stream_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~PooledStringStream() noexcept { Release(); }
+
+    /// 呼び出したスレッドのプールから借りる
+    PooledStringStream() : stream_(pool::Local().Acquire()) {}
+
+    auto get() const noexcept -> stream* { return stream_; }
+    auto operator*() const noexcept -> stream& { return *stream_; }
+    auto operator->() const noexcept -> stream* { return stream_; }
+
+    /// 期限前にプールへ返す
+    void Release() noexcept
+    {
+        if (stream_) {
+            pool::Local().Release(stream_);
+            stream_ = nullptr;
+        }
+    }
+
+private:
+
+    /// 借りているストリーム
+    stream* stream_;
+};
+
+/**
+ * @brief 呼び出したスレッドのプールから構築済みのストリームを借りる
+ *
+ * basic_stringstream の構築 (ロケールの複写とバッファの確保) を繰り返さない為に使う
+ *
+ * @code
+ * auto ss = Pits::AcquireStringStream();
+ * *ss << "id=" << id;
+ * send(ss->str());
+ * @endcode
+ *
+ * @return 破棄する時にプールへ返すストリーム
+ */
+template <class Char = char>
+inline auto AcquireStringStream() -> PooledStringStream<Char>
+{
+    return PooledStringStream<Char>();
+}
+
+/// 呼び出したスレッドのプールの統計を返す
+template <class Char = char>
+inline auto GetStringStreamPoolStatistics() -> StringStreamPoolStatistics
+{
+    return StringStreamImplement::StringStreamPool<Char>::Local().GetStatistics();
+}
+
+/**
+ * @brief 呼び出したスレッドのプールが保持するバッファの合計の上限を設定する
+ * @param bytes 上限 [byte] 既定は 64KiB 0 ならストリームを保持しない
+ */
+template <class Char = char>
+inline void SetStringStreamPoolLimit(std::size_t bytes)
+{
+    StringStreamImplement::StringStreamPool<Char>::Local().SetLimit(bytes);
+}
+
+/*
+ *
+ */
+
+/// 固定長のバッファが一杯になった時の扱い
+enum class OverflowPolicy {
+    Truncate,   // 収まらない分を捨てる 文字の途中では切らず、以降の書き込みも捨てる
+    Spill,      // ヒープへ移して書き続ける
+    Fail,       // 収まる分だけ書いて失敗させる (ストリームに badbit が立つ)
+};
+
+/**
+ * @brief 呼び出し側のバッファへ書き込む streambuf
+ *
+ * 容量内ではヒープを使わず、overflow も呼ばずに書き込む
+ */
+template <class Char, class Traits = std::char_traits<Char>>
+class BasicSpanStreamBuf : public std::basic_streambuf<Char, Traits>
+{
+public:
+
+    using char_type = Char;
+    using traits_type = Traits;
+    using int_type = typename Traits::int_type;
+    using pos_type = typename Traits::pos_type;
+    using off_type = typename Traits::off_type;
+
+    /// 書き込んだ内容を参照する型
+    using string_view = std::basic_string_view<Char, Traits>;
+
+    BasicSpanStreamBuf(const BasicSpanStreamBuf&) = delete;
+    BasicSpanStreamBuf& operator=(const BasicSpanStreamBuf&) = delete;
+
+    /**
+     * @brief バッファを設定する
+     * @param data 書き込み先
+     * @param size 書き込み先の要素数
+     * @param policy 一杯になった時の扱い
+     */
+    BasicSpanStreamBuf(Char* data, std::size_t size, OverflowPolicy policy = OverflowPolicy::Truncate) noexcept
+        : data_(data), size_(size), policy_(policy)
+    {
+        this->setp(data_, data_ + size_);
+    }
+
+    /// 書き込んだ内容を返す
+    auto str() const noexcept -> string_view
+    {
+        return string_view(this->pbase(), std::size_t(this->pptr() - this->pbase()));
+    }
+
+    /// OverflowPolicy::Truncate で捨てた書き込みが有ったか
+    auto truncated() const noexcept -> bool { return truncated_; }
+
+    /// OverflowPolicy::Spill でヒープへ移したか
+    auto spilled() const noexcept -> bool { return this->pbase() != data_; }
+
+    /// 空にして呼び出し側のバッファへ戻す (ヒープの領域は再利用の為に残す)
+    void reset() noexcept
+    {
+        this->setp(data_, data_ + size_);
+        truncated_ = false;
+    }
+
+protected:
+
+    auto overflow(int_type c) -> int_type override
+    {
+        if (Traits::eq_int_type(c, Traits::eof())) return Traits::not_eof(c);
+        auto ch = Traits::to_char_type(c);
+        return xsputn(&ch, 1) == 1 ? c : Traits::eof();
+    }
+
+    auto xsputn(const Char* s, std::streamsize n) -> std::streamsize override
+    {
+        auto room = std::streamsize(this->epptr() - this->pptr());
+        if (n <= room && !truncated_) {
+            Traits::copy(this->pptr(), s, std::size_t(n));
+            Advance(n);
+            return n;
+        }
+        switch (policy_) {
+        case OverflowPolicy::Truncate:
+            // 捨てた事にして成功を返し、ストリームの状態は変えない
+            if (!truncated_) {
+                auto fit = StringStreamImplement::FitUnits(s, std::size_t(room));
+                Traits::copy(this->pptr(), s, fit);
+                Advance(std::streamsize(fit));
+                truncated_ = true;
+
+                // 書き込み領域を閉じ、sputc 等の1文字の書き込みも overflow を通して捨てる
+                auto used = std::streamsize(this->pptr() - this->pbase());
+                this->setp(this->pbase(), this->pptr());
+                Advance(used);
+            }
+            return n;
+        case OverflowPolicy::Spill:
+            Grow(std::size_t(n - room));
+            Traits::copy(this->pptr(), s, std::size_t(n));
+            Advance(n);
+            return n;
+        case OverflowPolicy::Fail:
+        default:
+            Traits::copy(this->pptr(), s, std::size_t(room));
+            Advance(room);
+            return room;
+        }
+    }
+
+    /// tellp の為に現在位置だけ返す
+    auto seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) -> pos_type override
+    {
+        if (off == 0 && dir == std::ios_base::cur && (which & std::ios_base::out)) {
+            return pos_type(off_type(this->pptr() - this->pbase()));
+        }
+        return pos_type(off_type(-1));
+    }
+
+private:
+
+    /// 書き込み位置を進める
+    void Advance(std::streamsize n) noexcept
+    {
+        for (; n > INT_MAX; n -= INT_MAX) this->pbump(INT_MAX);
+        this->pbump(int(n));
+    }
+
+    /// ヒープへ移して more 要素以上の空きを作る
+    void Grow(std::size_t more)
+    {
+        auto used = std::size_t(this->pptr() - this->pbase());
+        auto capacity = std::max({used * 2, used + more, std::size_t(64)});
+        if (spilled()) {
+            spill_.resize(capacity);
+        } else {
+            spill_.resize(std::max(capacity, spill_.size()));
+            Traits::copy(&spill_[0], this->pbase(), used);
+        }
+        this->setp(&spill_[0], &spill_[0] + spill_.size());
+        Advance(std::streamsize(used));
+    }
+
+    /// 呼び出し側のバッファ
+    Char* data_;
+    std::size_t size_;
+
+    /// 一杯になった時の扱い
+    OverflowPolicy policy_;
+
+    /// 捨てた書き込みが有ったか
+    bool truncated_ {};
+
+    /// ヒープへ移した内容
+    std::basic_string<Char, Traits> spill_;
+};
+
+/**
+ * @brief 呼び出し側のバッファへ書き込む出力ストリーム
+ *
+ * BasicStringStream と異なり内部に basic_string を持たず、容量内ではヒープを使わない
+ * str() は BasicStringStream と同じく複写せずに string_view を返す
+ * reset() で空にして使い回せば、行毎にストリームを構築し直さずに済む
+ *
+ * @code
+ * char buffer[256];
+ * Pits::BasicSpanStream<char> ss(buffer);
+ * ss << "count=" << 42;
+ * log(ss.str());
+ * @endcode
+ */
+template <class Char, class Traits = std::char_traits<Char>>
+class BasicSpanStream
+    : private StringStreamImplement::BufferHolder<BasicSpanStreamBuf<Char, Traits>>
+    , public std::basic_ostream<Char, Traits>
+{
+    using holder = StringStreamImplement::BufferHolder<BasicSpanStreamBuf<Char, Traits>>;
+
+public:
+
+    /// 基底となる basic_ostream の型
+    using ostream = std::basic_ostream<Char, Traits>;
+
+    /// バッファデバイスとなる streambuf の型
+    using spanbuf = BasicSpanStreamBuf<Char, Traits>;
+
+    /// バッファを参照する型
+    using string_view = std::basic_string_view<Char, Traits>;
+
+    /**
+     * @brief バッファを設定する
+     * @param data 書き込み先
+     * @param size 書き込み先の要素数
+     * @param policy 一杯になった時の扱い
+     */
+    BasicSpanStream(Char* data, std::size_t size, OverflowPolicy policy = OverflowPolicy::Truncate)
+        : holder(data, size, policy), ostream(&this->buffer_)
+    {
+    }
+
+    /**
+     * @brief 配列をバッファにする
+     * @param data 書き込み先
+     * @param policy 一杯になった時の扱い
+     */
+    template <std::size_t N>
+    explicit BasicSpanStream(Char (&data)[N], OverflowPolicy policy = OverflowPolicy::Truncate)
+        : BasicSpanStream(data, N, policy)
+    {
+    }
+
+    /// 書き込んだ内容を string_view 型のオブジェクトで返す
+    auto str() const noexcept -> string_view { return this->buffer_.str(); }
+
+    /// 捨てた書き込みが有ったか
+    auto truncated() const noexcept -> bool { return this->buffer_.truncated(); }
+
+    /// ヒープへ移したか
+    auto spilled() const noexcept -> bool { return this->buffer_.spilled(); }
+
+    /// バッファデバイスを返す
+    auto rdbuf() const noexcept -> spanbuf* { return const_cast<spanbuf*>(&this->buffer_); }
+
+    /// 空にして状態フラグも戻す
+    void reset() noexcept
+    {
+        this->buffer_.reset();
+        this->clear();
+    }
 };
 
 /*
  *
  */
 
+/**
+ * @brief 固定長のセグメントを連ねたバッファへ書き込む streambuf
+ *
+ * 一杯になると次のセグメントへ移るだけで、書き込んだ内容の再確保と複写をしない
+ * clear() してもセグメントは解放せずに次の書き込みで使い回す
+ */
+template <class Char, class Traits = std::char_traits<Char>>
+class BasicRopeStreamBuf : public std::basic_streambuf<Char, Traits>
+{
+public:
+
+    using char_type = Char;
+    using traits_type = Traits;
+    using int_type = typename Traits::int_type;
+    using pos_type = typename Traits::pos_type;
+    using off_type = typename Traits::off_type;
+
+    /// セグメントを参照する型
+    using string_view = std::basic_string_view<Char, Traits>;
+
+    /// 既定のセグメントの要素数 (64KiB)
+    static constexpr auto DefaultSegmentUnits = std::size_t(64 * 1024 / sizeof(Char));
+
+    BasicRopeStreamBuf(const BasicRopeStreamBuf&) = delete;
+    BasicRopeStreamBuf& operator=(const BasicRopeStreamBuf&) = delete;
+
+    /**
+     * @brief セグメントの大きさを設定する 確保は最初の書き込みまで遅らせる
+     * @param units セグメントの要素数
+     */
+    explicit BasicRopeStreamBuf(std::size_t units = DefaultSegmentUnits) : units_(std::max(units, std::size_t(1))) {}
+
+    /// 書き込んだ要素数
+    auto size() const noexcept -> std::size_t
+    {
+        return this->pbase() ? current_ * units_ + std::size_t(this->pptr() - this->pbase()) : 0;
+    }
+
+    /// セグメントの要素数
+    auto GetSegmentUnits() const noexcept -> std::size_t { return units_; }
+
+    /// 書き込んだ内容を持つセグメントの数
+    auto segments() const noexcept -> std::size_t { return (size() + units_ - 1) / units_; }
+
+    /**
+     * @brief セグメントの内容を返す (writev 等でまとめて出力する為)
+     * @param i 0 ～ segments() - 1
+     * @return 最後以外は GetSegmentUnits() 要素
+     */
+    auto segment(std::size_t i) const noexcept -> string_view
+    {
+        auto offset = i * units_;
+        return string_view(segments_[i].get(), std::min(units_, size() - offset));
+    }
+
+    /**
+     * @brief 連続した内容を返す
+     *
+     * セグメントが1つなら複写しない 複数なら呼ぶ度に内部の文字列へまとめる
+     *
+     * @return 書き込んだ内容 次の書き込みか clear() まで有効
+     */
+    auto str() -> string_view
+    {
+        auto count = segments();
+        if (count <= 1) return count ? segment(0) : string_view();
+        joined_.clear();
+        joined_.reserve(size());
+        for (auto i = std::size_t {}; i != count; ++i) joined_.append(segment(i));
+        return joined_;
+    }
+
+    /// 空にする (セグメントは次の書き込みで使い回す)
+    void clear() noexcept
+    {
+        this->setp(nullptr, nullptr);
+        current_ = 0;
+        joined_ = std::basic_string<Char, Traits>();
+    }
+
+protected:
+
+    /// 次のセグメントへ移る
+    auto overflow(int_type c) -> int_type override
+    {
+        if (Traits::eq_int_type(c, Traits::eof())) return Traits::not_eof(c);
+        auto next = this->pbase() ? current_ + 1 : 0;
+        if (next == segments_.size()) {
+            segments_.emplace_back(new Char[units_]);
+        }
+        current_ = next;
+        auto data = segments_[next].get();
+        this->setp(data, data + units_);
+        *this->pptr() = Traits::to_char_type(c);
+        this->pbump(1);
+        return c;
+    }
+
+    /// tellp の為に現在位置だけ返す
+    auto seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) -> pos_type override
+    {
+        if (off == 0 && dir == std::ios_base::cur && (which & std::ios_base::out)) {
+            return pos_type(off_type(size()));
+        }
+        return pos_type(off_type(-1));
+    }
+
+private:
+
+    /// セグメントの要素数
+    std::size_t units_;
+
+    /// 書き込み中のセグメント
+    std::size_t current_ {};
+
+    /// 確保したセグメント
+    std::vector<std::unique_ptr<Char[]>> segments_;
+
+    /// str() でまとめた内容
+    std::basic_string<Char, Traits> joined_;
+};
+
+/**
+ * @brief 固定長のセグメントを連ねたバッファへ書き込む出力ストリーム
+ *
+ * 数百 MB の出力でも basic_string の倍々の再確保と複写が無く、
+ * 確保するのは出力の大きさ + 1セグメントまで
+ *
+ * @code
+ * Pits::BasicRopeStream<char> out;
+ * write_report(out);
+ * std::vector<iovec> iov;
+ * for (auto i = std::size_t {}; i != out.segments(); ++i) {
+ *     auto s = out.segment(i);
+ *     iov.push_back({const_cast<char*>(s.data()), s.size()});
+ * }
+ * writev(fd, iov.data(), int(iov.size()));
+ * @endcode
+ */
+template <class Char, class Traits = std::char_traits<Char>>
+class BasicRopeStream
+    : private StringStreamImplement::BufferHolder<BasicRopeStreamBuf<Char, Traits>>
+    , public std::basic_ostream<Char, Traits>
+{
+    using holder = StringStreamImplement::BufferHolder<BasicRopeStreamBuf<Char, Traits>>;
+
+public:
+
+    /// 基底となる basic_ostream の型
+    using ostream = std::basic_ostream<Char, Traits>;
+
+    /// バッファデバイスとなる streambuf の型
+    using ropebuf = BasicRopeStreamBuf<Char, Traits>;
+
+    /// バッファを参照する型
+    using string_view = std::basic_string_view<Char, Traits>;
+
+    /**
+     * @brief セグメントの大きさを設定する
+     * @param units セグメントの要素数
+     */
+    explicit BasicRopeStream(std::size_t units = ropebuf::DefaultSegmentUnits) : holder(units), ostream(&this->buffer_) {}
+
+    /// 書き込んだ要素数
+    auto size() const noexcept -> std::size_t { return this->buffer_.size(); }
+
+    /// 書き込んだ内容を持つセグメントの数
+    auto segments() const noexcept -> std::size_t { return this->buffer_.segments(); }
+
+    /// セグメントの内容を返す
+    auto segment(std::size_t i) const noexcept -> string_view { return this->buffer_.segment(i); }
+
+    /// 連続した内容を返す セグメントが複数ならまとめる
+    auto str() -> string_view { return this->buffer_.str(); }
+
+    /// バッファデバイスを返す
+    auto rdbuf() const noexcept -> ropebuf* { return const_cast<ropebuf*>(&this->buffer_); }
+
+    /// 空にして状態フラグも戻す
+    void reset() noexcept
+    {
+        this->buffer_.clear();
+        this->clear();
+    }
+};
+
+/*
+ *
+ */
+
+/// 書き出し待ちのバッファが溜まった時の扱い
+enum class BacklogPolicy {
+    Block,      // バッファが空くまで書き込みを待たせる
+    Drop,       // 書き込み中のバッファの内容を捨てる (dropped に数える)
+};
+
+/// 非同期出力の統計
+struct AsyncSinkStatistics {
+    std::size_t flushes;        // 書き出したバッファの数
+    std::size_t bytes;          // 書き出したバイト数
+    std::size_t dropped;        // BacklogPolicy::Drop で捨てたバイト数
+    std::size_t blocked;        // BacklogPolicy::Block でバッファを待った回数
+    double lastFlushSeconds;    // 最後の書き出しの時間 [sec] (Pits::Timer で計る)
+    double maxFlushSeconds;     // 最長の書き出しの時間 [sec]
+    double totalFlushSeconds;   // 書き出しの時間の合計 [sec]
+};
+
+/**
+ * @brief 複数のバッファへ書き込み、一杯になった物を別スレッドでファイルへ書き出す streambuf
+ *
+ * 書き込むスレッドはファイルの書き込みを待たない
+ * 一杯になった時にバッファを書き出しスレッドへ渡し、空いているバッファへ移る
+ * 空いているバッファが無い時は BacklogPolicy に従う (閉じる時の最後のバッファは捨てない)
+ * sync (std::flush, std::endl) は半分以上書き込んだバッファだけを、空いているバッファが2つ以上ある時に渡す
+ * 行毎に flush しても書き出しは大きな単位のままで、BacklogPolicy も一杯になった時だけ使う
+ * 書き出しは1バッファを1回の fwrite (バッファ無し) で行う
+ * 開けなかった場合と書き出しに失敗した場合は error() に理由を残す
+ */
+class AsyncFileStreamBuf : public std::streambuf
+{
+public:
+
+    /// 既定のバッファの大きさ [byte]
+    static constexpr auto DefaultBufferBytes = std::size_t(256 * 1024);
+
+    /// 既定のバッファの数
+    static constexpr auto DefaultBuffers = std::size_t(2);
+
+    AsyncFileStreamBuf(const AsyncFileStreamBuf&) = delete;
+    AsyncFileStreamBuf& operator=(const AsyncFileStreamBuf&) = delete;
+
+    /**
+     * @brief ファイルを開いて書き出しスレッドを始める
+     * @param path ファイル (作り直す)
+     * @param policy 空いているバッファが無い時の扱い
+     * @param bufferBytes バッファの大きさ [byte]
+     * @param buffers バッファの数 (2 以上)
+     */
+    explicit AsyncFileStreamBuf(const char* path, BacklogPolicy policy = BacklogPolicy::Block,
+                                std::size_t bufferBytes = DefaultBufferBytes, std::size_t buffers = DefaultBuffers);
+
+    /// 残りを書き出して閉じる
+    ~AsyncFileStreamBuf();
+
+    /// 開いているか
+    auto is_open() const noexcept -> bool;
+
+    /// 開けなかった, 書き出せなかった理由 無ければ空
+    auto error() const -> std::string;
+
+    /**
+     * @brief 残りを全て書き出して閉じる
+     * @return 全て書き出せたか
+     */
+    auto close() -> bool;
+
+    /// 統計を返す
+    auto GetStatistics() const -> AsyncSinkStatistics;
+
+protected:
+
+    auto overflow(int_type c) -> int_type override;
+
+    /// 半分以上書き込んでいれば空いているバッファが2つ以上ある時に書き出しスレッドへ渡す (待たず, 捨てない)
+    auto sync() -> int override;
+
+private:
+
+    class Writer;
+
+    /// 書き込み中のバッファを渡して次のバッファへ移る
+    auto Handoff() -> bool;
+
+    /// 書き出しスレッドと共有する状態
+    std::unique_ptr<Writer> writer_;
+
+    /// 書き込み中のバッファ
+    std::size_t current_ {};
+};
+
+/**
+ * @brief 別スレッドでファイルへ書き出す出力ストリーム
+ *
+ * @code
+ * Pits::AsyncFileStream log("service.log", Pits::BacklogPolicy::Drop);
+ * log << "request id=" << id << '\n';
+ * @endcode
+ */
+class AsyncFileStream
+    : private StringStreamImplement::BufferHolder<AsyncFileStreamBuf>
+    , public std::ostream
+{
+    using holder = StringStreamImplement::BufferHolder<AsyncFileStreamBuf>;
+
+public:
+
+    /**
+     * @brief ファイルを開く 開けなければ badbit を立てる
+     * @param path ファイル (作り直す)
+     * @param policy 空いているバッファが無い時の扱い
+     * @param bufferBytes バッファの大きさ [byte]
+     * @param buffers バッファの数 (2 以上)
+     */
+    explicit AsyncFileStream(const char* path, BacklogPolicy policy = BacklogPolicy::Block,
+                             std::size_t bufferBytes = AsyncFileStreamBuf::DefaultBufferBytes,
+                             std::size_t buffers = AsyncFileStreamBuf::DefaultBuffers)
+        : holder(path, policy, bufferBytes, buffers), std::ostream(&this->buffer_)
+    {
+        if (!this->buffer_.is_open()) this->setstate(std::ios_base::badbit);
+    }
+
+    /// バッファデバイスを返す
+    auto rdbuf() const noexcept -> AsyncFileStreamBuf* { return const_cast<AsyncFileStreamBuf*>(&this->buffer_); }
+
+    auto is_open() const noexcept -> bool { return this->buffer_.is_open(); }
+    auto error() const -> std::string { return this->buffer_.error(); }
+    auto GetStatistics() const -> AsyncSinkStatistics { return this->buffer_.GetStatistics(); }
+
+    /// 残りを全て書き出して閉じる 失敗すると badbit を立てる
+    auto close() -> bool
+    {
+        auto ok = this->buffer_.close();
+        if (!ok) this->setstate(std::ios_base::badbit);
+        return ok;
+    }
+};
+
+/*
+ *
+ */
+
+/**
+ * @brief iostream を使わずに文字列を組み立てる
+ *
+ * operator<< 毎の仮想関数呼び出し, sentry, ロケールの参照が無く、
+ * 数値は std::to_chars で直接バッファへ書き込む
+ * Inline 要素までは内部の配列を使い、超えるとヒープへ移す
+ * str() は BasicStringStream と同じく複写せずに string_view を返す
+ *
+ * 追加できる物
+ * - 文字列 (char, char8_t, char16_t, char32_t, wchar_t の string_view, string, ヌル終端文字列)
+ *   Char と異なるエンコーディングは変換し、不正なシーケンスは置き換える
+ *   同じエンコーディングはそのまま複写する
+ * - 文字 (1ユニット)
+ * - 整数 (bool は true, false)
+ * - 浮動小数点数 (既定は std::to_chars の最短表現 ストリームの既定の6桁とは異なる)
+ *
+ * @code
+ * Pits::StringBuilder sb;
+ * sb << "count=" << 42 << u" \u3042 " << 1.5;
+ * log(sb.str());
+ * @endcode
+ *
+ * @tparam Char char, char16_t, char32_t, wchar_t
+ * @tparam Inline 内部に持つ要素数
+ */
+template <class Char, std::size_t Inline = 256 / sizeof(Char)>
+class BasicStringBuilder
+{
+    static_assert(StringStreamImplement::UnitSize<Char> != 0, "Char must be a character unit type");
+
+public:
+
+    /// 組み立てた文字列を参照する型
+    using string_view = std::basic_string_view<Char>;
+
+    BasicStringBuilder() noexcept : data_(inline_) {}
+
+    BasicStringBuilder(const BasicStringBuilder&) = delete;
+    BasicStringBuilder& operator=(const BasicStringBuilder&) = delete;
+
+    BasicStringBuilder(BasicStringBuilder&& other) noexcept : data_(inline_) { Take(other); }
+
+    auto operator=(BasicStringBuilder&& other) noexcept -> BasicStringBuilder&
+    {
+        if (this != &other) Take(other);
+        return *this;
+    }
+
+    /// 組み立てた文字列を string_view 型のオブジェクトで返す
+    auto str() const noexcept -> string_view { return string_view(data_, size_); }
+
+    auto data() const noexcept -> const Char* { return data_; }
+    auto size() const noexcept -> std::size_t { return size_; }
+    auto empty() const noexcept -> bool { return !size_; }
+    auto capacity() const noexcept -> std::size_t { return capacity_; }
+
+    /// 空にする (確保した領域は再利用の為に残す)
+    void clear() noexcept { size_ = 0; }
+
+    /// 要素数 n まで再確保せずに追加できるようにする
+    void reserve(std::size_t n)
+    {
+        if (n > capacity_) Grow(n);
+    }
+
+    /**
+     * @brief 文字列, 文字, 数値を追加する
+     * @param value 追加する値
+     * @return *this
+     */
+    template <class T>
+    auto append(const T& value) -> BasicStringBuilder&
+    {
+        using namespace StringStreamImplement;
+        using Type = std::remove_cv_t<T>;
+        if constexpr (UnitSize<Type> != 0) {
+            AppendUnits(&value, 1);
+        }
+        else if constexpr (std::is_same_v<Type, bool>) {
+            AppendUnits(value ? "true" : "false", value ? 4 : 5);
+        }
+        else if constexpr (std::is_integral_v<Type> || std::is_floating_point_v<Type>) {
+            AppendNumber(value);
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            AppendView(std::string_view(value));
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::u16string_view>) {
+            AppendView(std::u16string_view(value));
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::u32string_view>) {
+            AppendView(std::u32string_view(value));
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::wstring_view>) {
+            AppendView(std::wstring_view(value));
+        }
+#if __cplusplus > 201703L
+        else if constexpr (std::is_convertible_v<const T&, std::u8string_view>) {
+            AppendView(std::u8string_view(value));
+        }
+#else
+        else if constexpr (std::is_convertible_v<const T&, const char8_t*>) {
+            // C++17 の char8_t は列挙型なので char_traits が無い
+            auto s = static_cast<const char8_t*>(value);
+            auto n = std::size_t {};
+            while (s[n] != char8_t()) ++n;
+            AppendUnits(s, n);
+        }
+#endif
+        else {
+            static_assert(AlwaysFalse<T>, "unsupported type for BasicStringBuilder::append");
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 基数を指定して整数を追加する
+     * @param value 整数
+     * @param base 基数 2 ～ 36
+     * @return *this
+     */
+    template <class T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    auto append(T value, int base) -> BasicStringBuilder&
+    {
+        AppendNumber(value, base);
+        return *this;
+    }
+
+    /**
+     * @brief 書式を指定して浮動小数点数を追加する
+     * @param value 浮動小数点数
+     * @param format 書式
+     * @return *this
+     */
+    template <class T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    auto append(T value, std::chars_format format) -> BasicStringBuilder&
+    {
+        AppendNumber(value, format);
+        return *this;
+    }
+
+    /**
+     * @brief 書式と精度を指定して浮動小数点数を追加する
+     * @param value 浮動小数点数
+     * @param format 書式
+     * @param precision 精度
+     * @return *this
+     */
+    template <class T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    auto append(T value, std::chars_format format, int precision) -> BasicStringBuilder&
+    {
+        AppendNumber(value, format, precision);
+        return *this;
+    }
+
+    /// append(value) と同じ
+    template <class T>
+    auto operator<<(const T& value) -> BasicStringBuilder& { return append(value); }
+
+private:
+
+    /// 少なくとも n 要素の領域をヒープに確保して移す
+    void Grow(std::size_t n)
+    {
+        auto capacity = std::max(n, capacity_ * 2);
+        auto heap = std::unique_ptr<Char[]>(new Char[capacity]);
+        std::char_traits<Char>::copy(heap.get(), data_, size_);
+        heap_ = std::move(heap);
+        data_ = heap_.get();
+        capacity_ = capacity;
+    }
+
+    /// 末尾に n 要素の空きを作って書き込み位置を返す
+    auto Reserve(std::size_t n) -> Char*
+    {
+        if (capacity_ - size_ < n) Grow(size_ + n);
+        return data_ + size_;
+    }
+
+    /// other の内容を移して other を空にする
+    void Take(BasicStringBuilder& other) noexcept
+    {
+        if (other.heap_) {
+            heap_ = std::move(other.heap_);
+            data_ = heap_.get();
+            capacity_ = other.capacity_;
+        }
+        else {
+            heap_.reset();
+            data_ = inline_;
+            capacity_ = Inline;
+            std::char_traits<Char>::copy(inline_, other.inline_, other.size_);
+        }
+        size_ = other.size_;
+        other.data_ = other.inline_;
+        other.size_ = 0;
+        other.capacity_ = Inline;
+    }
+
+    template <class From>
+    void AppendView(std::basic_string_view<From> view)
+    {
+        AppendUnits(view.data(), view.size());
+    }
+
+    /// Char のエンコーディングへ変換して追加する
+    template <class From>
+    void AppendUnits(const From* s, std::size_t n)
+    {
+        using namespace StringStreamImplement;
+        constexpr auto from = UnitSize<From>;
+        constexpr auto to = UnitSize<Char>;
+        if constexpr (from == to) {
+            auto out = Reserve(n);
+            if constexpr (std::is_same_v<From, Char>) {
+                std::char_traits<Char>::copy(out, s, n);
+            }
+            else {
+                for (auto i = std::size_t {}; i != n; ++i) out[i] = Char(s[i]);
+            }
+            size_ += n;
+        }
+        else if constexpr (to == 1) {
+            // UTF16 は1ユニットで最大3ユニット, UTF32 は最大4ユニット
+            auto out = Reserve(n * (from == 2 ? 3 : 4));
+            auto end = from == 2 ? EncodingImplement::UTF16ToUTF8(s, n, out) : EncodingImplement::UTF32ToUTF8(s, n, out);
+            size_ = std::size_t(end - data_);
+        }
+        else if constexpr (from == 1) {
+            auto out = Reserve(n);
+            auto text = std::string_view(reinterpret_cast<const char*>(s), n);
+            if constexpr (to == 2) {
+                size_ = std::size_t(EncodingImplement::UTF8ToUTF16(text, out) - data_);
+            }
+            else {
+                size_ = std::size_t(EncodingImplement::UTF8ToUTF32(text, out) - data_);
+            }
+        }
+        else if constexpr (from == 2) {
+            auto out = Reserve(n);
+            auto result = EncodingUTF16ToUTF32(s, s + n, out);
+            out = std::get<1>(result);
+            // 末尾で途切れたハイサロゲートを置き換える
+            if (std::get<0>(result) != s + n) *out++ = Char(Unicode::ReplacementCharacter);
+            size_ = std::size_t(out - data_);
+        }
+        else {
+            auto out = Reserve(n * 2);
+            size_ = std::size_t(std::get<1>(EncodingUTF32ToUTF16(s, s + n, out)) - data_);
+        }
+    }
+
+    /// std::to_chars で数値を追加する
+    template <class T, class... Format>
+    void AppendNumber(T value, Format... format)
+    {
+        // 整数と最短表現の浮動小数点数は必ず収まる
+        constexpr auto Small = std::size_t(64);
+        if constexpr (std::is_same_v<Char, char>) {
+            for (auto n = Small; ; n *= 2) {
+                auto out = Reserve(n);
+                auto result = std::to_chars(out, out + n, value, format...);
+                if (result.ec == std::errc()) {
+                    size_ = std::size_t(result.ptr - data_);
+                    return;
+                }
+            }
+        }
+        else {
+            char small[Small];
+            auto result = std::to_chars(small, small + Small, value, format...);
+            if (result.ec == std::errc()) {
+                AppendUnits(small, std::size_t(result.ptr - small));
+                return;
+            }
+            // 精度の大きい固定小数点表記だけがここに来る
+            auto wide = BasicStringBuilder<char, 0>();
+            wide.AppendNumber(value, format...);
+            AppendUnits(wide.data(), wide.size());
+        }
+    }
+
+    template <class, std::size_t>
+    friend class BasicStringBuilder;
+
+    /// 内部の配列
+    Char inline_[Inline ? Inline : 1];
+
+    /// 使用中の領域 (inline_ または heap_)
+    Char* data_;
+    std::size_t size_ {};
+    std::size_t capacity_ = Inline;
+
+    /// ヒープに移した領域
+    std::unique_ptr<Char[]> heap_;
+};
+
+/// UTF8 の BasicStringBuilder
+using StringBuilder = BasicStringBuilder<char>;
+
+/*
+ *
+ */
+
+/**
+ * @brief UTF16, UTF32 の書き込みを UTF8 に変換して別の streambuf へ渡す streambuf
+ *
+ * 書き込みは ChunkUnits 要素毎にまとめて変換し、全体を保持するバッファは作らない
+ * 書き込みの境目で分かれたサロゲートペアは次の変換まで持ち越し、
+ * 対にならないまま終わったハイサロゲートは finish() または破棄の時に置き換える
+ * 不正なシーケンスは置き換える
+ *
+ * @tparam Char char16_t, char32_t, wchar_t
+ */
+template <class Char, class Traits = std::char_traits<Char>>
+class BasicTranscodingStreamBuf : public std::basic_streambuf<Char, Traits>
+{
+    static_assert(StringStreamImplement::UnitSize<Char> == 2 || StringStreamImplement::UnitSize<Char> == 4,
+        "Char must be a UTF16 or UTF32 unit type");
+
+public:
+
+    using char_type = Char;
+    using traits_type = Traits;
+    using int_type = typename Traits::int_type;
+
+    /// まとめて変換する要素数
+    static constexpr auto ChunkUnits = std::size_t(1024);
+
+    BasicTranscodingStreamBuf(const BasicTranscodingStreamBuf&) = delete;
+    BasicTranscodingStreamBuf& operator=(const BasicTranscodingStreamBuf&) = delete;
+
+    /**
+     * @brief 出力先を設定する
+     * @param sink UTF8 を受け取る streambuf (std::filebuf 等) このオブジェクトより長く存在する事
+     */
+    explicit BasicTranscodingStreamBuf(std::streambuf* sink) noexcept : sink_(sink)
+    {
+        this->setp(units_, units_ + ChunkUnits);
+    }
+
+    ~BasicTranscodingStreamBuf() { finish(); }
+
+    /// 出力先を返す
+    auto sink() const noexcept -> std::streambuf* { return sink_; }
+
+    /**
+     * @brief 残りを全て変換して出力先へ渡す
+     *
+     * 対になっていないハイサロゲートも置き換えて書き込む
+     *
+     * @return 出力先が全て受け取ったか
+     */
+    auto finish() -> bool
+    {
+        return Flush(true) && sink_->pubsync() == 0;
+    }
+
+protected:
+
+    auto overflow(int_type c) -> int_type override
+    {
+        if (!Flush(false)) return Traits::eof();
+        if (Traits::eq_int_type(c, Traits::eof())) return Traits::not_eof(c);
+        *this->pptr() = Traits::to_char_type(c);
+        this->pbump(1);
+        return c;
+    }
+
+    /// 持ち越すハイサロゲート以外を渡す
+    auto sync() -> int override
+    {
+        return (Flush(false) && sink_->pubsync() == 0) ? 0 : -1;
+    }
+
+private:
+
+    /// 書き込まれた分を変換して渡し、持ち越す分をバッファの先頭へ移す
+    auto Flush(bool final) -> bool
+    {
+        auto begin = this->pbase();
+        auto end = this->pptr();
+        auto carry = std::size_t {};
+        if constexpr (StringStreamImplement::UnitSize<Char> == 2) {
+            if (!final && begin != end && (char16_t(end[-1]) & 0xfc00) == 0xd800) {
+                carry = 1;
+                --end;
+            }
+        }
+
+        auto units = std::size_t(end - begin);
+        auto last = StringStreamImplement::UnitSize<Char> == 2
+            ? EncodingImplement::UTF16ToUTF8(begin, units, bytes_)
+            : EncodingImplement::UTF32ToUTF8(begin, units, bytes_);
+        auto size = std::streamsize(last - bytes_);
+        auto ok = !size || sink_->sputn(bytes_, size) == size;
+
+        if (carry) units_[0] = *end;
+        this->setp(units_, units_ + ChunkUnits);
+        this->pbump(int(carry));
+        return ok;
+    }
+
+    /// 出力先
+    std::streambuf* sink_;
+
+    /// 書き込まれた UTF16, UTF32
+    Char units_[ChunkUnits];
+
+    /// 変換した UTF8 (UTF16 は1ユニットで最大3バイト, UTF32 は最大4バイト)
+    char bytes_[ChunkUnits * (StringStreamImplement::UnitSize<Char> == 2 ? 3 : 4)];
+};
+
+/**
+ * @brief UTF16, UTF32 で書き込んで UTF8 で出力する出力ストリーム
+ *
+ * char16_t, char32_t の basic_ostream は標準ライブラリに数値の facet が無いので、
+ * 数値は BasicStringBuilder で組み立ててから書き込む
+ *
+ * @code
+ * std::ofstream file("out.txt", std::ios::binary);
+ * Pits::BasicTranscodingStream<char16_t> out(file);
+ * out << u"\u3042" << u'\n';
+ * @endcode
+ */
+template <class Char, class Traits = std::char_traits<Char>>
+class BasicTranscodingStream
+    : private StringStreamImplement::BufferHolder<BasicTranscodingStreamBuf<Char, Traits>>
+    , public std::basic_ostream<Char, Traits>
+{
+    using holder = StringStreamImplement::BufferHolder<BasicTranscodingStreamBuf<Char, Traits>>;
+
+public:
+
+    /// 基底となる basic_ostream の型
+    using ostream = std::basic_ostream<Char, Traits>;
+
+    /// バッファデバイスとなる streambuf の型
+    using transcodingbuf = BasicTranscodingStreamBuf<Char, Traits>;
+
+    /**
+     * @brief 出力先の streambuf を設定する
+     * @param sink UTF8 を受け取る streambuf このオブジェクトより長く存在する事
+     */
+    explicit BasicTranscodingStream(std::streambuf* sink) : holder(sink), ostream(&this->buffer_) {}
+
+    /**
+     * @brief 出力先のストリームを設定する
+     * @param sink UTF8 を受け取るストリーム このオブジェクトより長く存在する事
+     */
+    explicit BasicTranscodingStream(std::ostream& sink) : BasicTranscodingStream(sink.rdbuf()) {}
+
+    /// バッファデバイスを返す
+    auto rdbuf() const noexcept -> transcodingbuf* { return const_cast<transcodingbuf*>(&this->buffer_); }
+
+    /// 残りを全て変換して出力先へ渡す 失敗すると badbit を立てる
+    auto finish() -> bool
+    {
+        auto ok = this->buffer_.finish();
+        if (!ok) this->setstate(std::ios_base::badbit);
+        return ok;
+    }
+};
+
+/*
+ *
+ */
 
 } // namespace Pits
 
@@ -0,0 +1,132 @@
+﻿/**
+ * @brief 文字列を複写せずに行とトークンに分けて読む
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/TextReader.hpp"
+#include "Pits/Encoding.hpp"
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+namespace {
+
+using EncodingImplement::CountTrailingZeros;
+
+/// SIMD で比べる区切り文字の最大数
+constexpr auto Lanes = 8;
+
+/**
+ * @brief 集合のいずれかのバイトを探す
+ * @param it 開始位置
+ * @param end 終了位置
+ * @param set バイトの集合 (Lanes 個まで)
+ * @param count 集合の要素数
+ * @return 見つかった位置 無ければ end
+ */
+auto FindAny(const char* it, const char* end, const char* set, int count) noexcept -> const char*
+{
+#ifdef PITS_ENCODING_SSE2
+    __m128i vs[Lanes];
+    for (auto i = 0; i < count; ++i) vs[i] = _mm_set1_epi8(set[i]);
+    for (; end - it >= 16; it += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        auto m = _mm_cmpeq_epi8(v, vs[0]);
+        for (auto i = 1; i < count; ++i) m = _mm_or_si128(m, _mm_cmpeq_epi8(v, vs[i]));
+        if (auto mask = unsigned(_mm_movemask_epi8(m))) return it + CountTrailingZeros(mask);
+    }
+#endif
+    for (; it != end; ++it) {
+        for (auto i = 0; i < count; ++i) {
+            if (*it == set[i]) return it;
+        }
+    }
+    return end;
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+TextReader::TextReader(std::string_view text, std::string_view delimiters) noexcept : text_(text)
+{
+    for (auto c : delimiters) {
+        auto b = static_cast<unsigned char>(c);
+        // ASCII 以外は UTF8 の文字の途中で区切ってしまうので使わない
+        if (b >= 0x80 || IsDelimiter(c)) continue;
+        table_[b / 64] |= std::uint64_t(1) << (b % 64);
+        if (count_ < Lanes) delimiters_[count_] = c;
+        ++count_;
+    }
+}
+
+auto TextReader::FindDelimiter(std::size_t pos) const noexcept -> std::size_t
+{
+    auto begin = text_.data();
+    auto end = begin + text_.size();
+    if (!count_) return text_.size();
+    if (count_ <= Lanes) return std::size_t(FindAny(begin + pos, end, delimiters_, count_) - begin);
+
+    auto it = begin + pos;
+    while (it != end && !IsDelimiter(*it)) ++it;
+    return std::size_t(it - begin);
+}
+
+auto TextReader::ReadLine(std::string_view& line) noexcept -> bool
+{
+    if (pos_ == text_.size()) return false;
+    auto begin = text_.data();
+    auto newline = '\n';
+    auto found = std::size_t(FindAny(begin + pos_, begin + text_.size(), &newline, 1) - begin);
+    auto last = found;
+    if (last != pos_ && last != text_.size() && text_[last - 1] == '\r') --last;
+    line = text_.substr(pos_, last - pos_);
+    pos_ = found == text_.size() ? found : found + 1;
+    return true;
+}
+
+auto TextReader::ReadToken(std::string_view& token) noexcept -> bool
+{
+    // 区切り文字の並びは短いので1バイトずつ読み飛ばす
+    while (pos_ != text_.size() && IsDelimiter(text_[pos_])) ++pos_;
+    if (pos_ == text_.size()) return false;
+    auto found = FindDelimiter(pos_);
+    token = text_.substr(pos_, found - pos_);
+    pos_ = found;
+    return true;
+}
+
+auto TextReader::ReadField(std::string_view& field) noexcept -> bool
+{
+    if (done_) return false;
+    auto found = FindDelimiter(pos_);
+    field = text_.substr(pos_, found - pos_);
+    if (found == text_.size()) {
+        pos_ = found;
+        done_ = true;
+    }
+    else {
+        pos_ = found + 1;
+    }
+    return true;
+}
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
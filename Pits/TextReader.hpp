@@ -0,0 +1,154 @@
+﻿/**
+ * @brief 文字列を複写せずに行とトークンに分けて読む
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_TEXTREADER_HPP_
+#define PITS_TEXTREADER_HPP_
+
+#include <charconv>     // from_chars
+#include <cstddef>      // size_t
+#include <cstdint>      // uint64_t
+#include <string_view>
+#include <system_error> // errc
+#include <type_traits>
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ * 文字列の読み取り
+ *
+ * operator>> と異なり、行とトークンは元の文字列を参照する string_view で返し複写しない
+ * BasicStringStream の str() を渡せばストリームの内容をそのまま読める
+ * 区切り文字はロケールに依らず指定した ASCII のバイトだけで、UTF8 の文字の途中では区切らない
+ * 区切り文字と改行は SSE2 が使える場合 16 バイト毎に探す (区切り文字が 8 種類以下の場合)
+ * 数値は std::from_chars で読むので、先頭の + と 16 進の 0x は受け付けない
+ */
+
+/**
+ * @brief 文字列を行, トークン, 数値に分けて読む
+ */
+class TextReader
+{
+public:
+
+    /// 既定の区切り文字 (空白, タブ, 改行)
+    static constexpr auto DefaultDelimiters = std::string_view(" \t\r\n");
+
+    /// 空の文字列を読む
+    TextReader() noexcept : TextReader(std::string_view()) {}
+
+    /**
+     * @brief 読む文字列を設定する
+     * @param text 読む文字列 TextReader と読んだ結果より長く存在する事
+     * @param delimiters トークンの区切り文字 ASCII 以外のバイトは無視する
+     */
+    explicit TextReader(std::string_view text, std::string_view delimiters = DefaultDelimiters) noexcept;
+
+    /// 読む文字列
+    auto text() const noexcept -> std::string_view { return text_; }
+
+    /// 次に読む位置
+    auto position() const noexcept -> std::size_t { return pos_; }
+
+    /// 未だ読んでいない部分
+    auto rest() const noexcept -> std::string_view { return text_.substr(pos_); }
+
+    /// 末尾まで読んだか (ReadField は末尾の区切り文字の後の空のフィールドがまだ読める)
+    auto eof() const noexcept -> bool { return pos_ == text_.size(); }
+
+    /**
+     * @brief 1行読む
+     * @param line 改行 (\n または \r\n) を除いた行 最後の行は改行が無くても良い
+     * @return 読めたか 全て読んでいれば偽
+     */
+    auto ReadLine(std::string_view& line) noexcept -> bool;
+
+    /**
+     * @brief 区切り文字の並びを読み飛ばしてトークンを1つ読む
+     * @param token 区切り文字を含まないトークン
+     * @return 読めたか トークンが残っていなければ偽
+     */
+    auto ReadToken(std::string_view& token) noexcept -> bool;
+
+    /**
+     * @brief 次の区切り文字までのフィールドを1つ読み、区切り文字を1つ読み飛ばす
+     *
+     * CSV の様に続く区切り文字の間と末尾の区切り文字の後は空のフィールドになる
+     *
+     * @param field 区切り文字を含まないフィールド
+     * @return 読めたか 最後のフィールドを読んでいれば偽
+     */
+    auto ReadField(std::string_view& field) noexcept -> bool;
+
+    /**
+     * @brief トークンを1つ読んで数値にする
+     * @param value 整数 (bool を除く) または浮動小数点数
+     * @return トークン全体が数値であったか 偽なら位置は変えない
+     */
+    template <class T>
+    auto Read(T& value) noexcept -> bool
+    {
+        static_assert((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>,
+            "TextReader::Read needs an integer or a floating point number");
+        auto pos = pos_;
+        auto token = std::string_view();
+        if (!ReadToken(token)) return false;
+        auto end = token.data() + token.size();
+        auto result = std::from_chars(token.data(), end, value);
+        if (result.ec != std::errc() || result.ptr != end) {
+            pos_ = pos;
+            return false;
+        }
+        return true;
+    }
+
+private:
+
+    /// pos 以降の最初の区切り文字の位置 無ければ末尾
+    auto FindDelimiter(std::size_t pos) const noexcept -> std::size_t;
+
+    /// 区切り文字か
+    auto IsDelimiter(char c) const noexcept -> bool
+    {
+        auto b = static_cast<unsigned char>(c);
+        return (table_[b / 64] >> (b % 64)) & 1;
+    }
+
+    /// 読む文字列
+    std::string_view text_;
+
+    /// 次に読む位置
+    std::size_t pos_ {};
+
+    /// ReadField で最後のフィールドを読んだか
+    bool done_ {};
+
+    /// 区切り文字 (SIMD 用)
+    char delimiters_[8] {};
+    int count_ {};
+
+    /// 区切り文字の表 (バイト値毎のビット)
+    std::uint64_t table_[4] {};
+};
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
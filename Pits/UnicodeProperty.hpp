@@ -0,0 +1,153 @@
+﻿/**
+ * @brief ユニコードの文字の性質 (一般カテゴリ, 用字, 改行クラス)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_UNICODEPROPERTY_HPP_
+#define PITS_UNICODEPROPERTY_HPP_
+
+#include "Pits/UnicodeTable.hpp"
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ * 文字の性質
+ *
+ * テーブルはビルド時に ucd/UnicodeData.txt, ucd/Scripts.txt, ucd/LineBreak.txt から生成する
+ * 2段テーブル (1 ブロック 128 文字) なので1回の参照は2回の読み込みで済み、
+ * 各テーブルは 40KB 程度に収まる
+ * 全て constexpr なので static_assert でも使える
+ *
+ * 割り当ての無いコードポイントと範囲外の値は既定値 (Cn, Unknown, XX) を返す
+ *
+ * 参考
+ * - General_Category   ... https://www.unicode.org/reports/tr44/#General_Category_Values
+ * - Script             ... https://www.unicode.org/reports/tr24/
+ * - Line_Break         ... https://www.unicode.org/reports/tr14/
+ */
+
+/// 一般カテゴリ (General_Category) 値の名前は短縮名
+using GeneralCategory = UnicodeTable::GeneralCategory;
+
+/// 用字 (Script) 値の名前は Scripts.txt の表記
+using Script = UnicodeTable::Script;
+
+/// 改行クラス (Line_Break) 値の名前は短縮名
+using LineBreak = UnicodeTable::LineBreak;
+
+/**
+ * @brief 一般カテゴリを返す
+ * @param c 文字
+ * @return 一般カテゴリ
+ */
+constexpr auto GetGeneralCategory(char32_t c) noexcept -> GeneralCategory
+{
+    return GeneralCategory(UnicodeTable::GetGeneralCategory(c));
+}
+
+/**
+ * @brief 用字を返す
+ * @param c 文字
+ * @return 用字
+ */
+constexpr auto GetScript(char32_t c) noexcept -> Script
+{
+    return Script(UnicodeTable::GetScript(c));
+}
+
+/**
+ * @brief 改行クラスを返す
+ * @param c 文字
+ * @return 改行クラス
+ */
+constexpr auto GetLineBreak(char32_t c) noexcept -> LineBreak
+{
+    return LineBreak(UnicodeTable::GetLineBreak(c));
+}
+
+/**
+ * @brief 用字の名前を返す
+ * @param script 用字
+ * @return Scripts.txt の表記 ("Latin", "Han" 等)
+ */
+constexpr auto GetScriptName(Script script) noexcept -> std::string_view
+{
+    return UnicodeTable::ScriptNames[std::size_t(script)];
+}
+
+/*
+ * 一般カテゴリの大分類
+ * GeneralCategory は大分類毎に並んでいる
+ */
+
+/// 文字 (L) か返す
+constexpr auto IsLetter(char32_t c) noexcept -> bool
+{
+    auto gc = GetGeneralCategory(c);
+    return GeneralCategory::Lu <= gc && gc <= GeneralCategory::Lo;
+}
+
+/// 結合文字 (M) か返す
+constexpr auto IsMark(char32_t c) noexcept -> bool
+{
+    auto gc = GetGeneralCategory(c);
+    return GeneralCategory::Mn <= gc && gc <= GeneralCategory::Me;
+}
+
+/// 数字 (N) か返す
+constexpr auto IsNumber(char32_t c) noexcept -> bool
+{
+    auto gc = GetGeneralCategory(c);
+    return GeneralCategory::Nd <= gc && gc <= GeneralCategory::No;
+}
+
+/// 句読点 (P) か返す
+constexpr auto IsPunctuation(char32_t c) noexcept -> bool
+{
+    auto gc = GetGeneralCategory(c);
+    return GeneralCategory::Pc <= gc && gc <= GeneralCategory::Po;
+}
+
+/// 記号 (S) か返す
+constexpr auto IsSymbol(char32_t c) noexcept -> bool
+{
+    auto gc = GetGeneralCategory(c);
+    return GeneralCategory::Sm <= gc && gc <= GeneralCategory::So;
+}
+
+/// 区切り (Z) か返す
+constexpr auto IsSeparator(char32_t c) noexcept -> bool
+{
+    auto gc = GetGeneralCategory(c);
+    return GeneralCategory::Zs <= gc && gc <= GeneralCategory::Zp;
+}
+
+/// 割り当て済みか返す (Cn 以外)
+constexpr auto IsAssigned(char32_t c) noexcept -> bool
+{
+    return GetGeneralCategory(c) != GeneralCategory::Cn;
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
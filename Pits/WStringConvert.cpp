@@ -0,0 +1,74 @@
+﻿/**
+ * @brief std::wstring_convert を置き換えるロケール非依存の変換
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/WStringConvert.hpp"
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+auto WStringConvert::from_bytes(char byte) -> wide_string
+{
+    return from_bytes(&byte, &byte + 1);
+}
+
+auto WStringConvert::from_bytes(const char* ptr) -> wide_string
+{
+    return from_bytes(ptr, ptr + std::char_traits<char>::length(ptr));
+}
+
+auto WStringConvert::from_bytes(const byte_string& str) -> wide_string
+{
+    return from_bytes(str.data(), str.data() + str.size());
+}
+
+auto WStringConvert::from_bytes(const char* first, const char* last) -> wide_string
+{
+    converted_ = std::size_t(last - first);
+    return ToWString(std::string_view(first, converted_));
+}
+
+auto WStringConvert::to_bytes(wchar_t wchar) -> byte_string
+{
+    return to_bytes(&wchar, &wchar + 1);
+}
+
+auto WStringConvert::to_bytes(const wchar_t* wptr) -> byte_string
+{
+    return to_bytes(wptr, wptr + std::char_traits<wchar_t>::length(wptr));
+}
+
+auto WStringConvert::to_bytes(const wide_string& wstr) -> byte_string
+{
+    return to_bytes(wstr.data(), wstr.data() + wstr.size());
+}
+
+auto WStringConvert::to_bytes(const wchar_t* first, const wchar_t* last) -> byte_string
+{
+    converted_ = std::size_t(last - first);
+    return ToString(std::wstring_view(first, converted_));
+}
+
+auto WStringConvert::converted() const noexcept -> std::size_t
+{
+    return converted_;
+}
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,136 @@
+﻿/**
+ * @brief std::wstring_convert を置き換えるロケール非依存の変換
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_WSTRINGCONVERT_HPP_
+#define PITS_WSTRINGCONVERT_HPP_
+
+#include <cstddef>      // size_t
+#include <string>
+#include <string_view>
+
+#include "Pits/String.hpp"
+#include "Pits/Encoding.hpp"
+
+/*
+ *
+ */
+
+namespace Pits {
+
+/*
+ *
+ */
+
+/// L"" が UTF16, UTF32 どちらかでなければ変換出来ない
+static_assert(String::WideCharEncoding == String::UTF16 || String::WideCharEncoding == String::UTF32);
+
+/**
+ * @brief UTF8 を std::wstring にする
+ *
+ * wchar_t が UTF16, UTF32 どちらであるかはビルド時に String::WideCharEncoding で選ぶ
+ * 不正なシーケンスは置き換える
+ *
+ * @param from UTF8 文字列
+ * @return ワイド文字列
+ */
+inline auto ToWString(std::string_view from) -> std::wstring
+{
+    if constexpr (String::WideCharEncoding == String::UTF16) {
+        return EncodingImplement::UTF8ToUTF16<wchar_t>(from);
+    }
+    else {
+        return EncodingImplement::UTF8ToUTF32<wchar_t>(from);
+    }
+}
+
+/**
+ * @brief std::wstring を UTF8 にする
+ *
+ * wchar_t が UTF16, UTF32 どちらであるかはビルド時に String::WideCharEncoding で選ぶ
+ * 不正なシーケンスは置き換える
+ *
+ * @param from ワイド文字列
+ * @return UTF8 文字列
+ */
+inline auto ToString(std::wstring_view from) -> std::string
+{
+    if constexpr (String::WideCharEncoding == String::UTF16) {
+        return EncodingImplement::UTF16ToUTF8(from.data(), from.size());
+    }
+    else {
+        return EncodingImplement::UTF32ToUTF8(from.data(), from.size());
+    }
+}
+
+/**
+ * @brief std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> 等の置き換え
+ *
+ * ロケールと codecvt を使わず ToWString, ToString で変換する
+ * std::wstring_convert と違い不正なシーケンスは例外を投げずに置き換える
+ */
+class WStringConvert
+{
+public:
+
+    /// バイト文字列の型
+    using byte_string = std::string;
+
+    /// ワイド文字列の型
+    using wide_string = std::wstring;
+
+    WStringConvert(const WStringConvert&) = delete;
+    WStringConvert& operator=(const WStringConvert&) = delete;
+
+    WStringConvert() noexcept = default;
+
+    /// UTF8 をワイド文字列にする
+    auto from_bytes(char byte) -> wide_string;
+
+    /// UTF8 をワイド文字列にする
+    auto from_bytes(const char* ptr) -> wide_string;
+
+    /// UTF8 をワイド文字列にする
+    auto from_bytes(const byte_string& str) -> wide_string;
+
+    /// UTF8 をワイド文字列にする
+    auto from_bytes(const char* first, const char* last) -> wide_string;
+
+    /// ワイド文字列を UTF8 にする
+    auto to_bytes(wchar_t wchar) -> byte_string;
+
+    /// ワイド文字列を UTF8 にする
+    auto to_bytes(const wchar_t* wptr) -> byte_string;
+
+    /// ワイド文字列を UTF8 にする
+    auto to_bytes(const wide_string& wstr) -> byte_string;
+
+    /// ワイド文字列を UTF8 にする
+    auto to_bytes(const wchar_t* first, const wchar_t* last) -> byte_string;
+
+    /// 直前の変換で読み込んだユニット数を返す
+    auto converted() const noexcept -> std::size_t;
+
+private:
+
+    /// 直前の変換で読み込んだユニット数
+    std::size_t converted_ {};
+};
+
+/*
+ *
+ */
+
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
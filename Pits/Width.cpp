@@ -0,0 +1,184 @@
+﻿/**
+ * @brief 等幅表示の幅 (UAX #11)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#include "Pits/Width.hpp"
+#include "Pits/Encoding.hpp"
+#include "Pits/Grapheme.hpp"
+#include "Pits/UnicodeTable.hpp"
+#include <algorithm>    // max
+#include <cstdint>      // uint8_t
+#include <limits>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ *
+ */
+
+namespace {
+
+using namespace UnicodeTable;
+
+/// 絵文字表示の異体字セレクタ
+constexpr auto EmojiPresentationSelector = char32_t(0xfe0f);
+
+/// 半角の濁点と半濁点か (Extend だが 1 桁を使う)
+constexpr auto IsHalfwidthSoundMark(char32_t c) noexcept -> bool
+{
+    return c == 0xff9e || c == 0xff9f;
+}
+
+/// Width の値から幅を返す
+constexpr auto ToWidth(std::uint8_t value, AmbiguousWidth ambiguous) noexcept -> std::size_t
+{
+    auto width = value & WidthMask;
+    if (width == WidthAmbiguous) return ambiguous == AmbiguousWidth::Wide ? 2 : 1;
+    return width;
+}
+
+/// ASCII の幅を返す 制御文字は 0
+template <class Char>
+constexpr auto ASCIIWidth(Char c) noexcept -> std::size_t
+{
+    return (0x20 <= c && c < 0x7f) ? 1 : 0;
+}
+
+/**
+ * @brief ASCII の範囲の幅を返す
+ * @param begin 開始位置 ASCII だけである事
+ * @param end 終了位置
+ */
+template <class Char>
+auto CountASCII(const Char* begin, const Char* end) noexcept -> std::size_t
+{
+    auto width = std::size_t {};
+    auto it = begin;
+#ifdef PITS_ENCODING_SSE2
+    // 16 バイト毎に表示できる文字を 1 にして合計する
+    constexpr auto lanes = 16 / sizeof(Char);
+    auto sum = _mm_setzero_si128();
+    for (; std::size_t(end - it) >= lanes; it += lanes) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        auto printable = (sizeof(Char) == 1)
+            ? _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1f)), _mm_cmplt_epi8(v, _mm_set1_epi8(0x7f)))
+            : _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16(0x1f)), _mm_cmplt_epi16(v, _mm_set1_epi16(0x7f)));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_and_si128(printable, _mm_set1_epi8(1)), _mm_setzero_si128()));
+    }
+    auto high = _mm_unpackhi_epi64(sum, sum);
+    width = std::size_t(_mm_cvtsi128_si32(sum)) + std::size_t(_mm_cvtsi128_si32(high));
+    if (sizeof(Char) == 2) width /= 2;
+#endif
+    for (; it != end; ++it) width += ASCIIWidth(*it);
+    return width;
+}
+
+/// 書記素クラスタの幅を返す
+template <class Char>
+auto ClusterWidth(const Char* it, const Char* end, AmbiguousWidth ambiguous) noexcept -> std::size_t
+{
+    auto first = GetWidth(NextPoint(it, end));
+    auto width = ToWidth(first, ambiguous);
+    while (it != end) {
+        auto c = NextPoint(it, end);
+        if (c == EmojiPresentationSelector && (first & WidthEmoji)) return 2;
+        if (IsHalfwidthSoundMark(c)) {
+            width += 1;
+        } else {
+            width = std::max(width, ToWidth(GetWidth(c), ambiguous));
+        }
+    }
+    return width;
+}
+
+/// 幅を測った結果
+struct Measured {
+    std::size_t units;  // 収まった先頭部分のユニット数
+    std::size_t width;  // その幅
+};
+
+/**
+ * @brief 幅が limit 以下になる最長の先頭部分を測る
+ * @param text 文字列
+ * @param limit 表示幅の上限
+ * @param ambiguous 曖昧な幅の扱い
+ */
+template <class Char>
+auto Measure(std::basic_string_view<Char> text, std::size_t limit, AmbiguousWidth ambiguous) noexcept -> Measured
+{
+    auto begin = text.data();
+    auto end = begin + text.size();
+    auto width = std::size_t {};
+    auto it = begin;
+    while (it != end) {
+        if (char32_t(*it) <= 0x7f) {
+            // 最後の ASCII は後の結合文字等とクラスタになり得るので残す
+            // CR LF は共に幅 0 なので間で切る事は無い
+            auto run = EncodingImplement::SkipASCII(it, end);
+            auto stop = (run == end) ? run : run - 1;
+            auto count = CountASCII(it, stop);
+            if (limit - width < count) {
+                for (; ASCIIWidth(*it) <= limit - width; ++it) width += ASCIIWidth(*it);
+                return {std::size_t(it - begin), width};
+            }
+            width += count;
+            it = stop;
+            if (it == end) break;
+        }
+        auto next = begin + NextGraphemeBoundary(text, std::size_t(it - begin));
+        auto cluster = ClusterWidth(it, next, ambiguous);
+        if (limit - width < cluster) break;
+        width += cluster;
+        it = next;
+    }
+    return {std::size_t(it - begin), width};
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+auto CharacterWidth(char32_t c, AmbiguousWidth ambiguous) noexcept -> std::size_t
+{
+    return ToWidth(GetWidth(c), ambiguous);
+}
+
+auto DisplayWidth(std::string_view text, AmbiguousWidth ambiguous) noexcept -> std::size_t
+{
+    return Measure(text, std::numeric_limits<std::size_t>::max(), ambiguous).width;
+}
+
+auto DisplayWidth(std::u16string_view text, AmbiguousWidth ambiguous) noexcept -> std::size_t
+{
+    return Measure(text, std::numeric_limits<std::size_t>::max(), ambiguous).width;
+}
+
+auto TruncateToWidth(std::string_view text, std::size_t width, AmbiguousWidth ambiguous) noexcept -> std::string_view
+{
+    return text.substr(0, Measure(text, width, ambiguous).units);
+}
+
+auto TruncateToWidth(std::u16string_view text, std::size_t width, AmbiguousWidth ambiguous) noexcept -> std::u16string_view
+{
+    return text.substr(0, Measure(text, width, ambiguous).units);
+}
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
@@ -0,0 +1,111 @@
+﻿/**
+ * @brief 等幅表示の幅 (UAX #11)
+ * @author Yukio KANEDA
+ * @file
+ */
+
+#ifndef PITS_WIDTH_HPP_
+#define PITS_WIDTH_HPP_
+
+#include <cstddef>      // size_t
+#include <string_view>
+
+/*
+ *
+ */
+
+namespace Pits {
+namespace Unicode {
+
+/*
+ * 表示幅
+ *
+ * テーブルはビルド時に ucd/EastAsianWidth.txt, ucd/UnicodeData.txt, ucd/emoji-data.txt から生成する
+ * ロケールに依存せず、wcwidth の代わりに使う
+ *
+ * - W, F (全角) と Emoji_Presentation は 2
+ * - 結合文字 (Mn, Me), 書式文字 (Cf, U+00AD を除く), 制御文字 (Cc), ハングルの中声と終声は 0
+ * - A (曖昧) は AmbiguousWidth に従う
+ * - その他は 1
+ *
+ * 文字列の幅は書記素クラスタ毎に数え、クラスタの幅はクラスタ内の最大の幅とする
+ * Emoji の後に U+FE0F (絵文字表示) があるクラスタは 2 とする
+ * 半角の濁点と半濁点 (U+FF9E, U+FF9F) は前の文字とクラスタになるが 1 を加える
+ *
+ * 参考
+ * - UAX #11    ... https://www.unicode.org/reports/tr11/
+ */
+
+/// 曖昧な幅 (East_Asian_Width=A) の扱い
+enum class AmbiguousWidth {
+    Narrow, // 1 (欧文の端末)
+    Wide,   // 2 (CJK の端末)
+};
+
+/**
+ * @brief 文字の幅を返す
+ * @param c 文字
+ * @param ambiguous 曖昧な幅の扱い
+ * @return 0, 1, 2 のいずれか
+ */
+auto CharacterWidth(char32_t c, AmbiguousWidth ambiguous = AmbiguousWidth::Narrow) noexcept -> std::size_t;
+
+/**
+ * @brief 文字列の表示幅を返す
+ *
+ * ASCII は 16 バイト毎にまとめて制御文字以外を数える
+ * 不正なシーケンスは置換文字 (幅 1) として数える
+ *
+ * @param text UTF8 文字列
+ * @param ambiguous 曖昧な幅の扱い
+ * @return 表示幅
+ */
+auto DisplayWidth(std::string_view text, AmbiguousWidth ambiguous = AmbiguousWidth::Narrow) noexcept -> std::size_t;
+
+/**
+ * @brief 文字列の表示幅を返す
+ * @param text UTF16 文字列
+ * @param ambiguous 曖昧な幅の扱い
+ * @return 表示幅
+ */
+auto DisplayWidth(std::u16string_view text, AmbiguousWidth ambiguous = AmbiguousWidth::Narrow) noexcept -> std::size_t;
+
+/**
+ * @brief 表示幅に収まる先頭部分を返す
+ *
+ * 書記素クラスタの途中では切らない
+ *
+ * @param text UTF8 文字列
+ * @param width 表示幅
+ * @param ambiguous 曖昧な幅の扱い
+ * @return 表示幅が width 以下になる最長の先頭部分
+ */
+auto TruncateToWidth(std::string_view text, std::size_t width, AmbiguousWidth ambiguous = AmbiguousWidth::Narrow) noexcept
+    -> std::string_view;
+
+/**
+ * @brief 表示幅に収まる先頭部分を返す
+ * @param text UTF16 文字列
+ * @param width 表示幅
+ * @param ambiguous 曖昧な幅の扱い
+ * @return 表示幅が width 以下になる最長の先頭部分
+ */
+auto TruncateToWidth(std::u16string_view text, std::size_t width, AmbiguousWidth ambiguous = AmbiguousWidth::Narrow) noexcept
+    -> std::u16string_view;
+
+/*
+ *
+ */
+
+} // namespace Unicode
+} // namespace Pits
+
+/*
+ *
+ */
+
+#endif
+
+/*
+ *
+ */
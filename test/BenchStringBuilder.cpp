@@ -0,0 +1,86 @@
+﻿#include "Pits/StringStream.hpp"
+#include "Pits/Timer.hpp"
+#include <cassert>
+#include <string_view>
+#include <iostream>
+
+template <class Job>
+auto Bench(Job job) -> double {
+    Pits::Timer begin;
+    job();
+    auto elapsed = begin.GetElapsed();
+    std::cout << elapsed << std::endl;
+    return elapsed;
+}
+
+constexpr auto DefinedNDEBUG =
+#ifdef NDEBUG
+true;
+#else
+false;
+#endif
+
+constexpr auto Records = (DefinedNDEBUG ? 1000000 : 10000);
+
+/// ログの1行 (文字列, 整数, 浮動小数点数のフィールド)
+template <class Stream>
+void Format(Stream& out, int i) {
+    out << "id=" << i << " user=" << "guest" << " size=" << i * 37u << " ratio=" << i * 0.25 << " ok=" << (i & 1) << '\n';
+}
+
+int main() {
+
+    auto checksum1 = std::size_t {};
+    auto checksum2 = std::size_t {};
+
+    std::cout << "Bench StringBuilder (" << Records << " records, 7 fields)" << std::endl;
+
+    std::cout << "BasicStringStream: ";
+    auto stream = Bench([&] {
+        for (int i = 0; i < Records; ++i) {
+            Pits::BasicStringStream<char> ss;
+            Format(ss, i);
+            checksum1 += ss.str().size();
+        }
+    });
+
+    std::cout << "BasicStringStream (reused): ";
+    auto reused = Bench([&] {
+        Pits::BasicStringStream<char> ss;
+        for (int i = 0; i < Records; ++i) {
+            ss.stringstream::str({});
+            Format(ss, i);
+            checksum1 += ss.str().size();
+        }
+    });
+
+    std::cout << "BasicStringStream (pooled): ";
+    auto pooled = Bench([&] {
+        for (int i = 0; i < Records; ++i) {
+            auto ss = Pits::AcquireStringStream();
+            Format(*ss, i);
+            checksum1 += ss->str().size();
+        }
+    });
+
+    std::cout << "StringBuilder: ";
+    auto builder = Bench([&] {
+        for (int i = 0; i < Records; ++i) {
+            Pits::StringBuilder sb;
+            Format(sb, i);
+            checksum2 += sb.str().size();
+        }
+    });
+
+    // 浮動小数点数の表現が異なるので長さが同じ整数だけ比べる
+    Pits::BasicStringStream<char> ss;
+    Pits::StringBuilder sb;
+    ss << 123 << "abc" << 4567u;
+    sb << 123 << "abc" << 4567u;
+    assert(ss.str() == sb.str());
+    (void)checksum1;
+    (void)checksum2;
+
+    std::cout << "speed-up x" << stream / builder << " (reused stream x" << reused / builder << ", pooled stream x" << pooled / builder << ")" << std::endl;
+    return 0;
+}
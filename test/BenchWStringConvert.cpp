@@ -0,0 +1,97 @@
+﻿#include "Pits/WStringConvert.hpp"
+#include "Pits/Timer.hpp"
+#include <uchar.h>
+#include <cassert>
+#include <string_view>
+#include <iostream>
+#include <locale>
+#include <codecvt>
+
+using namespace std::literals;
+
+template <class Job>
+auto Bench(Job job) -> double {
+    Pits::Timer begin;
+    job();
+    auto elapsed = begin.GetElapsed();
+    std::cout << elapsed << std::endl;
+    return elapsed;
+}
+
+constexpr auto DefinedNDEBUG =
+#ifdef NDEBUG
+true;
+#else
+false;
+#endif
+
+constexpr auto BenchTimes = (DefinedNDEBUG ? 100 : 1);
+
+/// 約 1MB の文字列を作る
+auto MakeCorpus(std::string_view phrase) -> std::string {
+    auto corpus = std::string {};
+    while (corpus.size() < 1024 * 1024) corpus += phrase;
+    return corpus;
+}
+
+/// std::wstring_convert と Pits の変換を比べる
+template <class StdConvert, class PitsFromBytes, class PitsToBytes>
+void Compare(const char* name, const std::string& corpus, StdConvert conv, PitsFromBytes from_bytes, PitsToBytes to_bytes) {
+
+    using wide_string = decltype(conv.from_bytes(corpus));
+    wide_string w1, w2;
+    std::string s1, s2;
+
+    std::cout << name << " std from_bytes: ";
+    auto std_from = Bench([&] { for (int j = 0; j < BenchTimes; ++j) w1 = conv.from_bytes(corpus); });
+    std::cout << name << " Pits from_bytes: ";
+    auto pits_from = Bench([&] { for (int j = 0; j < BenchTimes; ++j) w2 = from_bytes(corpus); });
+    std::cout << name << " std to_bytes: ";
+    auto std_to = Bench([&] { for (int j = 0; j < BenchTimes; ++j) s1 = conv.to_bytes(w1); });
+    std::cout << name << " Pits to_bytes: ";
+    auto pits_to = Bench([&] { for (int j = 0; j < BenchTimes; ++j) s2 = to_bytes(w2); });
+
+    assert(w1 == w2);
+    assert(s1 == s2);
+    std::cout << name << " speed-up from_bytes x" << std_from / pits_from
+        << " to_bytes x" << std_to / pits_to << std::endl;
+}
+
+int main() {
+
+#if defined(__STDC_UTF_16__) && defined(__STDC_UTF_32__)
+
+    const std::string corpora[][2] = {
+        {"ASCII", MakeCorpus(u8"The quick brown fox jumps over the lazy dog. 0123456789\n")},
+        {"Japanese", MakeCorpus(u8"吾輩は猫である。名前はまだ無い。どこで生れたかとんと見当がつかぬ。\n")},
+        {"Mixed", MakeCorpus(u8"Log: ユーザー😀 login from 192.168.0.1 (𐐷漢字) status=OK\n")},
+    };
+
+    std::cout << "Bench WStringConvert (1MB corpus) x " << BenchTimes << std::endl;
+    for (auto& corpus : corpora) {
+
+        auto name16 = corpus[0] + " UTF16";
+        Compare(name16.c_str(), corpus[1],
+            std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>(),
+            [](const std::string& s) { return Pits::ToUTF16(s); },
+            [](const std::u16string& s) { return Pits::ToUTF8(s); });
+
+        auto namew = corpus[0] + " wchar_t";
+        if constexpr (Pits::String::WideCharEncoding == Pits::String::UTF16) {
+            Compare(namew.c_str(), corpus[1],
+                std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>(),
+                [](const std::string& s) { return Pits::ToWString(s); },
+                [](const std::wstring& s) { return Pits::ToString(s); });
+        }
+        else {
+            Compare(namew.c_str(), corpus[1],
+                std::wstring_convert<std::codecvt_utf8<wchar_t>>(),
+                [](const std::string& s) { return Pits::ToWString(s); },
+                [](const std::wstring& s) { return Pits::ToString(s); });
+        }
+    }
+
+#endif
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+﻿#include "Pits/CaseFold.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using Pits::Unicode::CaseFolding;
+
+int main() {
+
+    {
+        // 単純変換
+        assert(Pits::Unicode::ToLower(U'A') == U'a');
+        assert(Pits::Unicode::ToUpper(U'ß') == U'ß');
+        assert(Pits::Unicode::ToUpper(U'ǆ') == U'Ǆ');
+        assert(Pits::Unicode::ToTitle(U'ǆ') == U'ǅ');
+        assert(Pits::Unicode::ToLower(U'Ａ') == U'ａ');
+        assert(Pits::Unicode::ToUpper(U'𐐨') == U'𐐀');
+        assert(Pits::Unicode::ToLower(U'漢') == U'漢');
+        assert(Pits::Unicode::ToLower(0x110000) == 0x110000);
+    }
+    {
+        // 単純畳み込みと完全畳み込み
+        assert(Pits::Unicode::SimpleCaseFold(U'ẞ') == U'ß');
+        assert(Pits::Unicode::SimpleCaseFold(U'ς') == U'σ');
+        assert(Pits::Unicode::SimpleCaseFold(U'K') == U'k');
+        char32_t out[Pits::Unicode::CaseFoldMax];
+        assert(Pits::Unicode::FullCaseFold(U'ẞ', out) == 2 && out[0] == U's' && out[1] == U's');
+        assert(Pits::Unicode::FullCaseFold(U'ΐ', out) == 3 && out[0] == U'ι');
+        assert(Pits::Unicode::FullCaseFold(U'a', out) == 1 && out[0] == U'a');
+    }
+    {
+        // UTF8 の畳み込み
+        assert(Pits::Unicode::FoldCase(u8"Hello WORLD 0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZ"sv) == u8"hello world 0123456789 abcdefghijklmnopqrstuvwxyz"sv);
+        assert(Pits::Unicode::FoldCase(u8"Straße STRASSE ẞ"sv) == u8"strasse strasse ss"sv);
+        assert(Pits::Unicode::FoldCase(u8"Straße ẞ"sv, CaseFolding::Simple) == u8"straße ß"sv);
+        assert(Pits::Unicode::FoldCase(u8"ΣΊΣΥΦΟΣ Ａｂｃ 𐐀"sv) == u8"σίσυφοσ ａｂｃ 𐐨"sv);
+        assert(Pits::Unicode::FoldCase(u8"İ"sv) == u8"i\u0307"sv);
+        assert(Pits::Unicode::FoldCase("ABC\xff"sv) == u8"abc�"sv);
+        assert(Pits::Unicode::FoldCase(U"ẞ Σ"sv) == U"ss σ"sv);
+
+        // 展開で長くなる場合
+        auto long8 = std::string(1000, '\0');
+        auto expect = std::string {};
+        for (auto i = std::size_t {}; i < 500; ++i) {
+            long8.replace(i * 2, 2, u8"ΐ");
+            expect += u8"ι\u0308\u0301";
+        }
+        assert(Pits::Unicode::FoldCase(long8) == expect);
+    }
+    {
+        // 変わらない場合は入力をそのまま返す
+        auto sv = u8"already folded テキスト 0123456789"sv;
+        auto buffer = std::string {};
+        assert(Pits::Unicode::FoldCase(sv, CaseFolding::Full, buffer).data() == sv.data());
+        auto r = Pits::Unicode::FoldCase(u8"already folded テキスト 0123456789 X"sv, CaseFolding::Full, buffer);
+        assert(r.data() == buffer.data() && r == u8"already folded テキスト 0123456789 x"sv);
+    }
+
+    return 0;
+}
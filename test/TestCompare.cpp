@@ -0,0 +1,73 @@
+﻿#include "Pits/Compare.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <map>
+
+using namespace std::literals;
+
+int main() {
+
+    {
+        // エンコーディングが異なっても同じ文字列は一致する
+        auto s8 = u8"0123456789abcdef 漢字 😀 0123456789abcdef かなカナ 0123456789abcdef"sv;
+        auto s16 = u"0123456789abcdef 漢字 😀 0123456789abcdef かなカナ 0123456789abcdef"sv;
+        auto s32 = U"0123456789abcdef 漢字 😀 0123456789abcdef かなカナ 0123456789abcdef"sv;
+        assert(Pits::Compare(s8, s16) == 0);
+        assert(Pits::Compare(s16, s32) == 0);
+        assert(Pits::Compare(s32, s8) == 0);
+        assert(Pits::Compare(s8, s8) == 0);
+        assert(Pits::Hash(s8) == Pits::Hash(s16));
+        assert(Pits::Hash(s8) == Pits::Hash(s32));
+        assert(Pits::Hash(s8) != Pits::Hash(s8.substr(1)));
+    }
+    {
+        // 前方一致は短い方が小さい
+        assert(Pits::Compare(u8"0123456789abcdef0123"sv, u"0123456789abcdef012"sv) > 0);
+        assert(Pits::Compare(u"0123456789abcdef012"sv, U"0123456789abcdef0123"sv) < 0);
+        assert(Pits::Compare(""sv, u""sv) == 0);
+        assert(Pits::Compare(""sv, U"a"sv) < 0);
+        // 16 ユニットの ASCII 比較の途中の差異
+        assert(Pits::Compare(u8"0123456789abcdeF0123"sv, U"0123456789abcdef0123"sv) < 0);
+        assert(Pits::Compare(u"0123456789abcdef0123"sv, U"0123456789abcdeF0123"sv) > 0);
+    }
+    {
+        // UTF16 のユニット順ではなくコードポイント順になる
+        assert(u"｡"sv > u"\U0001F600"sv);
+        assert(Pits::Compare(u"｡"sv, u"\U0001F600"sv) < 0);
+        assert(Pits::Compare(u8"｡"sv, u"\U0001F600"sv) < 0);
+        assert(Pits::Compare(U"\U0001F600"sv, u"｡"sv) > 0);
+        // ASCII 以外の値は ASCII と等しくならない
+        assert(Pits::Compare(u"0123456789abcdeŁ"sv, U"0123456789abcdeA"sv) > 0);
+        assert(Pits::Compare(U"0123456789abcde\U00010041"sv, u"0123456789abcdeA"sv) > 0);
+    }
+    {
+        // 不正な並びは置き換え文字として扱う
+        auto bad8 = "abc\xff" "def\xe3\x81"sv;
+        auto bad16 = u"abc\xd800" u"def"sv;
+        assert(Pits::Compare(bad8, u"abc�def�"sv) == 0);
+        assert(Pits::Hash(bad8) == Pits::Hash(U"abc�def�"sv));
+        assert(Pits::Compare(bad16, u8"abc�def"sv) == 0);
+        assert(Pits::Hash(bad16) == Pits::Hash(u8"abc�def"sv));
+        assert(Pits::Hash(U"a\U00110000"sv) == Pits::Hash(u"a�"sv));
+    }
+    {
+        // 異なるエンコーディングのキーで検索する
+        auto map = std::unordered_map<std::u16string, int, Pits::UnicodeHash, Pits::UnicodeEqual> {};
+        map[u"漢字"] = 1;
+        map[u"😀"] = 2;
+        assert(map.at(u"漢字") == 1);
+        assert(map.count(u"😀") == 1);
+        assert(Pits::UnicodeHash()(u8"漢字"sv) == Pits::UnicodeHash()(u"漢字"sv));
+        assert(Pits::UnicodeEqual()(u8"漢字"sv, U"漢字"sv));
+
+        auto ordered = std::map<std::u32string, int, Pits::UnicodeLess> {};
+        ordered[U"｡"] = 1;
+        ordered[U"\U0001F600"] = 2;
+        assert(ordered.begin()->second == 1);
+        assert(ordered.find(u8"😀"sv) != ordered.end());
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+﻿#include "Pits/DoubleArray.hpp"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+int main() {
+
+    {
+        // 完全一致
+        auto keys = std::vector<std::string_view> {"東京"sv, "東京都"sv, "京都"sv, "東"sv, "abc"sv, "a\0b"sv};
+        auto dic = Pits::DoubleArray(keys);
+        assert(!dic.empty() && dic.size() == 6);
+        assert(*dic.Find("東京") == 0);
+        assert(*dic.Find("東京都") == 1);
+        assert(*dic.Find("京都") == 2);
+        assert(*dic.Find("a\0b"sv) == 5);
+        assert(!dic.Find("東京タワー"));
+        assert(!dic.Find("東京都\xe5"));
+        assert(!dic.Find("ab"));
+        assert(!dic.Find(""));
+
+        // 移動元は構築していない辞書になる
+        auto moved = std::move(dic);
+        assert(moved.size() == 6 && *moved.Find("京都") == 2);
+        assert(!dic.IsBuilt() && dic.empty() && dic.bytes().empty() && !dic.Find("京都"));
+        auto other = Pits::DoubleArray(std::vector<std::string_view> {"x"sv});
+        other = std::move(moved);
+        assert(other.size() == 6 && *other.Find("東京都") == 1);
+        assert(!moved.IsBuilt() && moved.size() == 0 && !moved.Find("東京"));
+        dic = std::move(other);
+        assert(dic.size() == 6 && *dic.Find("abc") == 4);
+    }
+
+    {
+        // 前方一致
+        std::string_view keys[] {"東"sv, "東京"sv, "東京都"sv, "京"sv};
+        std::uint32_t values[] {10, 20, 30, 40};
+        auto dic = Pits::DoubleArray(keys, values, 4);
+
+        Pits::DoubleArrayMatch matches[4] {};
+        auto text = "東京都庁"sv;
+        assert(dic.CommonPrefixSearch(text, matches, 4) == 3);
+        assert(matches[0].length == 3 && matches[0].value == 10);
+        assert(matches[1].length == 6 && matches[1].value == 20);
+        assert(matches[2].length == 9 && matches[2].value == 30);
+        assert(dic.CommonPrefixSearch(text, matches, 1) == 3);
+        assert(dic.CommonPrefixSearch("大阪"sv, matches, 4) == 0);
+
+        auto match = Pits::DoubleArrayMatch {};
+        assert(dic.LongestPrefix(text, match) && match.length == 9 && match.value == 30);
+        assert(dic.LongestPrefix("東西"sv, match) && match.length == 3 && match.value == 10);
+        assert(!dic.LongestPrefix("西"sv, match));
+    }
+
+    {
+        // 重複と空のキー 整列していないキー
+        std::string_view keys[] {"b"sv, ""sv, "a"sv, "b"sv};
+        std::uint32_t values[] {1, 2, 3, 4};
+        auto dic = Pits::DoubleArray(keys, values, 4);
+        assert(dic.size() == 3);
+        assert(*dic.Find("b") == 1);
+        assert(*dic.Find("") == 2);
+        auto match = Pits::DoubleArrayMatch {};
+        assert(dic.LongestPrefix("x"sv, match) && match.length == 0 && match.value == 2);
+
+        // 空の辞書
+        assert(Pits::DoubleArray().empty() && !Pits::DoubleArray().IsBuilt());
+        assert(!Pits::DoubleArray().Find("a"));
+
+        // キーが無い辞書
+        auto none = Pits::DoubleArray(keys, values, 0);
+        assert(none.IsBuilt() && none.empty() && none.size() == 0 && !none.Find(""));
+        assert(!none.LongestPrefix("a"sv, match));
+        auto copy = Pits::DoubleArray::Attach(none.bytes().data(), none.bytes().size());
+        assert(copy.IsBuilt() && copy.empty());
+    }
+
+    {
+        // 直列化した表現を参照する
+        auto keys = std::vector<std::string> {};
+        for (auto i = 0; i < 5000; ++i) {
+            keys.push_back("キー" + std::to_string(i * 7919 % 100000));
+        }
+        auto dic = Pits::DoubleArray(keys);
+        auto bytes = dic.bytes();
+        auto image = std::vector<std::uint32_t>(bytes.size() / 4);
+        std::memcpy(image.data(), bytes.data(), bytes.size());
+
+        auto attached = Pits::DoubleArray::Attach(image.data(), bytes.size());
+        assert(attached.IsBuilt() && attached.size() == keys.size());
+        for (auto i = std::size_t {}; i < keys.size(); ++i) {
+            assert(*attached.Find(keys[i]) == i);
+        }
+        assert(!attached.Find("キー"));
+        assert(attached.bytes() == bytes);
+
+        // 正しくない表現
+        assert(!Pits::DoubleArray::Attach(image.data(), bytes.size() - 8).IsBuilt());
+        assert(Pits::DoubleArray::Attach(image.data(), 4).empty());
+        image[0] = 0;
+        assert(Pits::DoubleArray::Attach(image.data(), bytes.size()).empty());
+    }
+
+    return 0;
+}
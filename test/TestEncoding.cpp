@@ -3,6 +3,7 @@
 #include <uchar.h>
 #include <cassert>
 #include <string_view>
+#include <vector>
 #include <iostream>
 #include <codecvt>
 
@@ -166,6 +167,177 @@ int main() {
         assert(u16.size() <= Pits::Unicode::UTF8UnitsToUTF16Units(sv.size()));
         assert(u32.size() <= Pits::Unicode::UTF8UnitsToUTF32Units(sv.size()));
     }
+    {
+        auto sv = u8"𐐷漢字😀 ASCII"sv;
+        assert(Pits::IsSanitizedUTF8(sv));
+        assert(Pits::SanitizedUTF8Units(sv) == sv.size());
+        assert(Pits::SanitizeUTF8(sv) == sv);
+    }
+    {
+        // 往復変換と同じ結果になる事
+        std::string_view cases[] = {
+            "\xC0\xAF\xE0\x80\xBF\xF0\x81\x82\x41"sv,
+            "\xED\xA0\x80\xED\xBF\xBF\xED\xAF\x41"sv,
+            "\xF4\x91\x92\x93\xFF\x41\x80\xBF\x42"sv,
+            "\xE1\x80\xE2\xF0\x91\x92\xF1\xBF\x41"sv,
+            "0123456789abcdef\xEF\xBF\xBE" "0123456789abcdef\xBF\xBF"sv,
+        };
+        for (auto sv : cases) {
+            std::u32string u32;
+            Pits::EncodingUTF8ToUTF32(sv.begin(), sv.end(), std::inserter(u32, u32.end()));
+            std::u8string u8;
+            Pits::EncodingUTF32ToUTF8(u32.begin(), u32.end(), std::inserter(u8, u8.end()));
+            std::u8string direct;
+            Pits::EncodingUTF8ToUTF8(sv.begin(), sv.end(), std::inserter(direct, direct.end()));
+            assert(!Pits::IsSanitizedUTF8(sv));
+            assert(direct == u8);
+            assert(Pits::SanitizeUTF8(sv) == u8);
+            assert(Pits::SanitizedUTF8Units(sv) == u8.size());
+            assert(Pits::IsSanitizedUTF8(u8));
+        }
+    }
+    {
+        // 末尾の不完全なシーケンスは最大部分毎に置き換える
+        assert(Pits::SanitizeUTF8("A\xE1\x80"sv) == u8"A\uFFFD"sv);
+        assert(Pits::SanitizeUTF8("A\xE0\x80"sv) == u8"A\uFFFD\uFFFD"sv);
+        assert(Pits::SanitizeUTF8("A\xF0\x9F\x98"sv) == u8"A\uFFFD"sv);
+        assert(Pits::SanitizedUTF8Units("A\xF0\x9F\x98"sv) == 4);
+    }
+    {
+        // 対になっていないサロゲートも WTF8 で往復できる事
+        auto sv = u"\xd800" u"abc\xdc00\U0001F600\xdbff"sv;
+        auto wtf8 = Pits::EncodeWTF8(sv);
+        assert(wtf8 == "\xED\xA0\x80" "abc" "\xED\xB0\x80" "\xF0\x9F\x98\x80" "\xED\xAF\xBF"sv);
+        assert(Pits::DecodeWTF8(wtf8) == sv);
+
+        std::u8string out;
+        auto r = Pits::EncodingUTF16ToWTF8(sv.begin(), sv.end(), std::inserter(out, out.end()));
+        assert(std::get<0>(r) == sv.end() - 1);
+        assert(out == wtf8.substr(0, wtf8.size() - 3));
+
+        std::u16string back;
+        Pits::EncodingWTF8ToUTF16(wtf8.begin(), wtf8.end(), std::inserter(back, back.end()));
+        assert(back == sv);
+
+        // 正しい UTF8 は UTF8 として読める
+        auto utf8 = Pits::EncodeWTF8(u"𐐷漢字😀"sv);
+        assert(utf8 == u8"𐐷漢字😀"sv);
+        assert(Pits::DecodeWTF8("\xC0\xAF\xF0\x9F"sv) == u"\uFFFD\uFFFD\uFFFD");
+
+        // 3ユニットのサロゲートの対は合成しない
+        auto cesu = "\xED\xA0\xBD\xED\xB8\x80" "a\xED\xB8\x80"sv;
+        auto decoded = Pits::DecodeWTF8(cesu);
+        assert(decoded == u"\xd83d\xfffd" u"a\xde00"sv);
+        std::u16string pair;
+        Pits::EncodingWTF8ToUTF16(cesu.begin(), cesu.end(), std::inserter(pair, pair.end()));
+        assert(pair == decoded);
+        assert(Pits::EncodeWTF8(decoded) == "\xED\xA0\xBD\xEF\xBF\xBD" "a\xED\xB8\x80"sv);
+    }
+    {
+        // CESU8 はサロゲート毎に3ユニット
+        auto sv = u"A\U0001F600\xdc00"sv;
+        auto cesu8 = Pits::EncodeCESU8(sv);
+        assert(cesu8 == "A" "\xED\xA0\xBD\xED\xB8\x80" "\xED\xB0\x80"sv);
+        assert(Pits::DecodeCESU8(cesu8) == sv);
+        assert(Pits::DecodeCESU8("\xF0\x9F\x98\x80"sv) == u"\uFFFD\uFFFD\uFFFD\uFFFD");
+
+        std::u8string out;
+        Pits::EncodingUTF16ToCESU8(sv.begin(), sv.end(), std::inserter(out, out.end()));
+        assert(out == cesu8);
+        std::u16string back;
+        Pits::EncodingCESU8ToUTF16(cesu8.begin(), cesu8.end(), std::inserter(back, back.end()));
+        assert(back == sv);
+    }
+    {
+        // Modified UTF8 はヌル文字を c0 80 で表現する
+        auto sv = u"0123456789\0abcdef\U0001F600"sv;
+        auto mutf8 = Pits::EncodeModifiedUTF8(sv);
+        assert(mutf8 == "0123456789\xC0\x80" "abcdef" "\xED\xA0\xBD\xED\xB8\x80"sv);
+        assert(Pits::DecodeModifiedUTF8(mutf8) == sv);
+        assert(Pits::DecodeCESU8("\xC0\x80"sv) == u"\uFFFD\uFFFD");
+
+        std::u8string out;
+        Pits::EncodingUTF16ToCESU8(sv.begin(), sv.end(), std::inserter(out, out.end()), true);
+        assert(out == mutf8);
+        std::u16string back;
+        Pits::EncodingCESU8ToUTF16(mutf8.begin(), mutf8.end(), std::inserter(back, back.end()), true);
+        assert(back == sv);
+    }
+    {
+        // 複数の文字列を1つの領域にまとめて変換する
+        std::vector<std::string_view> views {u8"abc"sv, ""sv, u8"漢字😀"sv, "A\xFF"sv};
+        auto u16 = Pits::ToUTF16Batch(views);
+        assert(u16.size() == 4);
+        assert(u16[0] == u"abc"sv);
+        assert(u16[1].empty());
+        assert(u16[2] == u"漢字😀"sv);
+        assert(u16[3] == u"A\uFFFD"sv);
+        assert(u16.offsets()[2] == 3 && u16.units() == 3 + 4 + 2);
+        assert(u16[1].data() == u16.data() + 3);
+
+        auto u32 = Pits::ToUTF32Batch(views.data(), views.size());
+        assert(u32.units() == 3 + 3 + 2);
+        assert(u32[2] == U"漢字😀"sv);
+
+        std::u16string_view u16views[] {u16[0], u16[2], u"\xd800"sv};
+        auto u8 = Pits::ToUTF8Batch(u16views);
+        assert(u8.size() == 3);
+        assert(u8[0] == "abc"sv && u8[1] == views[2] && u8[2] == u8"\uFFFD"sv);
+
+        auto none = Pits::ToUTF8Batch(u16views, 0);
+        assert(none.empty() && none.units() == 0);
+        assert(Pits::BatchString<char>().empty());
+
+        // 移動元は空になる
+        auto moved = std::move(u32);
+        assert(moved.size() == 4 && moved[2] == U"漢字😀"sv);
+        assert(u32.empty() && u32.size() == 0 && u32.units() == 0);
+        assert(!u32.data() && !u32.offsets());
+        none = std::move(u8);
+        assert(none.size() == 3 && none[0] == "abc"sv);
+        assert(u8.empty() && u8.units() == 0 && !u8.data());
+    }
+    {
+        // 1文字前を読み込む
+        auto text = "a\xc3\xa9\xe6\xbc\xa2\xf0\x9f\x98\x80\x80"sv;
+        auto begin = text.data();
+        auto end = begin + text.size();
+        auto it = end;
+        assert(Pits::PreviousPoint(begin, it, end) == U'\uFFFD' && it == end - 1);
+        assert(Pits::PreviousPoint(begin, it, end) == U'\U0001F600' && it == begin + 6);
+        assert(Pits::PreviousPoint(begin, it, end) == U'\u6F22' && it == begin + 3);
+        assert(Pits::PreviousPoint(begin, it, end) == U'\u00E9' && it == begin + 1);
+        assert(Pits::PreviousPoint(begin, it, end) == U'a' && it == begin);
+
+        auto u16 = u"a\U0001F600\xdc00"sv;
+        auto u16it = u16.data() + u16.size();
+        assert(Pits::PreviousPoint(u16.data(), u16it, u16it) == U'\uFFFD' && u16it == u16.data() + 3);
+        assert(Pits::PreviousPoint(u16.data(), u16it, u16it + 1) == U'\U0001F600' && u16it == u16.data() + 1);
+
+        // 文字の途中で切らずに切り詰める
+        auto kanji = u8"漢字😀"sv;
+        assert(Pits::TruncateUnits(kanji, 100) == kanji);
+        assert(Pits::TruncateUnits(kanji, 6) == u8"漢字"sv);
+        assert(Pits::TruncateUnits(kanji, 5) == u8"漢"sv);
+        assert(Pits::TruncateUnits(kanji, 9) == u8"漢字"sv);
+        assert(Pits::TruncateUnits(kanji, 2).empty());
+        assert(Pits::TruncateUnits("a\x80\x80\x80\x80"sv, 3) == "a\x80\x80"sv);
+        assert(Pits::TruncateUnits(u"a\U0001F600"sv, 2) == u"a"sv);
+        assert(Pits::TruncateUnits(u"a\U0001F600"sv, 3) == u"a\U0001F600"sv);
+
+        // 末尾の文字
+        assert(Pits::LastPoints(kanji, 1) == u8"😀"sv);
+        assert(Pits::LastPoints(kanji, 2) == u8"字😀"sv);
+        assert(Pits::LastPoints(kanji, 10) == kanji);
+        assert(Pits::LastPoints(kanji, 0).empty());
+        auto long_text = std::string(40, 'a') + u8"漢字仮名交じり文" + std::string(20, 'b');
+        assert(Pits::LastPoints(long_text, 21) == u8"文"s + std::string(20, 'b'));
+        assert(Pits::LastPoints(long_text, 28) == u8"漢字仮名交じり文"s + std::string(20, 'b'));
+        assert(Pits::LastPoints(long_text, 30).size() == 2 + 8 * 3 + 20);
+        auto long_u16 = std::u16string(20, u'a') + u"\U0001F600\U0001F600" + std::u16string(9, u'b');
+        assert(Pits::LastPoints(long_u16, 10) == u"\U0001F600"s + std::u16string(9, u'b'));
+        assert(Pits::LastPoints(long_u16, 11).size() == 4 + 9);
+    }
 
 #endif
 
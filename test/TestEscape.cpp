@@ -0,0 +1,100 @@
+﻿#include "Pits/Escape.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+
+int main() {
+
+    // JSON
+    {
+        assert(Pits::EscapeJSON("plain"sv) == "plain");
+        assert(Pits::EscapeJSON("a\"b\\c\n\t\x01"sv) == "a\\\"b\\\\c\\n\\t\\u0001");
+        assert(Pits::EscapeJSON("\b\f\r\x1f"sv) == "\\b\\f\\r\\u001f");
+
+        // ASCII 以外はそのまま、または \uXXXX
+        auto text = "\u3042\U0001F600"sv;
+        assert(Pits::EscapeJSON(text) == text);
+        assert(Pits::EscapeJSON(text, Pits::EscapeOutput::ASCII) == "\\u3042\\ud83d\\ude00");
+
+        // 不正なシーケンスは置き換える 元からある置換文字はそのまま
+        assert(Pits::EscapeJSON("a\xff" "b\xef\xbf\xbd"sv) == "a\xef\xbf\xbd" "b\xef\xbf\xbd");
+
+        // 16 バイトを超える並び
+        auto longer = std::string(40, 'x') + "\"" + std::string(20, 'y') + "\u00e9" + std::string(17, 'z') + "\n";
+        auto expected = std::string(40, 'x') + "\\\"" + std::string(20, 'y') + "\u00e9" + std::string(17, 'z') + "\\n";
+        assert(Pits::EscapeJSON(longer) == expected);
+
+        // 追加する
+        auto out = std::string("\"");
+        Pits::EscapeJSON("x\"y"sv, out);
+        out += '"';
+        assert(out == "\"x\\\"y\"");
+    }
+
+    // UTF16, UTF32 の JSON
+    {
+        auto text16 = u"abc\"\u3042\n\U0001F600"sv;
+        assert(Pits::EscapeJSON(text16) == "abc\\\"\u3042\\n\U0001F600");
+        assert(Pits::EscapeJSON(text16, Pits::EscapeOutput::ASCII) == "abc\\\"\\u3042\\n\\ud83d\\ude00");
+
+        auto longer = std::u16string(20, u'x') + u"\\" + std::u16string(9, u'y') + u"\u00e9";
+        assert(Pits::EscapeJSON(longer) == std::string(20, 'x') + "\\\\" + std::string(9, 'y') + "\u00e9");
+
+        // 対になっていないサロゲート
+        auto lone = std::u16string(u"a") + char16_t(0xd800) + u"b";
+        assert(Pits::EscapeJSON(lone) == "a\xef\xbf\xbd" "b");
+
+        auto text32 = U"\t\u3042\U0001F600<"sv;
+        assert(Pits::EscapeJSON(text32) == "\\t\u3042\U0001F600<");
+        assert(Pits::EscapeJSON(text32, Pits::EscapeOutput::ASCII) == "\\t\\u3042\\ud83d\\ude00<");
+    }
+
+    // HTML
+    {
+        assert(Pits::EscapeHTML("<a href=\"x\">Tom & Jerry's</a>"sv)
+               == "&lt;a href=&quot;x&quot;&gt;Tom &amp; Jerry&#39;s&lt;/a&gt;");
+        assert(Pits::EscapeHTML("\u00e9\u3042\U0001F600"sv) == "\u00e9\u3042\U0001F600");
+        assert(Pits::EscapeHTML("\u00e9\u3042\U0001F600"sv, Pits::EscapeOutput::ASCII) == "&#xe9;&#x3042;&#x1f600;");
+        assert(Pits::EscapeHTML(u"x<\u3042>"sv) == "x&lt;\u3042&gt;");
+        assert(Pits::EscapeHTML(U"x&\U0001F600"sv, Pits::EscapeOutput::ASCII) == "x&amp;&#x1f600;");
+
+        auto longer = std::string(33, 'x') + "&" + std::string(16, 'y');
+        assert(Pits::EscapeHTML(longer) == std::string(33, 'x') + "&amp;" + std::string(16, 'y'));
+
+        // 制御文字はそのまま
+        assert(Pits::EscapeHTML("a\nb"sv) == "a\nb");
+    }
+
+    // JSON のエスケープを戻す
+    {
+        std::string out;
+        assert(Pits::UnescapeJSON("a\\\"b\\\\c\\/d\\n\\t\\b\\f\\r"sv, out));
+        assert(out == "a\"b\\c/d\n\t\b\f\r");
+
+        // サロゲートペアは1文字にする
+        out.clear();
+        assert(Pits::UnescapeJSON("\\u3042\\uD83D\\uDE00\\u00e9"sv, out));
+        assert(out == "\u3042\U0001F600\u00e9");
+
+        // 対になっていないサロゲートは置き換える
+        out.clear();
+        assert(Pits::UnescapeJSON("\\ud83dx\\ude00"sv, out));
+        assert(out == "\xef\xbf\xbdx\xef\xbf\xbd");
+
+        // 往復
+        auto text = std::string(30, 'x') + "\"\u3042\U0001F600\x01" + std::string(20, 'y');
+        out.clear();
+        assert(Pits::UnescapeJSON(Pits::EscapeJSON(text, Pits::EscapeOutput::ASCII), out));
+        assert(out == text);
+
+        // 不正なエスケープ
+        out.clear();
+        assert(!Pits::UnescapeJSON("ab\\x"sv, out) && out == "ab");
+        assert(!Pits::UnescapeJSON("\\u12"sv, out));
+        assert(!Pits::UnescapeJSON("end\\"sv, out));
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+﻿#include "Pits/Grapheme.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+/// 分割した書記素クラスタを返す
+template <class Char>
+auto Split(std::basic_string_view<Char> text) -> std::vector<std::basic_string_view<Char>>
+{
+    auto result = std::vector<std::basic_string_view<Char>>();
+    for (auto g : Pits::Unicode::Graphemes(text)) result.push_back(g);
+    return result;
+}
+
+/// 全ての位置で前後の境界と判定が分割と一致するか
+template <class Char>
+auto Consistent(std::basic_string_view<Char> text) -> bool
+{
+    auto boundaries = std::vector<bool>(text.size() + 1);
+    for (auto pos = std::size_t {}; pos < text.size(); pos = Pits::Unicode::NextGraphemeBoundary(text, pos)) {
+        boundaries[pos] = true;
+    }
+    boundaries[text.size()] = true;
+    auto count = std::size_t {};
+    for (auto pos = std::size_t {}; pos <= text.size(); ++pos) {
+        if (Pits::Unicode::IsGraphemeBoundary(text, pos) != boundaries[pos]) return false;
+        if (pos && boundaries[pos]) {
+            ++count;
+            auto prev = Pits::Unicode::PreviousGraphemeBoundary(text, pos);
+            if (!boundaries[prev]) return false;
+            for (auto i = prev + 1; i < pos; ++i) {
+                if (boundaries[i]) return false;
+            }
+        }
+    }
+    return count == Pits::Unicode::CountGraphemes(text);
+}
+
+} // namespace
+
+int main() {
+
+    {
+        // ASCII と CR LF
+        auto text = "ab\r\ncd\n\r"sv;
+        assert(Pits::Unicode::CountGraphemes(text) == 7);
+        assert(Split(text)[2] == "\r\n"sv);
+        assert(!Pits::Unicode::IsGraphemeBoundary(text, 3));
+        assert(Pits::Unicode::IsGraphemeBoundary(text, 0));
+        assert(Pits::Unicode::IsGraphemeBoundary(text, text.size()));
+        assert(!Pits::Unicode::IsGraphemeBoundary(text, text.size() + 1));
+        assert(Pits::Unicode::CountGraphemes(""sv) == 0);
+        assert(Split(""sv).empty());
+        assert(Consistent(text));
+    }
+
+    {
+        // 結合文字
+        auto text = "e\u0301\u0323x\u0915\u093f"sv;
+        auto s = Split(text);
+        assert(s.size() == 3);
+        assert(s[0] == "e\xcc\x81\xcc\xa3"sv);
+        assert(s[1] == "x"sv);
+        assert(s[2] == "\xe0\xa4\x95\xe0\xa4\xbf"sv);
+    }
+
+    {
+        // ハングル字母
+        auto text = "\xe1\x84\x80\xe1\x85\xa1\xe1\x86\xa8\xea\xb0\x80\xe1\x86\xa8"sv;   // L V T LV T
+        assert(Pits::Unicode::CountGraphemes(text) == 2);
+        assert(Pits::Unicode::NextGraphemeBoundary(text, 0) == 9);
+        assert(Consistent(text));
+    }
+
+    {
+        // 国旗 (Regional_Indicator の組)
+        auto text = "\xf0\x9f\x87\xaf\xf0\x9f\x87\xb5\xf0\x9f\x87\xba\xf0\x9f\x87\xb8\xf0\x9f\x87\xab"sv;  // JP US F
+        auto s = Split(text);
+        assert(s.size() == 3);
+        assert(s[0].size() == 8 && s[1].size() == 8 && s[2].size() == 4);
+        assert(Pits::Unicode::IsGraphemeBoundary(text, 8));
+        assert(!Pits::Unicode::IsGraphemeBoundary(text, 12));
+        assert(Pits::Unicode::PreviousGraphemeBoundary(text, 16) == 8);
+        assert(Consistent(text));
+    }
+
+    {
+        // 絵文字の ZWJ シーケンス
+        auto family = "\xf0\x9f\x91\xa8\xe2\x80\x8d\xf0\x9f\x91\xa9\xe2\x80\x8d\xf0\x9f\x91\xa7"sv;
+        assert(Pits::Unicode::CountGraphemes(family) == 1);
+        auto skin = "\xf0\x9f\x91\x8d\xf0\x9f\x8f\xbd!"sv;    // 肌の色の修飾
+        assert(Pits::Unicode::CountGraphemes(skin) == 2);
+        auto text = "a\xe2\x80\x8d\xf0\x9f\x91\xa9"sv;       // ExtPict 以外の後の ZWJ
+        assert(Pits::Unicode::CountGraphemes(text) == 2);
+        assert(Pits::Unicode::IsGraphemeBoundary(text, 4));
+        assert(!Pits::Unicode::IsGraphemeBoundary(family, 7));
+        assert(!Pits::Unicode::IsGraphemeBoundary(family, 1));  // 文字の途中
+        assert(Consistent(family));
+        assert(Consistent(text));
+    }
+
+    {
+        // CJK の並びと結合する濁点, 結合文字
+        auto text = "\u6f22\u5b57\u304b\u3099\u30ab\u30fc\u4e00\u0301a\u3042"sv;
+        auto s = Split(text);
+        assert(s.size() == 8);
+        assert(s[2] == "\u304b\u3099"sv);
+        assert(s[5] == "\u4e00\u0301"sv);
+        assert(Pits::Unicode::CountGraphemes(text) == 8);
+        assert(Pits::Unicode::NextGraphemeBoundary(text, 0) == 3);
+        assert(Pits::Unicode::NextGraphemeBoundary(text, 6) == 12);
+        assert(!Pits::Unicode::IsGraphemeBoundary(text, 9));
+        assert(Consistent(text));
+        assert(Consistent(u"\u6f22\u5b57\u304b\u3099\u30ab\u4e00\u0301a\u3042"sv));
+        assert(Pits::Unicode::CountGraphemes(u"\u6f22\u5b57\u304b\u3099\u30ab\u4e00\u0301a\u3042"sv) == 7);
+    }
+
+    {
+        // 不正なシーケンスは置換文字として数える
+        auto text = "a\x80\xe3\x81" "b\xcc\x81"sv;
+        assert(Pits::Unicode::CountGraphemes(text) == 4);
+        assert(Consistent(text));
+    }
+
+    {
+        // UTF16
+        auto text = u"\U0001f468\u200d\U0001f469a\u0301\r\n\U0001f1ef\U0001f1f5"sv;
+        auto s = Split(text);
+        assert(s.size() == 4);
+        assert(s[0].size() == 5);
+        assert(s[1] == u"a\u0301"sv);
+        assert(Pits::Unicode::CountGraphemes(text) == 4);
+        assert(!Pits::Unicode::IsGraphemeBoundary(text, 1));
+        assert(Consistent(text));
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+﻿#include "Pits/JapaneseFold.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using namespace Pits::Unicode;
+
+int main() {
+
+    {
+        // 半角カナ
+        assert(FoldJapanese("ｶﾞｷﾞ"sv) == "ガギ");
+        assert(FoldJapanese("ﾊﾟﾋﾟﾌﾟ"sv) == "パピプ");
+        assert(FoldJapanese("ｳﾞ"sv) == "ヴ");
+        assert(FoldJapanese("ｱﾞ"sv) == "ア゛");
+        assert(FoldJapanese("ﾞ"sv) == "゛");
+        assert(FoldJapanese("｡｢｣､･ｰ"sv) == "。「」、・ー");
+        assert(FoldJapanese("ﾆﾎﾝｺﾞ"sv, FoldHalfwidthKatakana) == "ニホンゴ");
+    }
+
+    {
+        // 全角英数記号
+        assert(FoldJapanese("ＡＢＣ１２３"sv) == "ABC123");
+        assert(FoldJapanese("ｈｅｌｌｏ、　ｗｏｒｌｄ！"sv) == "hello、 world!");
+        assert(FoldJapanese("～"sv) == "~");
+    }
+
+    {
+        // 濁点と半濁点
+        assert(FoldJapanese("か\u3099"sv) == "ガ");
+        assert(FoldJapanese("は゛"sv) == "バ");
+        assert(FoldJapanese("ハ\u309a"sv) == "パ");
+        assert(FoldJapanese("ワ\u3099"sv) == "ヷ");
+        assert(FoldJapanese("あ\u3099"sv) == "ア\u3099");
+        assert(FoldJapanese("か\u3099"sv, FoldVoicedMarks) == "が");
+        assert(FoldJapanese("か\u3099"sv, FoldToKatakana) == "カ\u3099");
+    }
+
+    {
+        // ひらがなとカタカナ
+        assert(FoldJapanese("ひらがなゝゞ"sv) == "ヒラガナヽヾ");
+        assert(FoldJapanese("カタカナヽヾ"sv, FoldToHiragana) == "かたかなゝゞ");
+        assert(FoldJapanese("ヷヺヿ"sv, FoldToHiragana) == "ヷヺヿ");
+        assert(FoldJapanese("ひらがな"sv, FoldToKatakana | FoldToHiragana) == "ヒラガナ");
+        assert(FoldJapanese("ｶﾞ"sv, FoldHalfwidthKatakana | FoldToHiragana) == "が");
+    }
+
+    {
+        // 変わらない場合は入力をそのまま返す
+        auto buffer = std::string {};
+        auto text = "日本語 text カタカナ"sv;
+        auto result = FoldJapanese(text, FoldJapaneseDefault, buffer);
+        assert(result.data() == text.data());
+        assert(buffer.empty());
+        assert(FoldJapanese("ｶﾅ ＡＢＣ"sv, 0) == "ｶﾅ ＡＢＣ");
+
+        text = "長文 ASCII 前置 ........ ひらがな ........ 後置"sv;
+        result = FoldJapanese(text, FoldJapaneseDefault, buffer);
+        assert(result.data() == buffer.data());
+        assert(result == "長文 ASCII 前置 ........ ヒラガナ ........ 後置");
+    }
+
+    {
+        // 不正なシーケンス
+        assert(FoldJapanese("a\xff" "b"sv) == "a�b");
+        assert(FoldJapanese("\xe3\x81"sv) == "�");
+        assert(FoldJapanese("�"sv) == "�");
+
+        // 置換文字で入力より長くなる
+        auto buffer = std::string {};
+        auto text = std::string(20, '\xff') + "ｶﾞ" + std::string(20, '\x80');
+        auto result = FoldJapanese(text, FoldJapaneseDefault, buffer);
+        assert(result.size() == 40 * 3 + 3);
+        assert(result.substr(57, 9) == "�ガ�");
+    }
+
+    return 0;
+}
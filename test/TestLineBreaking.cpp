@@ -0,0 +1,153 @@
+﻿#include "Pits/LineBreaking.hpp"
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+using Pits::Unicode::LineBreakRule;
+
+namespace {
+
+/// 改行できる位置で分けた文字列を返す
+template <class Char>
+auto Split(std::basic_string_view<Char> text, LineBreakRule rule = LineBreakRule::Standard)
+    -> std::vector<std::basic_string_view<Char>>
+{
+    auto result = std::vector<std::basic_string_view<Char>>();
+    auto pos = std::size_t {};
+    for (auto point : Pits::Unicode::LineBreaks(text, rule)) {
+        result.push_back(text.substr(pos, point.position - pos));
+        pos = point.position;
+    }
+    return result;
+}
+
+/// ビットマップとイテレータが一致するか
+template <class Char>
+auto Consistent(std::basic_string_view<Char> text, LineBreakRule rule = LineBreakRule::Standard) -> bool
+{
+    auto breaks = std::vector<std::uint64_t>(Pits::Unicode::LineBreakBitmapSize(text.size()), ~std::uint64_t());
+    auto mandatory = breaks;
+    auto count = Pits::Unicode::FindLineBreaks(text, breaks.data(), mandatory.data(), rule);
+    auto bit = [](const std::vector<std::uint64_t>& bitmap, std::size_t i) { return (bitmap[i / 64] >> (i % 64)) & 1; };
+    auto expected = std::vector<bool>(text.size() + 1);
+    auto required = std::vector<bool>(text.size() + 1);
+    auto n = std::size_t {};
+    for (auto point : Pits::Unicode::LineBreaks(text, rule)) {
+        expected[point.position] = true;
+        required[point.position] = point.mandatory;
+        ++n;
+    }
+    for (auto i = std::size_t {}; i <= text.size(); ++i) {
+        if (bit(breaks, i) != expected[i] || bit(mandatory, i) != required[i]) return false;
+    }
+    return count == n;
+}
+
+} // namespace
+
+int main() {
+
+    {
+        // 英文 (LB18 空白の後, LB13 句読点の前, LB21 ハイフンの後)
+        auto s = Split("Hello, world! A well-known fact."sv);
+        assert(s.size() == 6);
+        assert(s[0] == "Hello, "sv);
+        assert(s[1] == "world! "sv);
+        assert(s[2] == "A "sv);
+        assert(s[3] == "well-"sv);
+        assert(s[4] == "known "sv);
+        assert(s[5] == "fact."sv);
+        assert(Consistent("Hello, world! A well-known fact."sv));
+    }
+
+    {
+        // 改行文字 (LB4, LB5)
+        auto text = "a\r\nb\nc"sv;
+        auto points = std::vector<Pits::Unicode::LineBreakPoint>();
+        for (auto p : Pits::Unicode::LineBreaks(text)) points.push_back(p);
+        assert(points.size() == 3);
+        assert(points[0].position == 3 && points[0].mandatory);
+        assert(points[1].position == 5 && points[1].mandatory);
+        assert(points[2].position == 6 && points[2].mandatory);
+        assert(Split(""sv).empty());
+        assert(Consistent(text));
+    }
+
+    {
+        // 数字 (LB25)
+        assert(Split("$(12.50) 100%"sv).size() == 2);
+        assert(Split("1,000円"sv).size() == 2);
+        assert(Split("a$("sv).size() == 2);
+    }
+
+    {
+        // 日本語 括弧と句読点の禁則
+        auto s = Split("「日本語」です。"sv);
+        assert(s.size() == 5);
+        assert(s[0] == "「日"sv);
+        assert(s[1] == "本"sv);
+        assert(s[2] == "語」"sv);
+        assert(s[3] == "で"sv);
+        assert(s[4] == "す。"sv);
+
+        // 和欧混在 (LB28 英単語の途中では改行しない)
+        auto m = Split("漢字とLatinの混在"sv);
+        assert(m.size() == 7);
+        assert(m[3] == "Latin"sv);
+        assert(Consistent("漢字とLatinの混在"sv));
+    }
+
+    {
+        // 小書きの仮名と長音記号は既定と日本語の規則で行頭に置かない
+        auto text = "ちょっとコーヒー"sv;
+        assert(Split(text, LineBreakRule::Loose).size() == 8);
+        assert(Consistent(text, LineBreakRule::Loose));
+        assert(Split(text).size() == 4);
+        auto s = Split(text, LineBreakRule::Japanese);
+        assert(s.size() == 4);
+        assert(s[0] == "ちょっ"sv);
+        assert(s[1] == "と"sv);
+        assert(s[2] == "コー"sv);
+        assert(s[3] == "ヒー"sv);
+        assert(Consistent(text, LineBreakRule::Japanese));
+    }
+
+    {
+        // 結合文字 (LB9), 非分割空白 (LB12), 絵文字 (LB30b), 国旗 (LB30a)
+        assert(Split("e\u0301 x"sv).size() == 2);
+        assert(Split("100 km"sv).size() == 1);
+        assert(Split("\U0001f466\U0001f3fb"sv).size() == 1);
+        assert(Split("\U0001f1ef\U0001f1f5\U0001f1fa\U0001f1f8"sv).size() == 2);
+        assert(Split("a\u200bb"sv).size() == 2);
+        assert(Split("a\u2060b"sv).size() == 1);
+    }
+
+    {
+        // UTF16
+        auto text = u"「テスト」、test."sv;
+        auto s = Split(text, LineBreakRule::Japanese);
+        assert(s.size() == 4);
+        assert(s[0] == u"「テ"sv);
+        assert(s[2] == u"ト」、"sv);
+        assert(s[3] == u"test."sv);
+        assert(Pits::Unicode::NextLineBreak(text, 0).position == 2);
+        assert(Pits::Unicode::NextLineBreak(text, text.size()).position == text.size());
+        assert(Consistent(text, LineBreakRule::Japanese));
+    }
+
+    {
+        // 64 ユニットを超えるビットマップ
+        auto text = std::string();
+        for (auto i = 0; i < 40; ++i) text += "word ";
+        auto breaks = std::vector<std::uint64_t>(Pits::Unicode::LineBreakBitmapSize(text.size()));
+        assert(Pits::Unicode::FindLineBreaks(text, breaks.data()) == 40);
+        assert((breaks[1] >> (65 - 64)) & 1);
+        assert((breaks[text.size() / 64] >> (text.size() % 64)) & 1);
+        assert(Consistent(std::string_view(text)));
+    }
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+﻿#include "Pits/Normalize.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using Pits::Unicode::NormalizationForm;
+using Pits::Unicode::QuickCheckResult;
+
+int main() {
+
+    {
+        // 分解と合成
+        auto nfd = u8"e\u0301 \u1100\u1161\u11a8 A\u030a"sv;
+        auto nfc = u8"é 각 Å"sv;
+        assert(Pits::Unicode::Normalize(nfd, NormalizationForm::NFC) == nfc);
+        assert(Pits::Unicode::Normalize(nfc, NormalizationForm::NFD) == nfd);
+        assert(Pits::Unicode::Normalize(u8"\u212b"sv, NormalizationForm::NFC) == u8"Å"sv);
+
+        // 正準順序 (結合クラス 220 は 230 より前)
+        assert(Pits::Unicode::Normalize(u8"a\u0301\u0323"sv, NormalizationForm::NFD) == u8"a\u0323\u0301"sv);
+        assert(Pits::Unicode::Normalize(u8"ṩ"sv, NormalizationForm::NFD) == u8"s\u0323\u0307"sv);
+
+        // 合成除外
+        assert(Pits::Unicode::Normalize(u8"\u0958"sv, NormalizationForm::NFC) == u8"क\u093c"sv);
+
+        // 互換分解
+        assert(Pits::Unicode::Normalize(u8"ｶﾞ①ﬁ㍻"sv, NormalizationForm::NFKC) == u8"ガ1fi平成"sv);
+        assert(Pits::Unicode::Normalize(u8"ｶﾞ"sv, NormalizationForm::NFKD) == u8"カ\u3099"sv);
+        assert(Pits::Unicode::Normalize(u8"ｶﾞ①"sv, NormalizationForm::NFC) == u8"ｶﾞ①"sv);
+        assert(Pits::Unicode::Normalize(U"\u0385"sv, NormalizationForm::NFKC) == U" \u0308\u0301"sv);
+        assert(Pits::Unicode::Normalize(U"e\u0301"sv, NormalizationForm::NFC) == U"é"sv);
+    }
+    {
+        // クイックチェック
+        assert(Pits::Unicode::QuickCheck(u8"ASCII only 日本語"sv, NormalizationForm::NFC) == QuickCheckResult::Yes);
+        assert(Pits::Unicode::QuickCheck(u8"e\u0301"sv, NormalizationForm::NFC) == QuickCheckResult::Maybe);
+        assert(Pits::Unicode::QuickCheck(u8"e\u0301"sv, NormalizationForm::NFD) == QuickCheckResult::Yes);
+        assert(Pits::Unicode::QuickCheck(u8"é"sv, NormalizationForm::NFD) == QuickCheckResult::No);
+        assert(Pits::Unicode::QuickCheck(u8"a\u0301\u0323"sv, NormalizationForm::NFD) == QuickCheckResult::No);
+        assert(Pits::Unicode::QuickCheck("a\xff"sv, NormalizationForm::NFC) == QuickCheckResult::No);
+        assert(Pits::Unicode::QuickCheck(U"ｶ"sv, NormalizationForm::NFKC) == QuickCheckResult::No);
+
+        // Maybe でも正規化済みなら真
+        assert(Pits::Unicode::IsNormalized(u8"\u0301"sv, NormalizationForm::NFC));
+        assert(!Pits::Unicode::IsNormalized(u8"e\u0301"sv, NormalizationForm::NFC));
+        assert(Pits::Unicode::IsNormalized(U"x\u0301"sv, NormalizationForm::NFKC));
+        assert(Pits::Unicode::GetCombiningClass(0x0301) == 230);
+        assert(Pits::Unicode::GetCombiningClass(U'a') == 0);
+    }
+    {
+        // 正規化済みなら入力をそのまま返す
+        auto sv = u8"正規化済みの文字列 é"sv;
+        auto buffer = std::string {};
+        assert(Pits::Unicode::Normalize(sv, NormalizationForm::NFC, buffer).data() == sv.data());
+        assert(buffer.empty());
+
+        auto r = Pits::Unicode::Normalize(u8"prefix e\u0301"sv, NormalizationForm::NFC, buffer);
+        assert(r == u8"prefix é"sv);
+        assert(r.data() == buffer.data());
+
+        // 不正なシーケンスは置き換える
+        assert(Pits::Unicode::Normalize("e\xcc\x81\xff"sv, NormalizationForm::NFC) == u8"é�"sv);
+    }
+    {
+        // 分割して入力しても結果は同じ
+        auto sv = u8"ASCII e\u0301 \u1100\u1161\u11a8 ｶﾞ a\u0301\u0323 end"sv;
+        for (auto form : {NormalizationForm::NFC, NormalizationForm::NFD, NormalizationForm::NFKC, NormalizationForm::NFKD}) {
+            auto expect = Pits::Unicode::Normalize(sv, form);
+            for (auto n = std::size_t(1); n < 8; ++n) {
+                auto normalizer = Pits::Unicode::Normalizer(form);
+                auto out = std::string {};
+                for (auto i = std::size_t {}; i < sv.size(); i += n) {
+                    normalizer.Append(sv.substr(i, n), out);
+                }
+                normalizer.Finish(out);
+                assert(out == expect);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+﻿#include "Pits/Regex.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+int main() {
+
+    {
+        // 全体一致
+        auto re = Pits::Regex("a(b|c)*d");
+        assert(re.error().empty() && re.size() == 1);
+        assert(re.Match("ad"));
+        assert(re.Match("abcbd"));
+        assert(!re.Match("abx"));
+        assert(!re.Match("abcdx"));
+
+        auto digits = Pits::Regex("\\d{2,4}-\\d+");
+        assert(digits.Match("12-3"));
+        assert(digits.Match("1234-5678"));
+        assert(!digits.Match("1-2"));
+        assert(!digits.Match("12345-6"));
+
+        assert(Pits::Regex("").Match(""));
+        assert(Pits::Regex("x?").Match(""));
+        assert(!Pits::Regex("x").Match(""));
+        assert(Pits::Regex("^$").Match(""));
+    }
+
+    {
+        // UTF8 の文字クラス
+        assert(Pits::Regex("^.$").Match("あ"));
+        assert(Pits::Regex("^...$").Match("a😀é"));
+        assert(!Pits::Regex("^.$").Match("\n"));
+        assert(!Pits::Regex("^.$").Match("\xe3\x81"));
+        assert(Pits::Regex("[あ-ん]+").Match("ひらがな"));
+        assert(!Pits::Regex("[あ-ん]+").Match("カタカナ"));
+        assert(Pits::Regex("[^a-z]").Match("漢"));
+        assert(!Pits::Regex("[^a-z]").Match("q"));
+        assert(Pits::Regex("[\\u3040-\\u309f\\x{30a0}-\\x{30ff}]+").Match("ひらカタ"));
+        assert(Pits::Regex("\\p{Han}+\\p{Hiragana}*").Match("漢字かな"));
+        assert(!Pits::Regex("\\p{Han}").Match("か"));
+        assert(Pits::Regex("\\p{Lu}\\p{Ll}+").Match("Émile"));
+        assert(Pits::Regex("\\P{L}+").Match("123!?"));
+        assert(Pits::Regex("\\p{N}").Match("٣"));
+        assert(Pits::Regex("[\\p{Katakana}ー]+").Match("カタカナー"));
+    }
+
+    {
+        // 部分一致
+        auto re = Pits::Regex("error: .*timeout");
+        assert(re.Search("2024-01-01 error: connection timeout after 30s"));
+        assert(!re.Search("2024-01-01 error: connection refused"));
+        assert(!re.Search("warning: timeout"));
+
+        auto anchored = Pits::Regex("^GET /");
+        assert(anchored.Search("GET /index.html"));
+        assert(!anchored.Search("POST /GET /"));
+
+        auto tail = Pits::Regex("\\.log$");
+        assert(tail.Search("app.log"));
+        assert(!tail.Search("app.log.1"));
+
+        // リテラルの読み飛ばしと一致の途中の再開
+        auto prefixed = Pits::Regex("ab+c");
+        assert(prefixed.Search(std::string(100, 'x') + "aabbbc"));
+        assert(prefixed.Search("abababbc"));
+        assert(!prefixed.Search(std::string(100, 'a') + "b"));
+        assert(Pits::Regex("検索").Search("全文検索エンジン"));
+        assert(!Pits::Regex("\x81").Search("あ"));
+    }
+
+    {
+        // 複数パターン
+        std::string_view patterns[] {"timeout"sv, "^ERROR"sv, "[0-9]{3}$"sv, "例外"sv};
+        auto re = Pits::Regex(patterns, 4);
+        assert(re.size() == 4);
+        auto matched = std::vector<std::size_t> {};
+        assert(re.SearchAll("ERROR: timeout 504", matched));
+        assert((matched == std::vector<std::size_t> {0, 1, 2}));
+        assert(re.SearchAll("例外が発生", matched));
+        assert((matched == std::vector<std::size_t> {3}));
+        assert(!re.SearchAll("ok", matched) && matched.empty());
+        assert(re.Search("code 200"));
+        assert(re.Match("ERROR"));
+
+        auto list = Pits::Regex(std::vector<std::string> {"foo", "bar"});
+        assert(list.Search("xbarx") && !list.Search("baz"));
+    }
+
+    {
+        // キャッシュの上限
+        auto re = Pits::Regex("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)", 8);
+        auto text = std::string {};
+        for (auto i = 0; i < 1000; ++i) text += (i * 7 % 3) ? 'a' : 'b';
+        assert(re.Match(text + "abbbbbb"));
+        assert(!re.Match(text + "bbbbbbb"));
+        assert(re.GetCacheResets() > 0);
+        assert(!Pits::Regex("(a|b)*a(a|b)(a|b)", 4).Match("abbb"));
+    }
+
+    {
+        // 誤り
+        assert(!Pits::Regex("(a").error().empty());
+        assert(!Pits::Regex("a)").error().empty());
+        assert(!Pits::Regex("*a").error().empty());
+        assert(!Pits::Regex("[a").error().empty());
+        assert(!Pits::Regex("[z-a]").error().empty());
+        assert(!Pits::Regex("\\q").error().empty());
+        assert(!Pits::Regex("\\p{Unknown_Name}").error().empty());
+        assert(!Pits::Regex("a{3,2}").error().empty());
+
+        // 入れ子の繰り返しで NFA が大きくなり過ぎる
+        assert(!Pits::Regex("((a{1000}){1000}){1000}").error().empty());
+        assert(Pits::Regex("(a{100}){100}").error().empty());
+        assert(!Pits::Regex("(a").Search("a"));
+        assert(Pits::Regex("a{,2}").Match("a{,2}"));
+    }
+
+    return 0;
+}
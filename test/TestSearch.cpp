@@ -0,0 +1,99 @@
+﻿#include "Pits/Search.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+
+int main() {
+
+    constexpr auto npos = std::string_view::npos;
+
+    {
+        // 文字
+        auto text = "abc あいう abc あいう"sv;
+        assert(Pits::Find(text, U'a') == 0);
+        assert(Pits::Find(text, U'a', 1) == 14);
+        assert(Pits::Find(text, U'い') == 7);
+        assert(Pits::Find(text, U'い', 8) == 21);
+        assert(Pits::Find(text, U'z') == npos);
+        assert(Pits::Find(text, U'a', 100) == npos);
+        assert(Pits::Find(text, char32_t(0xd800)) == npos);
+        assert(Pits::Find("\U0001f600"sv, U'\U0001f600') == 0);
+
+        // 長い文字列 (SIMD の範囲と残り)
+        auto long_text = std::string(100, 'x') + "日本語" + std::string(7, 'x') + "語";
+        assert(Pits::Find(long_text, U'語') == 106);
+        assert(Pits::Find(long_text, U'語', 107) == 116);
+    }
+
+    {
+        // 部分文字列
+        auto text = "テキストの検索 text search テキスト"sv;
+        assert(Pits::Find(text, "テキスト"sv) == 0);
+        assert(Pits::Find(text, "テキスト"sv, 1) == 34);
+        assert(Pits::Find(text, "search"sv) == 27);
+        assert(Pits::Find(text, ""sv, 5) == 5);
+        assert(Pits::Find(text, "x"sv, text.size()) == npos);
+        assert(Pits::Find("abc"sv, "abcd"sv) == npos);
+
+        // 文字の途中の一致は返さない
+        assert("あ"sv.find("\x81\x82"sv) == 1);
+        assert(Pits::Find("あ"sv, "\x81\x82"sv) == npos);
+        assert(Pits::Find("あい"sv, "\xe3\x81"sv) == npos);
+        assert(Pits::Find("あい\xe3\x81" "a"sv, "\xe3\x81"sv) == 6);
+
+        // 先頭と末尾のバイトは一致するが途中が異なる候補
+        auto long_text = std::string(40, 'a') + "aXXb" + std::string(40, 'a') + "aYYb";
+        assert(Pits::Find(long_text, "aYYb"sv) == 84);
+    }
+
+    {
+        // 文字の集合
+        auto text = "key = value; 値＝あたい"sv;
+        assert(Pits::FindAnyOf(text, U"=;") == 4);
+        assert(Pits::FindAnyOf(text, U"=;", 5) == 11);
+        assert(Pits::FindAnyOf(text, U"＝") == 16);
+        assert(Pits::FindAnyOf(text, U"#!") == npos);
+        assert(Pits::FindAnyOf(text, U"") == npos);
+
+        // 先頭バイトが 8 種類より多い集合
+        assert(Pits::FindAnyOf(text, U"0123456789あ") == 19);
+
+        // 先頭バイトが同じ別の文字
+        assert(Pits::FindAnyOf("あいう"sv, U"う") == 6);
+
+        // 不正なシーケンスは置換文字と一致しない
+        assert(Pits::FindAnyOf("a\xef" "b\xef\xbf\xbd"sv, U"�") == 3);
+
+        auto long_text = std::string(50, ' ') + "\t" + std::string(50, ' ') + "\n";
+        assert(Pits::FindAnyOf(long_text, U"\r\n") == 101);
+    }
+
+    {
+        // 大文字小文字を区別しない
+        auto text = "The Quick Brown Fox"sv;
+        auto found = Pits::FindCaseless(text, "quick"sv);
+        assert(found.position == 4 && found.length == 5);
+        found = Pits::FindCaseless(text, "FOX"sv);
+        assert(found.position == 16 && found.length == 3);
+        assert(Pits::FindCaseless(text, "dog"sv).position == npos);
+        assert(Pits::FindCaseless(text, ""sv, 3).position == 3);
+
+        // UTF8 の長さが異なる一致
+        found = Pits::FindCaseless("0 K 1"sv, "k"sv);
+        assert(found.position == 2 && found.length == 3);
+
+        // ASCII 以外で始まるパターン
+        found = Pits::FindCaseless("Straße ΣΊΣΥΦΟΣ"sv, "σίσυφοσ"sv);
+        assert(found.position == 8);
+        found = Pits::FindCaseless("ПРИВЕТ мир"sv, "привет"sv);
+        assert(found.position == 0 && found.length == 12);
+
+        auto long_text = std::string(60, '-') + "Hello, World" + std::string(60, '-');
+        found = Pits::FindCaseless(long_text, "hello, world"sv);
+        assert(found.position == 60 && found.length == 12);
+    }
+
+    return 0;
+}
@@ -1,7 +1,10 @@
 ﻿#include "Pits/StringStream.hpp"
 #include <sstream>
 #include <iostream>
+#include <fstream>
+#include <iomanip>
 #include <cassert>
+#include <cstdio>
 
 int main() {
 
@@ -11,5 +14,385 @@ int main() {
     char c;
     ss >> c;
     assert(ss.str() == ss.stringstream::str());
+
+    // バッファを複写せずに取り出す
+    {
+        Pits::BasicStringStream<char> ss;
+        ss << std::string(100, 'a') << "bc";
+        auto data = ss.str().data();
+        auto s = ss.release();
+        assert(s == std::string(100, 'a') + "bc");
+        assert(s.data() == data);
+        assert(ss.str().empty());
+        ss << "next";
+        assert(ss.str() == "next");
+
+        // 書き込んだ最も後ろの位置まで取り出す
+        ss.seekp(1);
+        ss << 'E';
+        assert(ss.release() == "nExt");
+
+        Pits::BasicStringStream<char16_t> ss16;
+        ss16 << std::u16string(50, u'\u3042');
+        assert(ss16.release() == std::u16string(50, u'\u3042'));
+        assert(ss16.str().empty());
+    }
+
+    // 文字列を複写せずにバッファにする
+    {
+        auto text = std::string(100, 'x') + " 42";
+        auto data = text.data();
+        Pits::BasicStringStream<char> ss(std::move(text));
+        assert(ss.str().data() == data);
+        std::string word;
+        int value = 0;
+        ss >> word >> value;
+        assert(word == std::string(100, 'x'));
+        assert(value == 42);
+
+        auto again = std::string(100, 'y');
+        data = again.data();
+        ss.clear();
+        ss.adopt(std::move(again));
+        ss >> word;
+        assert(word == std::string(100, 'y'));
+        assert(ss.release().data() == data);
+    }
+
+    // 容量内ではバッファへ直接書き込む
+    {
+        char buffer[16];
+        Pits::BasicSpanStream<char> span(buffer);
+        span << "count=" << 42;
+        assert(span.str() == "count=42");
+        assert(span.str().data() == buffer);
+        assert(span.tellp() == 8);
+        span.reset();
+        span << 'x';
+        assert(span.str() == "x");
+    }
+
+    // Truncate は文字の途中で切らず、以降の書き込みも捨てる
+    {
+        char buffer[6];
+        Pits::BasicSpanStream<char> span(buffer, Pits::OverflowPolicy::Truncate);
+        span << "ab\u3042\u3044" << "c";
+        assert(span.good());
+        assert(span.truncated());
+        assert(span.str() == "ab\u3042");
+    }
+    {
+        // 切った後の1文字の書き込みも捨てる
+        char buffer[3];
+        Pits::BasicSpanStream<char> span(buffer);
+        span << "a" << "\u3042" << 'b' << 'c';
+        span.put('d');
+        assert(span.good());
+        assert(span.truncated());
+        assert(span.str() == "a");
+        span.reset();
+        span << 'x' << "yz";
+        assert(!span.truncated() && span.str() == "xyz");
+    }
+    {
+        char16_t buffer[3];
+        Pits::BasicSpanStreamBuf<char16_t> buf(buffer, 3);
+        buf.sputn(u"ab\U0001F600", 4);
+        assert(buf.truncated());
+        assert(buf.str() == u"ab");
+    }
+
+    // Spill はヒープへ移して書き続ける
+    {
+        char buffer[4];
+        Pits::BasicSpanStream<char> span(buffer, Pits::OverflowPolicy::Spill);
+        span << "ab";
+        assert(!span.spilled());
+        for (auto i = 0; i < 100; ++i) span << i % 10;
+        assert(span.good());
+        assert(span.spilled());
+        assert(span.str().size() == 102);
+        assert(span.str().substr(0, 5) == "ab012");
+        span.reset();
+        assert(!span.spilled());
+        span << "xyz";
+        assert(span.str() == "xyz");
+    }
+
+    // Fail は収まる分だけ書いて badbit を立てる
+    {
+        char buffer[4];
+        Pits::BasicSpanStream<char> span(buffer, Pits::OverflowPolicy::Fail);
+        span << "abcdef";
+        assert(span.bad());
+        assert(span.str() == "abcd");
+        span.reset();
+        span << 1234;
+        assert(span.good());
+        assert(span.str() == "1234");
+    }
+
+    // セグメントを連ねたバッファ
+    {
+        Pits::BasicRopeStream<char> rope(16);
+        assert(rope.segments() == 0);
+        assert(rope.str().empty());
+        rope << "0123456789";
+        assert(rope.segments() == 1);
+        assert(rope.str() == "0123456789");
+        assert(rope.str().data() == rope.segment(0).data());
+
+        for (auto i = 0; i < 10; ++i) rope << "0123456789";
+        assert(rope.size() == 110);
+        assert(rope.tellp() == 110);
+        assert(rope.segments() == 7);
+        assert(rope.segment(0) == "0123456789012345");
+        assert(rope.segment(6) == "67890123456789");
+        auto gathered = std::string {};
+        for (auto i = std::size_t {}; i != rope.segments(); ++i) gathered += rope.segment(i);
+        assert(gathered == rope.str());
+        assert(rope.str().size() == 110);
+
+        // セグメントを使い回す
+        auto first = rope.segment(0).data();
+        rope.reset();
+        assert(rope.size() == 0);
+        rope << std::string(20, 'z');
+        assert(rope.segment(0).data() == first);
+        assert(rope.segment(1) == "zzzz");
+    }
+
+    // StringBuilder
+    {
+        Pits::StringBuilder sb;
+        sb << "count=" << 42 << ' ' << -7 << ' ' << 1.5 << ' ' << true << ' ' << 255u;
+        assert(sb.str() == "count=42 -7 1.5 true 255");
+        sb.clear();
+        sb.append(255, 16).append(' ').append(0.125, std::chars_format::fixed, 2);
+        assert(sb.str() == "ff 0.12" || sb.str() == "ff 0.13");
+        sb.clear();
+        sb.append(1e300, std::chars_format::fixed, 2);
+        assert(sb.size() == 304);
+        assert(sb.str().substr(0, 2) == "10");
+    }
+
+    // エンコーディングの変換
+    {
+        Pits::StringBuilder sb;
+        sb << u"a\u3042" << U"\U0001F600" << L"w" << std::u16string_view(u"\xd800", 1) << U'\u00e9';
+        assert(sb.str() == "a\u3042\U0001F600w\ufffd\u00e9");
+
+        Pits::BasicStringBuilder<char16_t> sb16;
+        sb16 << "a\u3042" << U"\U0001F600" << std::string_view("\xff") << 12 << u'z';
+        assert(sb16.str() == u"a\u3042\U0001F600\ufffd12z");
+
+        Pits::BasicStringBuilder<char32_t> sb32;
+        sb32 << "a\u3042" << u"\U0001F600" << std::u16string_view(u"\xd800", 1) << 2.5;
+        assert(sb32.str() == U"a\u3042\U0001F600\ufffd2.5");
+    }
+
+    // 内部の配列を超えるとヒープへ移す
+    {
+        Pits::BasicStringBuilder<char, 8> sb;
+        sb << "1234567";
+        assert(sb.capacity() == 8);
+        sb << "89" << std::string(100, 'x');
+        assert(sb.size() == 109);
+        assert(sb.capacity() >= 109);
+        assert(sb.str().substr(0, 10) == "123456789x");
+
+        auto moved = std::move(sb);
+        assert(moved.size() == 109);
+        assert(sb.empty());
+
+        Pits::BasicStringBuilder<char, 8> small;
+        small << "abc";
+        sb = std::move(small);
+        assert(sb.str() == "abc");
+        assert(sb.capacity() == 8);
+    }
+
+    // スレッド毎のプール
+    {
+        auto before = Pits::GetStringStreamPoolStatistics();
+        const void* buffer = nullptr;
+        auto index = std::ios_base::xalloc();
+        {
+            auto ss = Pits::AcquireStringStream();
+            *ss << std::hex << std::setw(4) << std::setfill('0') << 255 << std::string(100, 'x');
+            assert(ss->str().substr(0, 4) == "00ff");
+            buffer = ss->str().data();
+            ss->iword(index) = 42;
+            ss->pword(index) = &index;
+            ss->exceptions(std::ios_base::failbit);
+            ss->tie(&std::cout);
+            try {
+                ss->setstate(std::ios_base::failbit);
+            }
+            catch (const std::ios_base::failure&) {
+            }
+        }
+        auto after = Pits::GetStringStreamPoolStatistics();
+        assert(after.misses == before.misses + 1);
+        assert(after.pooled == before.pooled + 1);
+        assert(after.retained >= 100);
+        {
+            // バッファを残し、状態フラグと書式を戻して渡す
+            auto ss = Pits::AcquireStringStream();
+            assert(ss->good());
+            assert(ss->str().empty());
+            assert(ss->exceptions() == std::ios_base::goodbit);
+            assert(!ss->tie());
+            assert(ss->iword(index) == 0 && !ss->pword(index));
+            *ss << std::setw(4) << 255;
+            assert(ss->str() == " 255");
+            assert(ss->str().data() == buffer);
+
+            // 入れ子で借りると別のストリームになる
+            auto nested = Pits::AcquireStringStream();
+            assert(nested.get() != ss.get());
+        }
+        auto last = Pits::GetStringStreamPoolStatistics();
+        assert(last.hits == after.hits + 1);
+        assert(last.misses == after.misses + 1);
+        assert(last.pooled == 2);
+
+        // 上限を超えるバッファは保持しない
+        Pits::SetStringStreamPoolLimit(0);
+        assert(Pits::GetStringStreamPoolStatistics().pooled == 0);
+        {
+            auto ss = Pits::AcquireStringStream();
+        }
+        assert(Pits::GetStringStreamPoolStatistics().pooled == 0);
+        Pits::SetStringStreamPoolLimit(64 * 1024);
+    }
+
+    // UTF16, UTF32 を UTF8 にして出力する
+    {
+        std::ostringstream sink;
+        {
+            Pits::BasicTranscodingStream<char16_t> out(sink);
+            out << u"a\u3042" << u"42";
+            // サロゲートペアが書き込みの境目で分かれても変換する
+            out.rdbuf()->sputn(u"\U0001F600", 1);
+            out.flush();
+            assert(sink.str() == "a\u304242");
+            out.rdbuf()->sputn(u"\U0001F600" + 1, 1);
+            out << u'z';
+        }
+        assert(sink.str() == "a\u304242\U0001F600z");
+    }
+    {
+        // ChunkUnits の境目で分かれたサロゲートペアと、最後の対にならないハイサロゲート
+        using buf = Pits::BasicTranscodingStreamBuf<char16_t>;
+        auto text = std::u16string(buf::ChunkUnits - 1, u'x') + u"\U0001F600" + std::u16string(buf::ChunkUnits * 2, u'\u00e9');
+        text += u'\xd800';
+        std::ostringstream sink;
+        {
+            buf tb(sink.rdbuf());
+            tb.sputn(text.data(), std::streamsize(text.size()));
+        }
+        auto expected = std::string(buf::ChunkUnits - 1, 'x') + "\U0001F600";
+        for (auto i = std::size_t {}; i < buf::ChunkUnits * 2; ++i) expected += "\u00e9";
+        expected += "\ufffd";
+        assert(sink.str() == expected);
+    }
+    {
+        std::ostringstream sink;
+        Pits::BasicTranscodingStream<char32_t> out(sink);
+        out << U"\U0001F600" << char32_t(0xd800) << U'!';
+        assert(out.finish());
+        assert(sink.str() == "\U0001F600\ufffd!");
+
+        std::ostringstream wsink;
+        Pits::BasicTranscodingStream<wchar_t> wout(wsink);
+        wout << L"w\u00e9" << 1.5;
+        wout.finish();
+        assert(wsink.str() == "w\u00e91.5");
+    }
+
+    // 別スレッドでファイルへ書き出す
+    {
+        auto path = "TestStringStream.async.txt";
+        auto expected = std::string {};
+        {
+            Pits::AsyncFileStream out(path, Pits::BacklogPolicy::Block, 64, 3);
+            assert(out.is_open());
+            for (auto i = 0; i < 10000; ++i) {
+                out << "line " << i << '\n';
+                expected += "line " + std::to_string(i) + "\n";
+            }
+            out << std::flush;
+            assert(out.close());
+            auto statistics = out.GetStatistics();
+            assert(statistics.bytes == expected.size());
+            assert(statistics.dropped == 0);
+            assert(statistics.flushes >= expected.size() / 64);
+            assert(statistics.maxFlushSeconds >= statistics.lastFlushSeconds);
+            assert(statistics.totalFlushSeconds >= statistics.maxFlushSeconds);
+        }
+        std::ifstream in(path, std::ios::binary);
+        auto actual = std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        assert(actual == expected);
+        in.close();
+
+        // 捨てた分と書き出した分の合計は書き込んだ量になる
+        auto total = std::size_t {};
+        auto statistics = Pits::AsyncSinkStatistics {};
+        {
+            Pits::AsyncFileStream out(path, Pits::BacklogPolicy::Drop, 16, 2);
+            for (auto i = 0; i < 10000; ++i) {
+                out << "0123456789\n";
+                total += 11;
+            }
+            out.close();
+            assert(out.good());
+            statistics = out.GetStatistics();
+        }
+        assert(statistics.bytes + statistics.dropped == total);
+
+        // 閉じる時の最後のバッファは Drop でも捨てない
+        auto tail = std::string("0123456789ABCDEF");
+        {
+            Pits::AsyncFileStream out(path, Pits::BacklogPolicy::Drop, 16, 2);
+            // 110000 バイトでバッファの境界になるので、続く1バッファ分は閉じる時の最後のバッファになる
+            for (auto i = 0; i < 10000; ++i) out << "0123456789\n";
+            out << tail;
+            assert(out.close());
+            statistics = out.GetStatistics();
+        }
+        in.open(path, std::ios::binary);
+        actual.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        in.close();
+        assert(actual.size() == statistics.bytes);
+        assert(actual.size() >= tail.size() && actual.compare(actual.size() - tail.size(), tail.size(), tail) == 0);
+
+        // 行毎の std::endl で少ししか書き込んでいないバッファを渡さず、捨てもしない
+        // (書き出しスレッドが動かなくても全体が収まる大きさにする)
+        auto lines = 10000;
+        {
+            Pits::AsyncFileStream out(path, Pits::BacklogPolicy::Drop, 64 * 1024, 4);
+            for (auto i = 0; i < lines; ++i) out << "line " << i << std::endl;
+            assert(out.close());
+            statistics = out.GetStatistics();
+        }
+        assert(statistics.dropped == 0);
+        assert(statistics.flushes < std::size_t(lines / 100));
+        in.open(path, std::ios::binary);
+        actual.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        in.close();
+        assert(actual.size() == statistics.bytes);
+        assert(actual.compare(actual.size() - 10, 10, "line 9999\n") == 0);
+        std::remove(path);
+
+        // 開けなければ badbit を立てる
+        Pits::AsyncFileStream bad("no-such-directory/out.txt");
+        assert(!bad.is_open());
+        assert(!bad.error().empty());
+        assert(bad.bad());
+        bad << "ignored";
+        assert(!bad.good());
+    }
+
     return 0;
 }
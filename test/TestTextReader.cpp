@@ -0,0 +1,99 @@
+﻿#include "Pits/TextReader.hpp"
+#include "Pits/StringStream.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+
+int main() {
+
+    // 行
+    {
+        auto text = "first\r\nsecond\n\nlast"sv;
+        Pits::TextReader reader(text);
+        std::string_view line;
+        assert(reader.ReadLine(line) && line == "first");
+        assert(line.data() == text.data());
+        assert(reader.ReadLine(line) && line == "second");
+        assert(reader.ReadLine(line) && line.empty());
+        assert(reader.ReadLine(line) && line == "last");
+        assert(reader.eof());
+        assert(!reader.ReadLine(line));
+
+        // 16 バイトを超える行と末尾の改行
+        auto longer = std::string(40, 'x') + "\n" + std::string(3, 'y') + "\n";
+        Pits::TextReader r2(longer);
+        assert(r2.ReadLine(line) && line == std::string(40, 'x'));
+        assert(r2.ReadLine(line) && line == "yyy");
+        assert(!r2.ReadLine(line));
+    }
+
+    // トークン
+    {
+        auto text = "  alpha\tbeta あい \n gamma  "sv;
+        Pits::TextReader reader(text);
+        std::string_view token;
+        assert(reader.ReadToken(token) && token == "alpha");
+        assert(reader.ReadToken(token) && token == "beta");
+        assert(reader.ReadToken(token) && token == "あい");
+        assert(reader.ReadToken(token) && token == "gamma");
+        assert(token.data() == text.data() + text.find("gamma"));
+        assert(!reader.ReadToken(token));
+        assert(reader.eof());
+    }
+
+    // フィールド (空のフィールドを残す)
+    {
+        Pits::TextReader reader("a,,b,"sv, ","sv);
+        std::string_view field;
+        assert(reader.ReadField(field) && field == "a");
+        assert(reader.ReadField(field) && field.empty());
+        assert(reader.ReadField(field) && field == "b");
+        assert(reader.ReadField(field) && field.empty());
+        assert(!reader.ReadField(field));
+
+        // 8 種類を超える区切り文字
+        Pits::TextReader many("one;two|three/four"sv, ",;|/:!?#@"sv);
+        assert(many.ReadField(field) && field == "one");
+        assert(many.ReadField(field) && field == "two");
+        assert(many.ReadField(field) && field == "three");
+        assert(many.ReadField(field) && field == "four");
+        assert(!many.ReadField(field));
+    }
+
+    // 数値
+    {
+        Pits::TextReader reader("42 -7 2.5 1e3 x9 18446744073709551615"sv);
+        int i = 0;
+        double d = 0;
+        unsigned long long u = 0;
+        assert(reader.Read(i) && i == 42);
+        assert(reader.Read(i) && i == -7);
+        assert(reader.Read(d) && d == 2.5);
+        assert(reader.Read(d) && d == 1000.0);
+        assert(!reader.Read(i));
+        // 失敗しても位置は変えない
+        std::string_view token;
+        assert(reader.ReadToken(token) && token == "x9");
+        assert(!reader.Read(i));
+        assert(reader.Read(u) && u == 18446744073709551615ull);
+        assert(!reader.Read(i));
+    }
+
+    // ストリームの内容を複写せずに読む
+    {
+        Pits::BasicStringStream<char> ss;
+        ss << "10 20\n30\n";
+        Pits::TextReader reader(ss.str());
+        std::string_view line;
+        auto sum = 0;
+        while (reader.ReadLine(line)) {
+            Pits::TextReader fields(line);
+            for (int value; fields.Read(value); ) sum += value;
+        }
+        assert(sum == 60);
+    }
+
+    return 0;
+}
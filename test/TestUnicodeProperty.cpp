@@ -0,0 +1,80 @@
+﻿#include "Pits/UnicodeProperty.hpp"
+#include <cassert>
+#include <string_view>
+
+using namespace std::literals;
+using Pits::Unicode::GeneralCategory;
+using Pits::Unicode::LineBreak;
+using Pits::Unicode::Script;
+
+// コンパイル時に参照できる
+static_assert(Pits::Unicode::GetGeneralCategory(U'A') == GeneralCategory::Lu);
+static_assert(Pits::Unicode::GetScript(U'あ') == Script::Hiragana);
+static_assert(Pits::Unicode::GetLineBreak(U'。') == LineBreak::CL);
+
+int main() {
+
+    {
+        // 一般カテゴリ
+        assert(Pits::Unicode::GetGeneralCategory(U'a') == GeneralCategory::Ll);
+        assert(Pits::Unicode::GetGeneralCategory(U'ǅ') == GeneralCategory::Lt);
+        assert(Pits::Unicode::GetGeneralCategory(U'漢') == GeneralCategory::Lo);
+        assert(Pits::Unicode::GetGeneralCategory(U'\u0301') == GeneralCategory::Mn);
+        assert(Pits::Unicode::GetGeneralCategory(U'٣') == GeneralCategory::Nd);
+        assert(Pits::Unicode::GetGeneralCategory(U'「') == GeneralCategory::Ps);
+        assert(Pits::Unicode::GetGeneralCategory(U'¥') == GeneralCategory::Sc);
+        assert(Pits::Unicode::GetGeneralCategory(U'\u3000') == GeneralCategory::Zs);
+        assert(Pits::Unicode::GetGeneralCategory(U'\u2029') == GeneralCategory::Zp);
+        assert(Pits::Unicode::GetGeneralCategory(U'\n') == GeneralCategory::Cc);
+        assert(Pits::Unicode::GetGeneralCategory(U'\u200b') == GeneralCategory::Cf);
+        assert(Pits::Unicode::GetGeneralCategory(0xd800) == GeneralCategory::Cs);
+        assert(Pits::Unicode::GetGeneralCategory(0xe000) == GeneralCategory::Co);
+        assert(Pits::Unicode::GetGeneralCategory(0x10fffd) == GeneralCategory::Co);
+        assert(Pits::Unicode::GetGeneralCategory(0x0378) == GeneralCategory::Cn);
+        assert(Pits::Unicode::GetGeneralCategory(0x110000) == GeneralCategory::Cn);
+        assert(Pits::Unicode::GetGeneralCategory(U'\U00020000') == GeneralCategory::Lo);
+
+        assert(Pits::Unicode::IsLetter(U'ア') && !Pits::Unicode::IsLetter(U'1'));
+        assert(Pits::Unicode::IsMark(U'\u3099'));
+        assert(Pits::Unicode::IsNumber(U'Ⅻ'));
+        assert(Pits::Unicode::IsPunctuation(U'、'));
+        assert(Pits::Unicode::IsSymbol(U'€'));
+        assert(Pits::Unicode::IsSeparator(U' '));
+        assert(Pits::Unicode::IsAssigned(U'a') && !Pits::Unicode::IsAssigned(0xffff));
+    }
+
+    {
+        // 用字
+        assert(Pits::Unicode::GetScript(U'a') == Script::Latin);
+        assert(Pits::Unicode::GetScript(U'ア') == Script::Katakana);
+        assert(Pits::Unicode::GetScript(U'ｱ') == Script::Katakana);
+        assert(Pits::Unicode::GetScript(U'漢') == Script::Han);
+        assert(Pits::Unicode::GetScript(U'ー') == Script::Common);
+        assert(Pits::Unicode::GetScript(U'\u0301') == Script::Inherited);
+        assert(Pits::Unicode::GetScript(U'한') == Script::Hangul);
+        assert(Pits::Unicode::GetScript(U'\U00010300') == Script::Old_Italic);
+        assert(Pits::Unicode::GetScript(0x0378) == Script::Unknown);
+        assert(Pits::Unicode::GetScriptName(Script::Han) == "Han"sv);
+        assert(Pits::Unicode::GetScriptName(Pits::Unicode::GetScript(U'α')) == "Greek"sv);
+        assert(Pits::Unicode::GetScriptName(Script::Unknown) == "Unknown"sv);
+    }
+
+    {
+        // 改行クラス
+        assert(Pits::Unicode::GetLineBreak(U'a') == LineBreak::AL);
+        assert(Pits::Unicode::GetLineBreak(U' ') == LineBreak::SP);
+        assert(Pits::Unicode::GetLineBreak(U'\n') == LineBreak::LF);
+        assert(Pits::Unicode::GetLineBreak(U'漢') == LineBreak::ID);
+        assert(Pits::Unicode::GetLineBreak(U'「') == LineBreak::OP);
+        assert(Pits::Unicode::GetLineBreak(U'ぁ') == LineBreak::CJ);
+        assert(Pits::Unicode::GetLineBreak(U'ー') == LineBreak::CJ);
+        assert(Pits::Unicode::GetLineBreak(U'・') == LineBreak::NS);
+        assert(Pits::Unicode::GetLineBreak(U'\u200d') == LineBreak::ZWJ);
+        assert(Pits::Unicode::GetLineBreak(U'\U0001f1ef') == LineBreak::RI);
+        assert(Pits::Unicode::GetLineBreak(U'ก') == LineBreak::SA);
+        assert(Pits::Unicode::GetLineBreak(0xe000) == LineBreak::XX);
+        assert(Pits::Unicode::GetLineBreak(U'\U0003fffd') == LineBreak::ID);
+    }
+
+    return 0;
+}
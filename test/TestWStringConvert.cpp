@@ -0,0 +1,52 @@
+﻿#include "Pits/WStringConvert.hpp"
+#include <uchar.h>
+#include <cassert>
+#include <string_view>
+#include <iostream>
+#include <locale>
+#include <codecvt>
+
+using namespace std::literals;
+
+int main() {
+
+#if defined(__STDC_UTF_16__) && defined(__STDC_UTF_32__)
+
+    {
+        auto sv = u8"𐐷漢字😀 ASCII 0123456789abcdef かなカナ"sv;
+        auto ws = Pits::ToWString(sv);
+        assert(ws == L"𐐷漢字😀 ASCII 0123456789abcdef かなカナ"sv);
+        assert(Pits::ToString(ws) == sv);
+    }
+    {
+        // std::wstring_convert と同じ結果になる事
+        auto sv = u8"0123456789abcdef 漢字 \U0001F600 0123456789abcdef"s;
+        std::wstring expect;
+        if constexpr (Pits::String::WideCharEncoding == Pits::String::UTF16) {
+            expect = std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>().from_bytes(sv);
+        }
+        else {
+            expect = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(sv);
+        }
+        Pits::WStringConvert conv;
+        auto ws = conv.from_bytes(sv);
+        assert(ws == expect);
+        assert(conv.converted() == sv.size());
+        assert(conv.to_bytes(ws) == sv);
+        assert(conv.to_bytes(ws.c_str()) == sv);
+        assert(conv.from_bytes('A') == L"A");
+        assert(conv.to_bytes(L'A') == "A");
+    }
+    {
+        // 不正なシーケンスは例外ではなく置き換え
+        assert(Pits::ToWString("A\xff" "B"sv) == L"A�B");
+        assert(Pits::ToUTF16("A\xff" "B"sv) == u"A�B");
+        assert(Pits::ToUTF32("A\xff" "B"sv) == U"A�B");
+        assert(Pits::ToUTF8(u"A\xd800" u"B"sv) == u8"A�B");
+        assert(Pits::ToUTF8(U"A\x110000" U"B"sv) == u8"A�B");
+    }
+
+#endif
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+﻿#include "Pits/Width.hpp"
+#include <cassert>
+#include <string>
+#include <string_view>
+
+using namespace std::literals;
+using Pits::Unicode::AmbiguousWidth;
+
+int main() {
+
+    {
+        // 文字の幅
+        assert(Pits::Unicode::CharacterWidth(U'a') == 1);
+        assert(Pits::Unicode::CharacterWidth(U'\t') == 0);
+        assert(Pits::Unicode::CharacterWidth(U'あ') == 2);
+        assert(Pits::Unicode::CharacterWidth(U'ｱ') == 1);
+        assert(Pits::Unicode::CharacterWidth(U'Ａ') == 2);
+        assert(Pits::Unicode::CharacterWidth(U'　') == 2);
+        assert(Pits::Unicode::CharacterWidth(U'\u0301') == 0);
+        assert(Pits::Unicode::CharacterWidth(U'\u200b') == 0);
+        assert(Pits::Unicode::CharacterWidth(U'\u1161') == 0);
+        assert(Pits::Unicode::CharacterWidth(U'\u00ad') == 1);
+        assert(Pits::Unicode::CharacterWidth(U'\U0001f600') == 2);
+        assert(Pits::Unicode::CharacterWidth(U'❤') == 1);
+        assert(Pits::Unicode::CharacterWidth(U'\U0002a6e0') == 2);   // 未割り当ての CJK 統合漢字
+        assert(Pits::Unicode::CharacterWidth(U'○') == 1);
+        assert(Pits::Unicode::CharacterWidth(U'○', AmbiguousWidth::Wide) == 2);
+    }
+
+    {
+        // 文字列の幅
+        assert(Pits::Unicode::DisplayWidth(""sv) == 0);
+        assert(Pits::Unicode::DisplayWidth("Hello, world!\r\n"sv) == 13);
+        assert(Pits::Unicode::DisplayWidth("日本語テキスト"sv) == 14);
+        assert(Pits::Unicode::DisplayWidth("ﾆﾎﾝｺﾞ"sv) == 5);
+        assert(Pits::Unicode::DisplayWidth("e\u0301"sv) == 1);
+        assert(Pits::Unicode::DisplayWidth("\u1100\u1161\u11a8"sv) == 2);
+        assert(Pits::Unicode::DisplayWidth("❤\ufe0f"sv) == 2);
+        assert(Pits::Unicode::DisplayWidth("\U0001f468\u200d\U0001f469\u200d\U0001f467"sv) == 2);
+        assert(Pits::Unicode::DisplayWidth("\U0001f1ef\U0001f1f5"sv) == 2);
+        assert(Pits::Unicode::DisplayWidth("±×"sv) == 2);
+        assert(Pits::Unicode::DisplayWidth("±×"sv, AmbiguousWidth::Wide) == 4);
+        assert(Pits::Unicode::DisplayWidth("a\x80z"sv) == 3);
+        assert(Pits::Unicode::DisplayWidth(u"日本語 text"sv) == 11);
+
+        // 16 バイト以上の ASCII
+        auto ascii = std::string(100, 'x') + "\t" + std::string(50, 'y') + "漢";
+        assert(Pits::Unicode::DisplayWidth(ascii) == 152);
+        auto ascii16 = std::u16string(100, u'x') + u"\x7f" + std::u16string(50, u'y');
+        assert(Pits::Unicode::DisplayWidth(ascii16) == 150);
+    }
+
+    {
+        // 幅で切る
+        assert(Pits::Unicode::TruncateToWidth("Hello, world!"sv, 5) == "Hello"sv);
+        assert(Pits::Unicode::TruncateToWidth("日本語"sv, 5) == "日本"sv);
+        assert(Pits::Unicode::TruncateToWidth("日本語"sv, 6) == "日本語"sv);
+        assert(Pits::Unicode::TruncateToWidth("abe\u0301\u0323z"sv, 3) == "abe\u0301\u0323"sv);
+        assert(Pits::Unicode::TruncateToWidth("a\U0001f468\u200d\U0001f469b"sv, 2) == "a"sv);
+        assert(Pits::Unicode::TruncateToWidth("a\U0001f468\u200d\U0001f469b"sv, 3) == "a\U0001f468\u200d\U0001f469"sv);
+        assert(Pits::Unicode::TruncateToWidth("abc"sv, 0).empty());
+        assert(Pits::Unicode::TruncateToWidth(u"ｱｲ字"sv, 3) == u"ｱｲ"sv);
+        auto long_text = std::string(40, 'a') + "漢字";
+        assert(Pits::Unicode::TruncateToWidth(long_text, 20) == std::string(20, 'a'));
+        assert(Pits::Unicode::TruncateToWidth(long_text, 43) == std::string(40, 'a') + "漢");
+    }
+
+    return 0;
+}
@@ -0,0 +1,783 @@
+﻿/**
+ * @brief UCD (Unicode Character Database) からユニコードのプロパティテーブルを生成する
+ * @author Yukio KANEDA
+ * @file
+ *
+ * ビルド時に実行し ucd/ 以下のファイルから Pits/UnicodeTable.hpp を生成する
+ *
+ * usage: UnicodeTableGenerator <ucd directory> <output header>
+ */
+
+#include <algorithm>    // stable_sort lower_bound
+#include <array>
+#include <cstdint>      // uint16_t uint32_t
+#include <fstream>
+#include <functional>   // function
+#include <iomanip>      // setw setfill
+#include <iostream>
+#include <iterator>     // begin end size
+#include <map>
+#include <sstream>
+#include <stdexcept>    // runtime_error
+#include <string>
+#include <tuple>        // tie
+#include <vector>
+
+/*
+ *
+ */
+
+namespace {
+
+/// コードポイントの数
+constexpr auto CodeSpace = std::size_t(0x110000);
+
+/// 2段テーブルのブロックのビット数
+constexpr auto BlockShift = 7;
+
+/// ハングル音節の範囲
+constexpr auto HangulSBase = char32_t(0xac00);
+constexpr auto HangulLBase = char32_t(0x1100);
+constexpr auto HangulVBase = char32_t(0x1161);
+constexpr auto HangulTBase = char32_t(0x11a7);
+constexpr auto HangulLCount = 19;
+constexpr auto HangulVCount = 21;
+constexpr auto HangulTCount = 28;
+constexpr auto HangulNCount = HangulVCount * HangulTCount;
+constexpr auto HangulSCount = HangulLCount * HangulNCount;
+
+/*
+ *
+ */
+
+/// 前後の空白を取り除く
+auto Trim(const std::string& s) -> std::string
+{
+    auto b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return {};
+    auto e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+/// 16進数のコードポイントを読む
+auto ParseCode(const std::string& s) -> char32_t
+{
+    auto pos = std::size_t {};
+    auto c = std::stoul(s, &pos, 16);
+    if (pos != s.size() || c >= CodeSpace) {
+        throw std::runtime_error("illegal code point: " + s);
+    }
+    return char32_t(c);
+}
+
+/// 空白区切りのコードポイント列を読む
+auto ParseCodes(const std::string& s) -> std::vector<char32_t>
+{
+    auto codes = std::vector<char32_t> {};
+    auto in = std::istringstream(s);
+    for (auto word = std::string {}; in >> word; ) {
+        codes.push_back(ParseCode(word));
+    }
+    return codes;
+}
+
+/**
+ * @brief UCD 形式のファイルを読み、データ行毎に関数を呼ぶ
+ * @param path ファイル名
+ * @param f フィールド (コメントを除き ; で区切り前後の空白を取り除いた物) を受け取る関数
+ */
+void ReadUCD(const std::string& path, const std::function<void(const std::vector<std::string>&)>& f)
+{
+    auto in = std::ifstream(path);
+    if (!in) {
+        throw std::runtime_error("can not open: " + path);
+    }
+    for (auto line = std::string {}; std::getline(in, line); ) {
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        auto fields = std::vector<std::string> {};
+        auto in = std::istringstream(line);
+        for (auto field = std::string {}; std::getline(in, field, ';'); ) {
+            fields.push_back(Trim(field));
+        }
+        if (line.back() == ';') {
+            fields.emplace_back();
+        }
+        f(fields);
+    }
+}
+
+/**
+ * @brief UnicodeData.txt を読み、コードポイント毎に関数を呼ぶ
+ *
+ * <..., First> <..., Last> で示す範囲は範囲内の全コードポイントについて呼ぶ
+ *
+ * @param path ファイル名
+ * @param f コードポイントとフィールドを受け取る関数
+ */
+void ReadUnicodeData(const std::string& path, const std::function<void(char32_t, const std::vector<std::string>&)>& f)
+{
+    auto first = char32_t {};
+    ReadUCD(path, [&](const std::vector<std::string>& fields) {
+        if (fields.size() < 15) {
+            throw std::runtime_error("illegal UnicodeData line: " + fields[0]);
+        }
+        auto c = ParseCode(fields[0]);
+        auto& name = fields[1];
+        if (name.size() > 8 && name.compare(name.size() - 8, 8, ", First>") == 0) {
+            first = c;
+            return;
+        }
+        if (name.size() > 7 && name.compare(name.size() - 7, 7, ", Last>") == 0) {
+            for (auto i = first; i <= c; ++i) {
+                f(i, fields);
+            }
+            return;
+        }
+        f(c, fields);
+    });
+}
+
+/**
+ * @brief 範囲毎に値を示す UCD ファイル (XXXX..YYYY ; Value) を読み、コードポイント毎に関数を呼ぶ
+ * @param path ファイル名
+ * @param f コードポイントと値を受け取る関数
+ */
+void ReadRanges(const std::string& path, const std::function<void(char32_t, const std::string&)>& f)
+{
+    ReadUCD(path, [&](const std::vector<std::string>& fields) {
+        if (fields.size() < 2) {
+            throw std::runtime_error("illegal line: " + fields[0]);
+        }
+        auto& range = fields[0];
+        auto dots = range.find("..");
+        auto first = ParseCode(range.substr(0, dots));
+        auto last = dots == std::string::npos ? first : ParseCode(range.substr(dots + 2));
+        for (auto c = first; c <= last; ++c) {
+            f(c, fields[1]);
+        }
+    });
+}
+
+/*
+ *
+ */
+
+/**
+ * @brief コードポイント毎の値を2段テーブルにした物
+ *
+ * value = blocks[(index[c >> BlockShift] << BlockShift) | (c & mask)]
+ */
+struct TwoStage
+{
+    std::vector<std::uint32_t> index;
+    std::vector<std::uint32_t> blocks;
+};
+
+/// コードポイント毎の値を同じ内容のブロックを共有する2段テーブルにする
+auto MakeTwoStage(const std::vector<std::uint32_t>& values) -> TwoStage
+{
+    constexpr auto BlockSize = std::size_t(1) << BlockShift;
+    auto table = TwoStage {};
+    auto known = std::map<std::vector<std::uint32_t>, std::uint32_t> {};
+    for (auto b = std::size_t {}; b < values.size(); b += BlockSize) {
+        auto block = std::vector<std::uint32_t>(values.begin() + b, values.begin() + b + BlockSize);
+        auto it = known.find(block);
+        if (it == known.end()) {
+            it = known.emplace(block, std::uint32_t(table.blocks.size() / BlockSize)).first;
+            table.blocks.insert(table.blocks.end(), block.begin(), block.end());
+        }
+        table.index.push_back(it->second);
+    }
+    return table;
+}
+
+/**
+ * @brief 生成するヘッダーの出力
+ */
+class Writer
+{
+public:
+
+    explicit Writer(std::ostream& out) : out_(out) {}
+
+    /// 文字列をそのまま出力する
+    auto Text(const std::string& text) -> Writer&
+    {
+        out_ << text;
+        return *this;
+    }
+
+    /// 整数の配列を出力する
+    auto Array(const std::string& type, const std::string& name, const std::vector<std::uint32_t>& values, int digits) -> Writer&
+    {
+        out_ << "inline constexpr " << type << ' ' << name << "[] = {";
+        auto column = 0;
+        for (auto v : values) {
+            out_ << (column ? " " : "\n    ") << "0x" << std::hex << std::setw(digits) << std::setfill('0') << v << std::dec << ',';
+            column = (column + 1) % (digits <= 2 ? 16 : digits <= 4 ? 12 : 8);
+        }
+        out_ << "\n};\n\n";
+        return *this;
+    }
+
+    /// 符号付き整数の配列を出力する
+    auto SignedArray(const std::string& type, const std::string& name, const std::vector<std::int32_t>& values, int columns) -> Writer&
+    {
+        out_ << "inline constexpr " << type << ' ' << name << "[] = {";
+        auto column = 0;
+        for (auto v : values) {
+            out_ << (column ? " " : "\n    ") << v << ',';
+            column = (column + 1) % columns;
+        }
+        out_ << "\n};\n\n";
+        return *this;
+    }
+
+    /// 列挙型を出力する 値は names の順番
+    auto Enum(const std::string& comment, const std::string& name, const std::vector<std::string>& names) -> Writer&
+    {
+        out_ << "/// " << comment << "\n"
+             << "enum class " << name << " : std::uint8_t {\n";
+        for (auto& n : names) {
+            out_ << "    " << n << ",\n";
+        }
+        out_ << "};\n\n";
+        return *this;
+    }
+
+    /// 2段テーブルと参照関数を出力する
+    auto Table(const std::string& type, const std::string& name, const TwoStage& table, int digits) -> Writer&
+    {
+        auto bits = table.blocks.size() >> BlockShift > 0xff ? "std::uint16_t" : "std::uint8_t";
+        Array(bits, name + "Index", table.index, table.blocks.size() >> BlockShift > 0xff ? 4 : 2);
+        Array(type, name + "Blocks", table.blocks, digits);
+        out_ << "/// " << name << " の値を返す\n"
+             << "constexpr auto Get" << name << "(char32_t c) noexcept -> " << type << "\n"
+             << "{\n"
+             << "    return Lookup(" << name << "Index, " << name << "Blocks, c);\n"
+             << "}\n\n";
+        return *this;
+    }
+
+private:
+
+    std::ostream& out_;
+};
+
+/*
+ *
+ */
+
+/**
+ * @brief 正規化のテーブルを生成する
+ *
+ * - Normalization  ... 結合クラスとクイックチェックの値
+ * - Decompositions ... 完全分解 (正準, 互換) の索引
+ * - Compositions   ... 合成する2文字と合成後の文字
+ */
+void GenerateNormalization(const std::string& ucd, Writer& writer)
+{
+    auto ccc = std::vector<std::uint32_t>(CodeSpace);
+    auto mappings = std::map<char32_t, std::pair<bool, std::vector<char32_t>>> {};
+    ReadUnicodeData(ucd + "/UnicodeData.txt", [&](char32_t c, const std::vector<std::string>& fields) {
+        ccc[c] = std::uint32_t(std::stoul(fields[3]));
+        auto& d = fields[5];
+        if (d.empty()) return;
+        auto compat = d[0] == '<';
+        mappings[c] = {compat, ParseCodes(compat ? d.substr(d.find('>') + 1) : d)};
+    });
+
+    auto exclusions = std::vector<bool>(CodeSpace);
+    ReadUCD(ucd + "/CompositionExclusions.txt", [&](const std::vector<std::string>& fields) {
+        exclusions[ParseCode(fields[0])] = true;
+    });
+
+    // 完全分解 (ハングル音節は算術的に分解する)
+    std::function<void(char32_t, bool, std::vector<char32_t>&)> decompose;
+    decompose = [&](char32_t c, bool compat, std::vector<char32_t>& out) {
+        if (HangulSBase <= c && c < HangulSBase + HangulSCount) {
+            auto s = c - HangulSBase;
+            out.push_back(HangulLBase + s / HangulNCount);
+            out.push_back(HangulVBase + (s % HangulNCount) / HangulTCount);
+            if (s % HangulTCount) out.push_back(HangulTBase + s % HangulTCount);
+            return;
+        }
+        auto it = mappings.find(c);
+        if (it == mappings.end() || (it->second.first && !compat)) {
+            out.push_back(c);
+            return;
+        }
+        for (auto d : it->second.second) {
+            decompose(d, compat, out);
+        }
+    };
+    auto reorder = [&](std::vector<char32_t>& s) {
+        for (auto b = s.begin(); b != s.end(); ) {
+            if (!ccc[*b]) { ++b; continue; }
+            auto e = std::find_if(b, s.end(), [&](char32_t c) { return !ccc[c]; });
+            std::stable_sort(b, e, [&](char32_t x, char32_t y) { return ccc[x] < ccc[y]; });
+            b = e;
+        }
+    };
+
+    // 合成除外 (一覧 + 単独分解 + 非スターターの分解)
+    for (auto& [c, mapping] : mappings) {
+        auto& [compat, d] = mapping;
+        if (compat) continue;
+        if (d.size() == 1 || ccc[c] || ccc[d[0]]) exclusions[c] = true;
+    }
+
+    // 合成
+    struct Composition { char32_t first, second, composite; };
+    auto compositions = std::vector<Composition> {};
+    auto maybe = std::vector<bool>(CodeSpace);
+    for (auto& [c, mapping] : mappings) {
+        auto& [compat, d] = mapping;
+        if (compat || exclusions[c] || d.size() != 2) continue;
+        compositions.push_back({d[0], d[1], c});
+        maybe[d[1]] = true;
+    }
+    for (auto v = 0; v < HangulVCount; ++v) maybe[HangulVBase + v] = true;
+    for (auto t = 1; t < HangulTCount; ++t) maybe[HangulTBase + t] = true;
+    std::sort(compositions.begin(), compositions.end(), [](const Composition& x, const Composition& y) {
+        return std::tie(x.first, x.second) < std::tie(y.first, y.second);
+    });
+
+    // 互換分解が正準分解と異なるか (正準分解の中に互換分解する文字を含む場合も含む)
+    auto changedByCompatibility = [&](char32_t c) {
+        auto canonical = std::vector<char32_t> {};
+        auto compat = std::vector<char32_t> {};
+        decompose(c, false, canonical);
+        decompose(c, true, compat);
+        return canonical != compat;
+    };
+
+    // 結合クラスとクイックチェック
+    auto values = std::vector<std::uint32_t>(CodeSpace);
+    for (auto c = char32_t {}; c < CodeSpace; ++c) {
+        auto it = mappings.find(c);
+        auto hangul = HangulSBase <= c && c < HangulSBase + HangulSCount;
+        auto canonical = hangul || (it != mappings.end() && !it->second.first);
+        auto any = hangul || it != mappings.end();
+        auto v = ccc[c];
+        if (canonical) v |= 0x0100;                         // NFD_QC=N
+        if (any) v |= 0x0200;                               // NFKD_QC=N
+        if (canonical && exclusions[c]) v |= 0x0400;        // NFC_QC=N
+        else if (maybe[c]) v |= 0x0800;                     // NFC_QC=M
+        if ((canonical && exclusions[c]) || (any && changedByCompatibility(c))) v |= 0x1000;   // NFKC_QC=N
+        else if (maybe[c]) v |= 0x2000;                     // NFKC_QC=M
+        values[c] = v;
+    }
+
+    // 完全分解の一覧 (同じ分解は共有する)
+    auto data = std::vector<std::uint32_t> {0};
+    auto known = std::map<std::vector<char32_t>, std::uint32_t> {};
+    auto intern = [&](std::vector<char32_t> s) -> std::uint32_t {
+        reorder(s);
+        auto it = known.find(s);
+        if (it == known.end()) {
+            it = known.emplace(s, std::uint32_t(data.size() << 5 | s.size())).first;
+            data.insert(data.end(), s.begin(), s.end());
+        }
+        return it->second;
+    };
+    auto decompositions = std::vector<std::uint32_t> {};
+    for (auto& [c, mapping] : mappings) {
+        auto canonical = std::vector<char32_t> {};
+        auto compat = std::vector<char32_t> {};
+        decompose(c, false, canonical);
+        decompose(c, true, compat);
+        decompositions.push_back(c);
+        decompositions.push_back(mapping.first ? 0 : intern(canonical));
+        decompositions.push_back(intern(compat));
+    }
+
+    auto composition = std::vector<std::uint32_t> {};
+    for (auto& x : compositions) {
+        composition.insert(composition.end(), {x.first, x.second, x.composite});
+    }
+
+    writer
+        .Text("/*\n"
+              " * 正規化\n"
+              " *\n"
+              " * Normalization の値\n"
+              " * - bit 0 ～ 7 ... Canonical_Combining_Class\n"
+              " * - bit 8      ... NFD_QC=N\n"
+              " * - bit 9      ... NFKD_QC=N\n"
+              " * - bit 10, 11 ... NFC_QC=N, NFC_QC=M\n"
+              " * - bit 12, 13 ... NFKC_QC=N, NFKC_QC=M\n"
+              " */\n\n")
+        .Text("constexpr auto NormalizationCombiningClass = std::uint16_t(0x00ff);\n"
+              "constexpr auto NormalizationNFDNo = std::uint16_t(0x0100);\n"
+              "constexpr auto NormalizationNFKDNo = std::uint16_t(0x0200);\n"
+              "constexpr auto NormalizationNFCNo = std::uint16_t(0x0400);\n"
+              "constexpr auto NormalizationNFCMaybe = std::uint16_t(0x0800);\n"
+              "constexpr auto NormalizationNFKCNo = std::uint16_t(0x1000);\n"
+              "constexpr auto NormalizationNFKCMaybe = std::uint16_t(0x2000);\n\n")
+        .Table("std::uint16_t", "Normalization", MakeTwoStage(values), 4)
+        .Text("/// 完全分解の一覧 (コードポイント, 正準分解, 互換分解) の順 分解は (DecompositionData の位置 << 5 | 長さ) 0 は分解無し\n")
+        .Array("char32_t", "Decompositions", decompositions, 5)
+        .Array("char32_t", "DecompositionData", data, 5)
+        .Text("/// 合成の一覧 (1文字目, 2文字目, 合成後) の順 1文字目, 2文字目で整列済み\n")
+        .Array("char32_t", "Compositions", composition, 5);
+}
+
+/**
+ * @brief 大文字小文字変換と畳み込みのテーブルを生成する
+ *
+ * - Case         ... CaseMappings の組の番号
+ * - CaseMappings ... (小文字, 大文字, タイトル文字, 単純畳み込み) への差分と完全畳み込みの組
+ * - CaseFoldData ... 完全畳み込みの文字列
+ */
+void GenerateCase(const std::string& ucd, Writer& writer)
+{
+    // 単純変換 (UnicodeData.txt) はコードポイントとの差分で持つ
+    auto deltas = std::vector<std::array<std::int32_t, 4>>(CodeSpace);
+    ReadUnicodeData(ucd + "/UnicodeData.txt", [&](char32_t c, const std::vector<std::string>& fields) {
+        auto delta = [&](const std::string& field) {
+            return field.empty() ? 0 : std::int32_t(ParseCode(field)) - std::int32_t(c);
+        };
+        auto& d = deltas[c];
+        d[0] = delta(fields[13]);
+        d[1] = delta(fields[12]);
+        d[2] = fields[14].empty() ? d[1] : delta(fields[14]);
+    });
+
+    // 畳み込み (C + S が単純、C + F が完全) T はトルコ語用なので使わない
+    auto full = std::map<char32_t, std::vector<char32_t>> {};
+    ReadUCD(ucd + "/CaseFolding.txt", [&](const std::vector<std::string>& fields) {
+        auto c = ParseCode(fields[0]);
+        auto& status = fields[1];
+        auto mapping = ParseCodes(fields[2]);
+        if (status == "C" || status == "S") {
+            deltas[c][3] = std::int32_t(mapping[0]) - std::int32_t(c);
+        }
+        if (status == "F") {
+            full[c] = mapping;
+        }
+    });
+
+    auto data = std::vector<std::uint32_t> {0};
+    auto tuples = std::map<std::array<std::int32_t, 5>, std::uint32_t> {};
+    auto mappings = std::vector<std::int32_t> {};
+    auto values = std::vector<std::uint32_t>(CodeSpace);
+    for (auto c = char32_t {}; c < CodeSpace; ++c) {
+        auto& d = deltas[c];
+        auto tuple = std::array<std::int32_t, 5> {d[0], d[1], d[2], d[3], 0};
+        auto it = full.find(c);
+        if (it != full.end()) {
+            tuple[4] = std::int32_t(data.size() << 2 | it->second.size());
+            data.insert(data.end(), it->second.begin(), it->second.end());
+        }
+        auto known = tuples.find(tuple);
+        if (known == tuples.end()) {
+            known = tuples.emplace(tuple, std::uint32_t(tuples.size())).first;
+            mappings.insert(mappings.end(), tuple.begin(), tuple.end());
+        }
+        values[c] = known->second;
+    }
+
+    writer
+        .Text("/*\n"
+              " * 大文字小文字\n"
+              " *\n"
+              " * Case の値は CaseMappings の組の番号\n"
+              " * 組は (小文字, 大文字, タイトル文字, 単純畳み込み) へのコードポイントの差分と\n"
+              " * 完全畳み込み (CaseFoldData の位置 << 2 | 長さ) 0 は単純畳み込みと同じ\n"
+              " */\n\n")
+        .Table(tuples.size() > 0xff ? "std::uint16_t" : "std::uint8_t", "Case", MakeTwoStage(values), tuples.size() > 0xff ? 4 : 2)
+        .SignedArray("std::int32_t", "CaseMappings", mappings, 10)
+        .Array("char32_t", "CaseFoldData", data, 5);
+}
+
+/**
+ * @brief 書記素クラスタ境界のテーブルを生成する
+ *
+ * - Grapheme ... Grapheme_Cluster_Break の値と Extended_Pictographic
+ */
+void GenerateGrapheme(const std::string& ucd, Writer& writer)
+{
+    // 値の順番は生成するヘッダーの定数と対応する
+    static const char* const names[] = {
+        "Other", "CR", "LF", "Control", "Extend", "ZWJ", "Regional_Indicator",
+        "Prepend", "SpacingMark", "L", "V", "T", "LV", "LVT",
+    };
+    static const char* const constants[] = {
+        "Other", "CR", "LF", "Control", "Extend", "ZWJ", "RegionalIndicator",
+        "Prepend", "SpacingMark", "L", "V", "T", "LV", "LVT",
+    };
+    auto values = std::vector<std::uint32_t>(CodeSpace);
+    ReadRanges(ucd + "/GraphemeBreakProperty.txt", [&](char32_t c, const std::string& value) {
+        auto it = std::find(std::begin(names), std::end(names), value);
+        if (it == std::end(names)) {
+            throw std::runtime_error("unknown Grapheme_Cluster_Break: " + value);
+        }
+        values[c] = std::uint32_t(it - std::begin(names));
+    });
+    ReadRanges(ucd + "/emoji-data.txt", [&](char32_t c, const std::string& value) {
+        if (value == "Extended_Pictographic") values[c] |= 0x10;
+    });
+
+    writer.Text("/*\n"
+                " * 書記素クラスタ\n"
+                " *\n"
+                " * Grapheme の値\n"
+                " * - bit 0 ～ 3 ... Grapheme_Cluster_Break\n"
+                " * - bit 4      ... Extended_Pictographic\n"
+                " */\n\n");
+    for (auto i = std::size_t {}; i < std::size(constants); ++i) {
+        writer.Text("constexpr auto Grapheme" + std::string(constants[i]) + " = std::uint8_t(" + std::to_string(i) + ");\n");
+    }
+    writer
+        .Text("constexpr auto GraphemeBreakMask = std::uint8_t(0x0f);\n"
+              "constexpr auto GraphemeExtendedPictographic = std::uint8_t(0x10);\n\n")
+        .Table("std::uint8_t", "Grapheme", MakeTwoStage(values), 2);
+}
+
+/**
+ * @brief 表示幅のテーブルを生成する
+ *
+ * - Width ... 表示幅の種類と Emoji
+ */
+void GenerateWidth(const std::string& ucd, Writer& writer)
+{
+    enum { Zero, Narrow, Wide, Ambiguous, Emoji = 0x4 };
+
+    auto values = std::vector<std::uint32_t>(CodeSpace, Narrow);
+
+    // 未割り当ての CJK 統合漢字の範囲は W (UAX #11)
+    auto wide = [&](char32_t first, char32_t last) {
+        for (auto c = first; c <= last; ++c) values[c] = Wide;
+    };
+    wide(0x3400, 0x4dbf);
+    wide(0x4e00, 0x9fff);
+    wide(0xf900, 0xfaff);
+    wide(0x20000, 0x2fffd);
+    wide(0x30000, 0x3fffd);
+    ReadRanges(ucd + "/EastAsianWidth.txt", [&](char32_t c, const std::string& value) {
+        values[c] = (value == "W" || value == "F") ? Wide : (value == "A") ? Ambiguous : Narrow;
+    });
+
+    // 結合文字, 書式文字, 制御文字, ハングルの中声と終声は幅 0
+    ReadUnicodeData(ucd + "/UnicodeData.txt", [&](char32_t c, const std::vector<std::string>& fields) {
+        auto& gc = fields[2];
+        if ((gc == "Mn" || gc == "Me" || gc == "Cc" || gc == "Cf") && c != 0xad) values[c] = Zero;
+    });
+    for (auto c = char32_t(0x1160); c <= 0x11ff; ++c) values[c] = Zero;
+    for (auto c = char32_t(0xd7b0); c <= 0xd7ff; ++c) values[c] = Zero;
+
+    // 絵文字表示が既定の文字は幅 2 異体字セレクタで絵文字表示になる文字に印を付ける
+    ReadRanges(ucd + "/emoji-data.txt", [&](char32_t c, const std::string& value) {
+        if (value == "Emoji_Presentation") values[c] = (values[c] & Emoji) | Wide;
+        if (value == "Emoji" && c > 0x7f) values[c] |= Emoji;
+    });
+
+    writer
+        .Text("/*\n"
+              " * 表示幅\n"
+              " *\n"
+              " * Width の値\n"
+              " * - bit 0 ～ 1 ... 0 幅 0, 1 半角, 2 全角, 3 曖昧 (East_Asian_Width=A)\n"
+              " * - bit 2      ... Emoji (U+FE0F で全角になる)\n"
+              " */\n\n"
+              "constexpr auto WidthZero = std::uint8_t(0);\n"
+              "constexpr auto WidthNarrow = std::uint8_t(1);\n"
+              "constexpr auto WidthWide = std::uint8_t(2);\n"
+              "constexpr auto WidthAmbiguous = std::uint8_t(3);\n"
+              "constexpr auto WidthMask = std::uint8_t(0x03);\n"
+              "constexpr auto WidthEmoji = std::uint8_t(0x04);\n\n")
+        .Table("std::uint8_t", "Width", MakeTwoStage(values), 2);
+}
+
+/// 値の名前の一覧から番号を返す 無ければ例外
+auto IndexOf(const std::vector<std::string>& names, const std::string& name, const std::string& property) -> std::uint32_t
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it == names.end()) {
+        throw std::runtime_error("unknown " + property + ": " + name);
+    }
+    return std::uint32_t(it - names.begin());
+}
+
+/**
+ * @brief 文字の性質のテーブルを生成する
+ *
+ * - GeneralCategory    ... 一般カテゴリ (既定値 Cn)
+ * - Script             ... 用字 (既定値 Unknown)
+ * - LineBreak          ... 改行クラス (既定値 XX)
+ */
+void GenerateProperty(const std::string& ucd, Writer& writer)
+{
+    // 既定値を 0 にする (範囲外の Lookup は 0 を返す)
+    auto categories = std::vector<std::string> {
+        "Cn", "Lu", "Ll", "Lt", "Lm", "Lo", "Mn", "Mc", "Me", "Nd", "Nl", "No",
+        "Pc", "Pd", "Ps", "Pe", "Pi", "Pf", "Po", "Sm", "Sc", "Sk", "So",
+        "Zs", "Zl", "Zp", "Cc", "Cf", "Cs", "Co",
+    };
+    auto category = std::vector<std::uint32_t>(CodeSpace);
+    ReadUnicodeData(ucd + "/UnicodeData.txt", [&](char32_t c, const std::vector<std::string>& fields) {
+        category[c] = IndexOf(categories, fields[2], "General_Category");
+    });
+
+    // 用字は UCD に現れる物を名前順に並べる
+    auto scripts = std::vector<std::string> {};
+    ReadRanges(ucd + "/Scripts.txt", [&](char32_t, const std::string& value) {
+        if (std::find(scripts.begin(), scripts.end(), value) == scripts.end()) scripts.push_back(value);
+    });
+    std::sort(scripts.begin(), scripts.end());
+    scripts.insert(scripts.begin(), "Unknown");
+    auto script = std::vector<std::uint32_t>(CodeSpace);
+    ReadRanges(ucd + "/Scripts.txt", [&](char32_t c, const std::string& value) {
+        script[c] = IndexOf(scripts, value, "Script");
+    });
+
+    // UAX #14 の表の順
+    auto breaks = std::vector<std::string> {
+        "XX", "BK", "CR", "LF", "CM", "NL", "SG", "WJ", "ZW", "GL", "SP", "ZWJ",
+        "B2", "BA", "BB", "HY", "CB", "CL", "CP", "EX", "IN", "NS", "OP", "QU",
+        "IS", "NU", "PO", "PR", "SY", "AI", "AL", "CJ", "EB", "EM", "H2", "H3",
+        "HL", "ID", "JL", "JV", "JT", "RI", "SA",
+    };
+    auto lineBreak = std::vector<std::uint32_t>(CodeSpace);
+    ReadRanges(ucd + "/LineBreak.txt", [&](char32_t c, const std::string& value) {
+        lineBreak[c] = IndexOf(breaks, value, "Line_Break");
+    });
+
+    writer
+        .Text("/*\n"
+              " * 文字の性質\n"
+              " */\n\n")
+        .Enum("一般カテゴリ (General_Category)", "GeneralCategory", categories)
+        .Enum("用字 (Script)", "Script", scripts)
+        .Enum("改行クラス (Line_Break)", "LineBreak", breaks)
+        .Text("/// Script の名前 (Scripts.txt の表記)\n"
+              "inline constexpr const char* ScriptNames[] = {");
+    for (auto i = std::size_t {}; i < scripts.size(); ++i) {
+        writer.Text((i % 6 ? " \"" : "\n    \"") + scripts[i] + "\",");
+    }
+    writer
+        .Text("\n};\n\n")
+        .Table("std::uint8_t", "GeneralCategory", MakeTwoStage(category), 2)
+        .Table("std::uint8_t", "Script", MakeTwoStage(script), 2)
+        .Table("std::uint8_t", "LineBreak", MakeTwoStage(lineBreak), 2);
+}
+
+/**
+ * @brief 日本語の畳み込みのテーブルを生成する
+ *
+ * - KanaVoiced     ... U+3040 ～ U+30FF の仮名に濁点を合成した文字との差 (0 は無し)
+ * - KanaSemiVoiced ... 同じく半濁点
+ * - HalfwidthKana  ... U+FF61 ～ U+FF9F の半角カナに対応する全角の文字
+ */
+void GenerateJapanese(const std::string& ucd, Writer& writer)
+{
+    constexpr auto kanaFirst = char32_t(0x3040);
+    constexpr auto kanaLast = char32_t(0x30ff);
+    constexpr auto halfFirst = char32_t(0xff61);
+    constexpr auto halfLast = char32_t(0xff9f);
+
+    auto voiced = std::vector<std::uint32_t>(kanaLast - kanaFirst + 1);
+    auto semiVoiced = std::vector<std::uint32_t>(kanaLast - kanaFirst + 1);
+    auto half = std::vector<std::uint32_t>(halfLast - halfFirst + 1);
+    ReadUnicodeData(ucd + "/UnicodeData.txt", [&](char32_t c, const std::vector<std::string>& fields) {
+        auto& d = fields[5];
+        if (d.empty()) return;
+        if (halfFirst <= c && c <= halfLast && d.compare(0, 8, "<narrow>") == 0) {
+            half[c - halfFirst] = ParseCodes(d.substr(8)).at(0);
+            return;
+        }
+        if (d[0] == '<') return;
+        auto codes = ParseCodes(d);
+        if (codes.size() != 2 || codes[0] < kanaFirst || kanaLast < codes[0]) return;
+        if (codes[1] == 0x3099) voiced[codes[0] - kanaFirst] = c - codes[0];
+        if (codes[1] == 0x309a) semiVoiced[codes[0] - kanaFirst] = c - codes[0];
+    });
+
+    // 半角の濁点と半濁点は結合文字ではなく全角の ゛ ゜ にする
+    half[0xff9e - halfFirst] = 0x309b;
+    half[0xff9f - halfFirst] = 0x309c;
+
+    writer
+        .Text("/*\n"
+              " * 日本語の畳み込み\n"
+              " */\n\n"
+              "/// KanaVoiced, KanaSemiVoiced の最初の文字\n"
+              "constexpr auto KanaFirst = char32_t(0x3040);\n\n"
+              "/// HalfwidthKana の最初の文字\n"
+              "constexpr auto HalfwidthKanaFirst = char32_t(0xff61);\n\n")
+        .Array("std::uint8_t", "KanaVoiced", voiced, 2)
+        .Array("std::uint8_t", "KanaSemiVoiced", semiVoiced, 2)
+        .Array("char16_t", "HalfwidthKana", half, 4);
+}
+
+} // namespace
+
+/*
+ *
+ */
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::cerr << "usage: UnicodeTableGenerator <ucd directory> <output header>\n";
+        return 2;
+    }
+    try {
+        auto ucd = std::string(argv[1]);
+        auto body = std::ostringstream {};
+        auto writer = Writer(body);
+        GenerateNormalization(ucd, writer);
+        GenerateCase(ucd, writer);
+        GenerateGrapheme(ucd, writer);
+        GenerateWidth(ucd, writer);
+        GenerateProperty(ucd, writer);
+        GenerateJapanese(ucd, writer);
+
+        auto out = std::ofstream(argv[2], std::ios::binary);
+        if (!out) {
+            throw std::runtime_error(std::string("can not open: ") + argv[2]);
+        }
+        out << "\xef\xbb\xbf"
+            << "/**\n"
+            << " * @brief ユニコードのプロパティテーブル\n"
+            << " * @file\n"
+            << " *\n"
+            << " * tools/UnicodeTableGenerator.cpp が ucd/ 以下のファイルから生成する 直接編集しない事\n"
+            << " */\n\n"
+            << "#ifndef PITS_UNICODETABLE_HPP_\n"
+            << "#define PITS_UNICODETABLE_HPP_\n\n"
+            << "#include <cstddef>  // size_t\n"
+            << "#include <cstdint>  // uint8_t uint16_t\n\n"
+            << "/*\n *\n */\n\n"
+            << "namespace Pits {\n\n"
+            << "/**\n"
+            << " * @brief 生成したユニコードのプロパティテーブル\n"
+            << " */\n"
+            << "namespace UnicodeTable {\n\n"
+            << "/// 2段テーブルのブロックのビット数\n"
+            << "constexpr auto BlockShift = " << BlockShift << ";\n\n"
+            << "/// 2段テーブルを引く 範囲外のコードポイントは 0 を返す\n"
+            << "template <class Index, std::size_t IndexSize, class Value, std::size_t BlockSize>\n"
+            << "constexpr auto Lookup(const Index (&index)[IndexSize], const Value (&blocks)[BlockSize], char32_t c) noexcept -> Value\n"
+            << "{\n"
+            << "    if ((c >> BlockShift) >= IndexSize) return Value();\n"
+            << "    return blocks[(std::size_t(index[c >> BlockShift]) << BlockShift) | (c & ((1u << BlockShift) - 1))];\n"
+            << "}\n\n"
+            << body.str()
+            << "/*\n *\n */\n\n"
+            << "} // namespace UnicodeTable\n"
+            << "} // namespace Pits\n\n"
+            << "#endif\n\n"
+            << "/*\n *\n */\n";
+        if (!out) {
+            throw std::runtime_error(std::string("can not write: ") + argv[2]);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "UnicodeTableGenerator: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}